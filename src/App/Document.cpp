@@ -65,9 +65,13 @@ recompute path. Also enables more complicated dependencies beyond trees.
 #include <boost/bind.hpp>
 #include <boost/regex.hpp>
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
 
 
 #include "Document.h"
@@ -125,6 +129,324 @@ typedef Traits::edge_descriptor Edge;
 
 namespace App {
 
+// Dependency graph of the document objects. Instead of rebuilding the whole
+// graph for every query it gets updated when an object is added or removed or
+// when a link property of an object has changed. For each object the objects
+// it links to (out list) and the objects linking to it (in list) are stored,
+// together with a topological order where the dependencies of an object are
+// placed before the object. On insertion of an edge the order is only repaired
+// for the affected range as described in:
+// D. J. Pearce, P. H. J. Kelly: A dynamic topological sort algorithm for
+// directed acyclic graphs, ACM Journal of Experimental Algorithmics 11, 2006.
+class DependencyGraph
+{
+public:
+    DependencyGraph() : removed(0), cyclic(false)
+    {
+    }
+
+    void clear()
+    {
+        inLists.clear();
+        outLists.clear();
+        position.clear();
+        order.clear();
+        removed = 0;
+        cyclic = false;
+    }
+
+    bool hasObject(const DocumentObject* obj) const
+    {
+        return position.find(obj) != position.end();
+    }
+
+    const std::vector<DocumentObject*>& getInList(const DocumentObject* obj) const
+    {
+        AdjacencyMap::const_iterator it = inLists.find(obj);
+        return (it != inLists.end() ? it->second : empty);
+    }
+
+    const std::vector<DocumentObject*>& getOutList(const DocumentObject* obj) const
+    {
+        AdjacencyMap::const_iterator it = outLists.find(obj);
+        return (it != outLists.end() ? it->second : empty);
+    }
+
+    void addObject(DocumentObject* obj)
+    {
+        if (hasObject(obj))
+            return;
+        position[obj] = (int)order.size();
+        order.push_back(obj);
+        setOutList(obj, obj->getOutList());
+
+        // objects which already link to the new object must be placed after it
+        std::vector<DocumentObject*> in = getInList(obj);
+        for (std::vector<DocumentObject*>::iterator it = in.begin(); it != in.end(); ++it)
+            insertEdge(*it, obj);
+    }
+
+    void removeObject(DocumentObject* obj)
+    {
+        boost::unordered_map<const DocumentObject*, int>::iterator pos = position.find(obj);
+        if (pos == position.end())
+            return;
+        setOutList(obj, std::vector<DocumentObject*>());
+        outLists.erase(obj);
+        // keep the in list as long as other objects still link to it, e.g. when
+        // the object is held by the undo stack
+        AdjacencyMap::iterator in = inLists.find(obj);
+        if (in != inLists.end() && in->second.empty())
+            inLists.erase(in);
+        order[pos->second] = 0;
+        position.erase(pos);
+        if (++removed > order.size() / 2)
+            compact();
+    }
+
+    void updateObject(DocumentObject* obj)
+    {
+        if (hasObject(obj))
+            setOutList(obj, obj->getOutList());
+    }
+
+    /// the dependencies of an object are placed before the object, returns false on cyclic graphs
+    bool getTopologicalOrder(std::vector<DocumentObject*>& objs)
+    {
+        if (cyclic && !sort())
+            return false;
+        objs.clear();
+        objs.reserve(position.size());
+        for (std::vector<DocumentObject*>::iterator it = order.begin(); it != order.end(); ++it) {
+            if (*it)
+                objs.push_back(*it);
+        }
+        return true;
+    }
+
+    /// collects the given objects and all objects depending on them in topological order
+    bool getDependentOrder(const std::vector<DocumentObject*>& seeds, std::vector<DocumentObject*>& objs)
+    {
+        if (cyclic && !sort())
+            return false;
+        objs.clear();
+        boost::unordered_set<const DocumentObject*> visited;
+        for (std::vector<DocumentObject*>::const_iterator it = seeds.begin(); it != seeds.end(); ++it) {
+            if (hasObject(*it) && visited.insert(*it).second)
+                objs.push_back(*it);
+        }
+        for (std::size_t i = 0; i < objs.size(); i++) {
+            const std::vector<DocumentObject*>& in = getInList(objs[i]);
+            for (std::vector<DocumentObject*>::const_iterator jt = in.begin(); jt != in.end(); ++jt) {
+                if (hasObject(*jt) && visited.insert(*jt).second)
+                    objs.push_back(*jt);
+            }
+        }
+        std::sort(objs.begin(), objs.end(), PositionCompare(position));
+        return true;
+    }
+
+    /// sets up the graph from scratch
+    void rebuild(const std::vector<DocumentObject*>& objs)
+    {
+        clear();
+        for (std::vector<DocumentObject*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+            position[*it] = (int)order.size();
+            order.push_back(*it);
+        }
+        for (std::vector<DocumentObject*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+            std::vector<DocumentObject*> out = (*it)->getOutList();
+            for (std::vector<DocumentObject*>::iterator jt = out.begin(); jt != out.end(); ++jt)
+                inLists[*jt].push_back(*it);
+            outLists[*it].swap(out);
+        }
+        sort();
+    }
+
+private:
+    typedef boost::unordered_map<const DocumentObject*, std::vector<DocumentObject*> > AdjacencyMap;
+
+    void setOutList(DocumentObject* obj, const std::vector<DocumentObject*>& out)
+    {
+        std::vector<DocumentObject*>& old = outLists[obj];
+        for (std::vector<DocumentObject*>::iterator it = old.begin(); it != old.end(); ++it) {
+            std::vector<DocumentObject*>& in = inLists[*it];
+            std::vector<DocumentObject*>::iterator jt = std::find(in.begin(), in.end(), obj);
+            if (jt != in.end())
+                in.erase(jt);
+            if (in.empty() && !hasObject(*it))
+                inLists.erase(*it);
+        }
+        old = out;
+        for (std::vector<DocumentObject*>::const_iterator it = out.begin(); it != out.end(); ++it)
+            inLists[*it].push_back(obj);
+        for (std::vector<DocumentObject*>::const_iterator it = out.begin(); it != out.end(); ++it)
+            insertEdge(obj, *it);
+    }
+
+    // obj depends on dep, i.e. dep must be placed before obj
+    void insertEdge(DocumentObject* obj, DocumentObject* dep)
+    {
+        if (cyclic)
+            return;
+        boost::unordered_map<const DocumentObject*, int>::iterator it;
+        it = position.find(obj);
+        if (it == position.end())
+            return;
+        int lb = it->second;
+        it = position.find(dep);
+        if (it == position.end())
+            return;
+        int ub = it->second;
+        if (ub < lb)
+            return; // order is still valid
+        if (ub == lb) {
+            cyclic = true;
+            return;
+        }
+
+        // all objects depending on 'obj' inside the affected range
+        std::vector<DocumentObject*> forward;
+        boost::unordered_set<const DocumentObject*> visited;
+        std::vector<DocumentObject*> stack(1, obj);
+        visited.insert(obj);
+        while (!stack.empty()) {
+            DocumentObject* cur = stack.back();
+            stack.pop_back();
+            forward.push_back(cur);
+            const std::vector<DocumentObject*>& in = getInList(cur);
+            for (std::vector<DocumentObject*>::const_iterator jt = in.begin(); jt != in.end(); ++jt) {
+                if (*jt == dep) {
+                    cyclic = true;
+                    return;
+                }
+                it = position.find(*jt);
+                if (it != position.end() && it->second < ub && visited.insert(*jt).second)
+                    stack.push_back(*jt);
+            }
+        }
+
+        // all dependencies of 'dep' inside the affected range
+        std::vector<DocumentObject*> backward;
+        stack.push_back(dep);
+        visited.insert(dep);
+        while (!stack.empty()) {
+            DocumentObject* cur = stack.back();
+            stack.pop_back();
+            backward.push_back(cur);
+            const std::vector<DocumentObject*>& out = getOutList(cur);
+            for (std::vector<DocumentObject*>::const_iterator jt = out.begin(); jt != out.end(); ++jt) {
+                it = position.find(*jt);
+                if (it != position.end() && it->second > lb && visited.insert(*jt).second)
+                    stack.push_back(*jt);
+            }
+        }
+
+        // move the dependencies in front of the dependent objects and reuse their slots
+        PositionCompare comp(position);
+        std::sort(forward.begin(), forward.end(), comp);
+        std::sort(backward.begin(), backward.end(), comp);
+        std::vector<int> slots;
+        slots.reserve(forward.size() + backward.size());
+        for (std::vector<DocumentObject*>::iterator jt = backward.begin(); jt != backward.end(); ++jt)
+            slots.push_back(position[*jt]);
+        for (std::vector<DocumentObject*>::iterator jt = forward.begin(); jt != forward.end(); ++jt)
+            slots.push_back(position[*jt]);
+        std::sort(slots.begin(), slots.end());
+        backward.insert(backward.end(), forward.begin(), forward.end());
+        for (std::size_t i = 0; i < slots.size(); i++) {
+            order[slots[i]] = backward[i];
+            position[backward[i]] = slots[i];
+        }
+    }
+
+    // full topological sort, needed after a cycle has been detected
+    bool sort()
+    {
+        std::vector<DocumentObject*> objs;
+        objs.reserve(position.size());
+        for (std::vector<DocumentObject*>::iterator it = order.begin(); it != order.end(); ++it) {
+            if (*it)
+                objs.push_back(*it);
+        }
+
+        boost::unordered_map<const DocumentObject*, int> degree;
+        std::vector<DocumentObject*> sorted;
+        sorted.reserve(objs.size());
+        for (std::vector<DocumentObject*>::iterator it = objs.begin(); it != objs.end(); ++it) {
+            int num = 0;
+            const std::vector<DocumentObject*>& out = getOutList(*it);
+            for (std::vector<DocumentObject*>::const_iterator jt = out.begin(); jt != out.end(); ++jt) {
+                if (hasObject(*jt))
+                    num++;
+            }
+            degree[*it] = num;
+            if (num == 0)
+                sorted.push_back(*it);
+        }
+
+        for (std::size_t i = 0; i < sorted.size(); i++) {
+            const std::vector<DocumentObject*>& in = getInList(sorted[i]);
+            for (std::vector<DocumentObject*>::const_iterator jt = in.begin(); jt != in.end(); ++jt) {
+                boost::unordered_map<const DocumentObject*, int>::iterator kt = degree.find(*jt);
+                if (kt != degree.end() && --kt->second == 0)
+                    sorted.push_back(*jt);
+            }
+        }
+
+        cyclic = (sorted.size() != objs.size());
+        if (cyclic)
+            return false;
+
+        order.swap(sorted);
+        removed = 0;
+        for (std::size_t i = 0; i < order.size(); i++)
+            position[order[i]] = (int)i;
+        return true;
+    }
+
+    void compact()
+    {
+        std::vector<DocumentObject*> objs;
+        objs.reserve(position.size());
+        for (std::vector<DocumentObject*>::iterator it = order.begin(); it != order.end(); ++it) {
+            if (*it) {
+                position[*it] = (int)objs.size();
+                objs.push_back(*it);
+            }
+        }
+        order.swap(objs);
+        removed = 0;
+    }
+
+    struct PositionCompare
+    {
+        PositionCompare(boost::unordered_map<const DocumentObject*, int>& p) : pos(p) {}
+        bool operator()(const DocumentObject* a, const DocumentObject* b) const
+        {
+            return pos[a] < pos[b];
+        }
+        boost::unordered_map<const DocumentObject*, int>& pos;
+    };
+
+    AdjacencyMap inLists;
+    AdjacencyMap outLists;
+    boost::unordered_map<const DocumentObject*, int> position;
+    std::vector<DocumentObject*> order;
+    std::size_t removed;
+    bool cyclic;
+    std::vector<DocumentObject*> empty;
+};
+
+// Job of the parallel recompute
+struct RecomputeJob
+{
+    DocumentObject* object;
+    DocumentObjectExecReturn* log;
+    float time;
+    bool abort;
+};
+
 // Pimpl class
 struct DocumentP
 {
@@ -137,15 +459,27 @@ struct DocumentP
     int iTransactionMode;
     int iTransactionCount;
     std::map<int,Transaction*> mTransactions;
-    std::map<Vertex,DocumentObject*> vertexMap;
     bool rollback;
     bool closable;
     bool keepTrailingDigits;
     int iUndoMode;
     unsigned int UndoMemSize;
     unsigned int UndoMaxStackSize;
-    DependencyList DepList;
-    std::map<DocumentObject*,Vertex> VertexObjectList;
+    DependencyGraph graph;
+    // objects of the running recompute
+    std::vector<DocumentObject*> recomputeObjects;
+    // objects touched since the last recompute
+    boost::unordered_set<DocumentObject*> touchedObjects;
+    int iRecomputeMode;
+    int numVisitedObjects;
+    int numExecutedObjects;
+    std::map<const DocumentObject*,float> recomputeTimes;
+    // property changes of objects executed by worker threads are
+    // collected and signaled afterwards from the calling thread
+    bool deferChanges;
+    QMutex changeMutex;
+    std::map<const DocumentObject*, std::vector<const Property*> > deferredChanges;
+    std::set<std::string> saveModes;
 
     DocumentP() {
         activeObject = 0;
@@ -159,6 +493,10 @@ struct DocumentP
         iUndoMode = 0;
         UndoMemSize = 0;
         UndoMaxStackSize = 20;
+        iRecomputeMode = 0;
+        numVisitedObjects = 0;
+        numExecutedObjects = 0;
+        deferChanges = false;
     }
 };
 
@@ -166,6 +504,30 @@ struct DocumentP
 
 PROPERTY_SOURCE(App::Document, App::PropertyContainer)
 
+static bool isLinkProperty(const Property* prop)
+{
+    return prop->isDerivedFrom(PropertyLink::getClassTypeId()) ||
+           prop->isDerivedFrom(PropertyLinkSub::getClassTypeId()) ||
+           prop->isDerivedFrom(PropertyLinkList::getClassTypeId()) ||
+           prop->isDerivedFrom(PropertyLinkSubList::getClassTypeId());
+}
+
+// splits a ';' separated list of a parameter value
+static std::set<std::string> splitParameterList(const std::string& str)
+{
+    std::set<std::string> list;
+    std::string::size_type pos = 0;
+    while (pos < str.size()) {
+        std::string::size_type next = str.find(';', pos);
+        if (next == std::string::npos)
+            next = str.size();
+        if (next > pos)
+            list.insert(str.substr(pos, next-pos));
+        pos = next + 1;
+    }
+    return list;
+}
+
 void Document::writeDependencyGraphViz(std::ostream &out)
 {
     //  // caching vertex to DocObject
@@ -509,17 +871,45 @@ void Document::onChanged(const Property* prop)
 
 void Document::onBeforeChangeProperty(const DocumentObject *Who, const Property *What)
 {
-    if (d->activeUndoTransaction && !d->rollback)
+    if (d->activeUndoTransaction && !d->rollback) {
+        QMutexLocker locker(&d->changeMutex);
         d->activeUndoTransaction->addObjectChange(Who,What);
+    }
 }
 
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
+    if (d->deferChanges) {
+        // called from a worker thread of the parallel recompute
+        QMutexLocker locker(&d->changeMutex);
+        if (d->activeTransaction && !d->rollback)
+            d->activeTransaction->addObjectChange(Who,What);
+        d->deferredChanges[Who].push_back(What);
+        if (!(What->getType() & Prop_Output))
+            d->touchedObjects.insert(const_cast<DocumentObject*>(Who));
+        return;
+    }
+
     if (d->activeTransaction && !d->rollback)
         d->activeTransaction->addObjectChange(Who,What);
+    if (!(What->getType() & Prop_Output))
+        d->touchedObjects.insert(const_cast<DocumentObject*>(Who));
+    if (isLinkProperty(What))
+        d->graph.updateObject(const_cast<DocumentObject*>(Who));
     signalChangedObject(*Who, *What);
 }
 
+void Document::onTouchedObject(DocumentObject *Who)
+{
+    if (d->deferChanges) {
+        QMutexLocker locker(&d->changeMutex);
+        d->touchedObjects.insert(Who);
+    }
+    else {
+        d->touchedObjects.insert(Who);
+    }
+}
+
 void Document::setTransactionMode(int iMode)
 {
     /*  if(_iTransactionMode == 0 && iMode == 1)
@@ -617,6 +1007,11 @@ Document::Document(void)
     ADD_PROPERTY_TYPE(TransientDir,(""),0,PropertyType(Prop_Transient|Prop_ReadOnly),
         "Transient directory, where the files live while the document is open");
     Uid.touch();
+
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document");
+    d->iRecomputeMode = hGrp->GetInt("RecomputeMode",RecomputeSequential);
+    d->saveModes = splitParameterList(hGrp->GetASCII("SaveModes", ""));
 }
 
 Document::~Document()
@@ -877,6 +1272,9 @@ Document::readObjects(Base::XMLReader& reader)
     }
     reader.readEndElement("ObjectData");
 
+    // the link properties are restored when all objects exist
+    _rebuildDependencyList();
+
     return objs;
 }
 
@@ -940,11 +1338,25 @@ bool Document::saveAs(const char* file)
     return save();
 }
 
+void Document::setSaveModes(const std::set<std::string>& modes)
+{
+    d->saveModes = modes;
+}
+
+const std::set<std::string>& Document::getSaveModes() const
+{
+    return d->saveModes;
+}
+
 // Save the document under the name it has been opened
 bool Document::save (void)
 {
-    int compression = App::GetApplication().GetParameterGroupByPath
-        ("User parameter:BaseApp/Preferences/Document")->GetInt("CompressionLevel",3);
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document");
+    int compression = hGrp->GetInt("CompressionLevel",3);
+    bool parallel = hGrp->GetBool("ParallelSave",false);
+    // files with these extensions are stored without compression, e.g. "bin;png"
+    std::set<std::string> stored = splitParameterList(hGrp->GetASCII("UncompressedFileTypes",""));
 
     if (*(FileName.getValue()) != '\0') {
         LastModifiedDate.setValue(Base::TimeInfo::currentDateTimeString());
@@ -963,6 +1375,10 @@ bool Document::save (void)
 
             writer.setComment("FreeCAD Document");
             writer.setLevel(compression);
+            writer.setParallel(parallel);
+            for (std::set<std::string>::iterator it = stored.begin(); it != stored.end(); ++it)
+                writer.addStoredExtension(*it);
+            writer.setModes(d->saveModes);
             writer.putNextEntry("Document.xml");
 
             Document::Save(writer);
@@ -1081,6 +1497,10 @@ void Document::restore (void)
     // Note: This file doesn't need to be available if the document has been created
     // without GUI. But if available then follow after all data files of the App document.
     signalRestoreDocument(reader);
+    // decode the embedded files in parallel if enabled
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document");
+    reader.setParallelRestore(hGrp->GetBool("ParallelRestore", false));
     reader.readFiles(zipstream);
     
     // reset all touched
@@ -1121,6 +1541,7 @@ void Document::purgeTouched()
 {
     for (std::vector<DocumentObject*>::iterator It = d->objectArray.begin();It != d->objectArray.end();++It)
         (*It)->purgeTouched();
+    d->touchedObjects.clear();
 }
 
 bool Document::isTouched() const
@@ -1159,63 +1580,28 @@ int Document::countObjects(void) const
 
 std::vector<App::DocumentObject*> Document::getInList(const DocumentObject* me) const
 {
-    // result list
-    std::vector<App::DocumentObject*> result;
-    // go through all objects
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        // get the outList and search if me is in that list
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2)
-            if (*It2 && *It2 == me)
-                // add the parent object
-                result.push_back(It->second);
-    }
-    return result;
+    return d->graph.getInList(me);
+}
+
+std::vector<App::DocumentObject*> Document::getOutList(const DocumentObject* me) const
+{
+    return d->graph.getOutList(me);
 }
 
 std::vector<App::DocumentObject*>
 Document::getDependencyList(const std::vector<App::DocumentObject*>& objs) const
 {
-    DependencyList DepList;
-    std::map<DocumentObject*,Vertex> ObjectMap;
-    std::map<Vertex,DocumentObject*> VertexMap;
-
-    // Filling up the adjacency List
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        // add the object as Vertex and remember the index
-        Vertex v = add_vertex(DepList);
-        ObjectMap[It->second] = v;
-        VertexMap[v] = It->second;
-    }
-    // add the edges
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2) {
-            if (*It2)
-                add_edge(ObjectMap[It->second],ObjectMap[*It2],DepList);
-        }
-    }
-
-    std::list<Vertex> make_order;
-    DependencyList::out_edge_iterator j, jend;
-
-    try {
-        // this sort gives the execute
-        boost::topological_sort(DepList, std::front_inserter(make_order));
-    }
-    catch (const std::exception&) {
+    std::vector<DocumentObject*> make_order;
+    if (!d->graph.getTopologicalOrder(make_order))
         return std::vector<App::DocumentObject*>();
-    }
 
     //std::vector<App::DocumentObject*> out;
     boost::unordered_set<App::DocumentObject*> out;
     for (std::vector<App::DocumentObject*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
-        std::map<DocumentObject*,Vertex>::iterator jt = ObjectMap.find(*it);
         // ok, object is part of this graph
-        if (jt != ObjectMap.end()) {
-            for (boost::tie(j, jend) = boost::out_edges(jt->second, DepList); j != jend; ++j) {
-                out.insert(VertexMap[boost::target(*j, DepList)]);
-            }
+        if (d->graph.hasObject(*it)) {
+            const std::vector<DocumentObject*>& deps = d->graph.getOutList(*it);
+            out.insert(deps.begin(), deps.end());
             out.insert(*it);
         }
     }
@@ -1227,21 +1613,35 @@ Document::getDependencyList(const std::vector<App::DocumentObject*>& objs) const
 
 void Document::_rebuildDependencyList(void)
 {
-    d->VertexObjectList.clear();
-    d->DepList.clear();
-    // Filling up the adjacency List
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        // add the object as Vertex and remember the index
-        d->VertexObjectList[It->second] = add_vertex(d->DepList);
-    }
-    // add the edges
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2) {
-            if (*It2)
-                add_edge(d->VertexObjectList[It->second],d->VertexObjectList[*It2],d->DepList);
-        }
-    }
+    d->graph.rebuild(d->objectArray);
+}
+
+void Document::setRecomputeMode(int iMode)
+{
+    d->iRecomputeMode = iMode;
+}
+
+int Document::getRecomputeMode(void) const
+{
+    return d->iRecomputeMode;
+}
+
+int Document::countVisitedObjects(void) const
+{
+    return d->numVisitedObjects;
+}
+
+int Document::countExecutedObjects(void) const
+{
+    return d->numExecutedObjects;
+}
+
+float Document::getRecomputeTime(const App::DocumentObject* Obj) const
+{
+    std::map<const DocumentObject*,float>::const_iterator it = d->recomputeTimes.find(Obj);
+    if (it != d->recomputeTimes.end())
+        return it->second;
+    return -1.0f;
 }
 
 void Document::recompute()
@@ -1250,77 +1650,172 @@ void Document::recompute()
     for( std::vector<App::DocumentObjectExecReturn*>::iterator it=_RecomputeLog.begin();it!=_RecomputeLog.end();++it)
         delete *it;
     _RecomputeLog.clear();
+    d->recomputeTimes.clear();
 
-    // updates the dependency graph
-    _rebuildDependencyList();
-
-    std::list<Vertex> make_order;
-    DependencyList::out_edge_iterator j, jend;
-
-    try {
-        // this sort gives the execute
-        boost::topological_sort(d->DepList, std::front_inserter(make_order));
+    // the dependency graph is kept up-to-date, this gives the execute
+    std::vector<DocumentObject*>& make_order = d->recomputeObjects;
+    bool isDAG;
+    if (d->iRecomputeMode & RecomputeTouched) {
+        // only the touched objects and everything downstream
+        std::vector<DocumentObject*> touched;
+        touched.insert(touched.end(), d->touchedObjects.begin(), d->touchedObjects.end());
+        isDAG = d->graph.getDependentOrder(touched, make_order);
+    }
+    else {
+        isDAG = d->graph.getTopologicalOrder(make_order);
     }
-    catch (const std::exception& e) {
-        std::cerr << "Document::recompute: " << e.what() << std::endl;
+    if (!isDAG) {
+        std::cerr << "Document::recompute: The graph must be a DAG." << std::endl;
+        make_order.clear();
         return;
     }
 
-    // caching vertex to DocObject
-    for (std::map<DocumentObject*,Vertex>::const_iterator It1= d->VertexObjectList.begin();It1 != d->VertexObjectList.end(); ++It1)
-        d->vertexMap[It1->second] = It1->first;
+    d->numVisitedObjects = (int)make_order.size();
+    d->numExecutedObjects = 0;
 
 #ifdef FC_LOGFEATUREUPDATE
     std::clog << "make ordering: " << std::endl;
 #endif
 
-    for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
-        DocumentObject* Cur = d->vertexMap[*i];
-        if (!Cur) continue;
+    // In parallel mode the vertices are grouped into levels where each vertex
+    // only depends on vertices of lower levels. All vertices of one level can
+    // be executed independently of each other. In sequential mode each vertex
+    // forms its own level.
+    std::vector< std::vector<std::size_t> > levels;
+    if (d->iRecomputeMode & RecomputeParallel) {
+        boost::unordered_map<const DocumentObject*, int> depth;
+        for (std::size_t i = 0; i < make_order.size(); i++) {
+            int level = 0;
+            const std::vector<DocumentObject*>& deps = d->graph.getOutList(make_order[i]);
+            for (std::vector<DocumentObject*>::const_iterator j = deps.begin(); j != deps.end(); ++j) {
+                boost::unordered_map<const DocumentObject*, int>::iterator k = depth.find(*j);
+                if (k != depth.end())
+                    level = std::max<int>(level, k->second + 1);
+            }
+            depth[make_order[i]] = level;
+            if (level >= (int)levels.size())
+                levels.resize(level+1);
+            levels[level].push_back(i);
+        }
+    }
+    else {
+        levels.reserve(make_order.size());
+        for (std::size_t i = 0; i < make_order.size(); i++)
+            levels.push_back(std::vector<std::size_t>(1, i));
+    }
+
+    for (std::vector< std::vector<std::size_t> >::iterator lt = levels.begin(); lt != levels.end(); ++lt) {
+        std::vector<RecomputeJob> jobs;
+        for (std::vector<std::size_t>::iterator i = lt->begin(); i != lt->end(); ++i) {
+            DocumentObject* Cur = make_order[*i];
+            if (!Cur) continue;
 #ifdef FC_LOGFEATUREUPDATE
-        std::clog << Cur->getNameInDocument() << " dep on: " ;
+            std::clog << Cur->getNameInDocument() << " dep on: " ;
 #endif
-        bool NeedUpdate = false;
-
-        // ask the object if it should be recomputed
-        if (Cur->mustExecute() == 1)
-            NeedUpdate = true;
-        else {// if (Cur->mustExecute() == -1)
-            // update if one of the dependencies is touched
-            for (boost::tie(j, jend) = out_edges(*i, d->DepList); j != jend; ++j) {
-                DocumentObject* Test = d->vertexMap[target(*j, d->DepList)];
-                if (!Test) continue;
+            bool NeedUpdate = false;
+
+            // ask the object if it should be recomputed
+            if (Cur->mustExecute() == 1)
+                NeedUpdate = true;
+            else {// if (Cur->mustExecute() == -1)
+                // update if one of the dependencies is touched
+                const std::vector<DocumentObject*>& deps = d->graph.getOutList(Cur);
+                for (std::vector<DocumentObject*>::const_iterator j = deps.begin(); j != deps.end(); ++j) {
+                    DocumentObject* Test = *j;
 #ifdef FC_LOGFEATUREUPDATE
-                std::clog << Test->getNameInDocument() << ", " ;
+                    std::clog << Test->getNameInDocument() << ", " ;
 #endif
-                if (Test->isTouched()) {
-                    NeedUpdate = true;
-                    break;
+                    if (Test->isTouched()) {
+                        NeedUpdate = true;
+                        break;
+                    }
                 }
-            }
 #ifdef FC_LOGFEATUREUPDATE
-            std::clog << std::endl;
+                std::clog << std::endl;
 #endif
-        }
-        // if one touched recompute
-        if (NeedUpdate) {
+            }
+            // if one touched recompute
+            if (NeedUpdate) {
 #ifdef FC_LOGFEATUREUPDATE
-            std::clog << "Recompute" << std::endl;
+                std::clog << "Recompute" << std::endl;
 #endif
-            if (_recomputeFeature(Cur)) {
-                // if somthing happen break execution of recompute
-                d->vertexMap.clear();
-                return;
+                RecomputeJob job;
+                job.object = Cur;
+                job.log = 0;
+                job.time = 0.0f;
+                job.abort = false;
+                jobs.push_back(job);
             }
         }
+
+        // objects which are not thread-safe are executed by the calling thread
+        std::vector<RecomputeJob*> serial;
+        std::vector<RecomputeJob> concurrent;
+        for (std::vector<RecomputeJob>::iterator jt = jobs.begin(); jt != jobs.end(); ++jt) {
+            if (jobs.size() > 1 && jt->object->isRecomputeThreadSafe())
+                concurrent.push_back(*jt);
+            else
+                serial.push_back(&(*jt));
+        }
+
+        if (!concurrent.empty()) {
+            d->deferChanges = true;
+            QtConcurrent::blockingMap(concurrent, boost::bind(&Document::_recomputeJob, this, _1));
+            d->deferChanges = false;
+
+            // copy back the results and signal the collected changes in a defined order
+            std::vector<RecomputeJob>::iterator ct = concurrent.begin();
+            for (std::vector<RecomputeJob>::iterator jt = jobs.begin(); jt != jobs.end(); ++jt) {
+                if (ct != concurrent.end() && ct->object == jt->object) {
+                    *jt = *ct++;
+                    std::map<const DocumentObject*, std::vector<const Property*> >::iterator
+                        pt = d->deferredChanges.find(jt->object);
+                    if (pt != d->deferredChanges.end()) {
+                        for (std::vector<const Property*>::iterator kt = pt->second.begin(); kt != pt->second.end(); ++kt) {
+                            if (isLinkProperty(*kt))
+                                d->graph.updateObject(jt->object);
+                            signalChangedObject(*jt->object, **kt);
+                        }
+                    }
+                }
+            }
+            d->deferredChanges.clear();
+        }
+
+        for (std::vector<RecomputeJob*>::iterator jt = serial.begin(); jt != serial.end(); ++jt)
+            _recomputeJob(**jt);
+
+        bool abort = false;
+        d->numExecutedObjects += (int)jobs.size();
+        for (std::vector<RecomputeJob>::iterator jt = jobs.begin(); jt != jobs.end(); ++jt) {
+            d->recomputeTimes[jt->object] = jt->time;
+            if (jt->log)
+                _RecomputeLog.push_back(jt->log);
+            if (jt->abort)
+                abort = true;
+        }
+
+        if (abort) {
+            // if somthing happen break execution of recompute
+            make_order.clear();
+            return;
+        }
     }
 
     // reset all touched
-    for (std::map<Vertex,DocumentObject*>::iterator it = d->vertexMap.begin(); it != d->vertexMap.end(); ++it) {
-        if (it->second)
-            it->second->purgeTouched();
+    for (std::vector<DocumentObject*>::iterator it = make_order.begin(); it != make_order.end(); ++it) {
+        if (*it)
+            (*it)->purgeTouched();
     }
-    d->vertexMap.clear();
+    make_order.clear();
+    d->touchedObjects.clear();
+}
+
+void Document::_recomputeJob(RecomputeJob& job)
+{
+    Base::TimeInfo start;
+    job.abort = _recomputeFeature(job.object, job.log);
+    job.time = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
 }
 
 const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
@@ -1332,7 +1827,7 @@ const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
 }
 
 // call the recompute of the Feature and handle the exceptions and errors.
-bool Document::_recomputeFeature(DocumentObject* Feat)
+bool Document::_recomputeFeature(DocumentObject* Feat, DocumentObjectExecReturn*& log)
 {
 #ifdef FC_LOGFEATUREUPDATE
     std::clog << "Solv: Executing Feature: " << Feat->getNameInDocument() << std::endl;;
@@ -1344,32 +1839,32 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
     }
     catch(Base::AbortException &e){
         e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("User abort",Feat));
+        log = new DocumentObjectExecReturn("User abort",Feat);
         Feat->setError();
         return true;
     }
     catch (const Base::MemoryException& e) {
         Base::Console().Error("Memory exception in feature '%s' thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("Out of memory exception",Feat));
+        log = new DocumentObjectExecReturn("Out of memory exception",Feat);
         Feat->setError();
         return true;
     }
     catch (Base::Exception &e) {
         e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
+        log = new DocumentObjectExecReturn(e.what(),Feat);
         Feat->setError();
         return false;
     }
     catch (std::exception &e) {
         Base::Console().Warning("exception in Feature \"%s\" thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
+        log = new DocumentObjectExecReturn(e.what(),Feat);
         Feat->setError();
         return false;
     }
 #ifndef FC_DEBUG
     catch (...) {
         Base::Console().Error("App::Document::_RecomputeFeature(): Unknown exception in Feature \"%s\" thrown\n",Feat->getNameInDocument());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("Unknown exeption!"));
+        log = new DocumentObjectExecReturn("Unknown exeption!");
         Feat->setError();
         return true;
     }
@@ -1381,7 +1876,7 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
     }
     else {
         returnCode->Which = Feat;
-        _RecomputeLog.push_back(returnCode);
+        log = returnCode;
 #ifdef FC_DEBUG
         Base::Console().Error("%s\n",returnCode->Why.c_str());
 #endif
@@ -1390,6 +1885,18 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
     return false;
 }
 
+// call the recompute of the Feature and store the error in the recompute log.
+bool Document::_recomputeFeature(DocumentObject* Feat)
+{
+    DocumentObjectExecReturn* log = 0;
+    Base::TimeInfo start;
+    bool abort = _recomputeFeature(Feat, log);
+    d->recomputeTimes[Feat] = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+    if (log)
+        _RecomputeLog.push_back(log);
+    return abort;
+}
+
 void Document::recomputeFeature(DocumentObject* Feat)
 {
      // delete recompute log
@@ -1442,8 +1949,8 @@ DocumentObject * Document::addObject(const char* sType, const char* pObjectName)
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
     // insert in the vector
     d->objectArray.push_back(pcObject);
-    // insert in the adjacence list and referenc through the ConectionMap
-    //_DepConMap[pcObject] = add_vertex(_DepList);
+    // insert in the dependency graph
+    d->graph.addObject(pcObject);
 
     pcObject->Label.setValue( ObjectName );
 
@@ -1462,6 +1969,7 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
     d->objectArray.push_back(pcObject);
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(pObjectName)->first);
+    d->graph.addObject(pcObject);
 
     // do no transactions if we do a rollback!
     if(!d->rollback){
@@ -1491,11 +1999,11 @@ void Document::remObject(const char* sName)
         d->activeObject = 0;
 
     signalDeletedObject(*(pos->second));
-    if (!d->vertexMap.empty()) {
+    if (!d->recomputeObjects.empty()) {
         // recompute of document is running
-        for (std::map<Vertex,DocumentObject*>::iterator it = d->vertexMap.begin(); it != d->vertexMap.end(); ++it) {
-            if (it->second == pos->second) {
-                it->second = 0; // just nullify the pointer
+        for (std::vector<DocumentObject*>::iterator it = d->recomputeObjects.begin(); it != d->recomputeObjects.end(); ++it) {
+            if (*it == pos->second) {
+                *it = 0; // just nullify the pointer
                 break;
             }
         }
@@ -1503,6 +2011,8 @@ void Document::remObject(const char* sName)
 
     // Before deleting we must nullify all dependant objects
     breakDependency(pos->second, true);
+    d->graph.removeObject(pos->second);
+    d->touchedObjects.erase(pos->second);
 
     // do no transactions if we do a rollback!
     if(!d->rollback){
@@ -1529,9 +2039,6 @@ void Document::remObject(const char* sName)
             break;
         }
     }
-    // remove from adjancy list
-    //remove_vertex(_DepConMap[pos->second],_DepList);
-    //_DepConMap.erase(pos->second);
     d->objectMap.erase(pos);
 }
 
@@ -1559,6 +2066,8 @@ void Document::_remObject(DocumentObject* pcObject)
     }
     // remove from map
     d->objectMap.erase(pos);
+    d->graph.removeObject(pcObject);
+    d->touchedObjects.erase(pcObject);
     //// set name cache false
     //pcObject->pcNameInDocument = 0;
 
@@ -1573,9 +2082,14 @@ void Document::_remObject(DocumentObject* pcObject)
 void Document::breakDependency(DocumentObject* pcObject, bool clear)
 {
     // Nullify all dependant objects
-    for (std::map<std::string,DocumentObject*>::iterator it = d->objectMap.begin(); it != d->objectMap.end(); ++it) {
+    std::set<DocumentObject*> objs;
+    const std::vector<DocumentObject*>& in = d->graph.getInList(pcObject);
+    objs.insert(in.begin(), in.end());
+    if (clear)
+        objs.insert(pcObject);
+    for (std::set<DocumentObject*>::iterator it = objs.begin(); it != objs.end(); ++it) {
         std::map<std::string,App::Property*> Map;
-        it->second->getPropertyMap(Map);
+        (*it)->getPropertyMap(Map);
         // search for all properties that could have a link to the object
         for (std::map<std::string,App::Property*>::iterator pt = Map.begin(); pt != Map.end(); ++pt) {
             if (pt->second->getTypeId().isDerivedFrom(PropertyLink::getClassTypeId())) {
@@ -32,6 +32,7 @@
 #include "PropertyStandard.h"
 
 #include <map>
+#include <set>
 #include <vector>
 #include <stack>
 
@@ -51,6 +52,7 @@ namespace App
     class DocumentPy; // the python document class
     class Application;
     class Transaction;
+    struct RecomputeJob;
 }
 
 namespace App
@@ -134,6 +136,14 @@ public:
     /// Save the document to the file in Property Path
     bool save (void);
     bool saveAs(const char* file);
+    /** Save modes of the document
+     * The modes are passed to the Base::Writer when saving the document and
+     * let the objects choose how to write their data, e.g. "DirectBrep" to
+     * stream shapes into the project file without a temporary file. They are
+     * initialized from the SaveModes preference (separated by ';').
+     */
+    void setSaveModes(const std::set<std::string>& modes);
+    const std::set<std::string>& getSaveModes() const;
     /// Restore the document from the file in Property Path
     void restore (void);
     void exportObjects(const std::vector<App::DocumentObject*>&, std::ostream&);
@@ -208,6 +218,32 @@ public:
     bool isClosable() const;
     /// Recompute all touched features
     void recompute();
+    /** Recompute modes
+     * In sequential mode the touched objects are executed one after another
+     * in topological order. In parallel mode all objects whose dependencies
+     * are up-to-date are executed concurrently on the global thread pool,
+     * except the objects which are not thread-safe (see
+     * DocumentObject::isRecomputeThreadSafe()). The recompute log is sorted
+     * by the topological order in both modes.
+     * With RecomputeTouched only the objects touched since the last recompute
+     * and the objects depending on them are checked instead of the whole
+     * document. It can be combined with both modes.
+     */
+    enum RecomputeMode {
+        RecomputeSequential = 0,
+        RecomputeParallel   = 1,
+        RecomputeTouched    = 2
+    };
+    /// switch the recompute mode
+    void setRecomputeMode(int iMode);
+    /// get the recompute mode
+    int getRecomputeMode(void) const;
+    /// get the number of objects checked for the need of an update in the last recompute
+    int countVisitedObjects(void) const;
+    /// get the number of objects executed in the last recompute
+    int countExecutedObjects(void) const;
+    /// get the wall time in seconds the object needed in the last recompute or -1 if not executed
+    float getRecomputeTime(const App::DocumentObject*) const;
     /// Recompute only one feature
     void recomputeFeature(DocumentObject* Feat);
     /// get the error log from the recompute run
@@ -265,6 +301,8 @@ public:
     bool checkOnCycle(void);
     /// get a list of all objects linking to the given object
     std::vector<App::DocumentObject*> getInList(const DocumentObject* me) const;
+    /// get a list of all objects the given object is linking to
+    std::vector<App::DocumentObject*> getOutList(const DocumentObject* me) const;
     /// Get a complete list of all objects the given objects depend on. The list
     /// also contains the given objects!
     std::vector<App::DocumentObject*> getDependencyList
@@ -303,10 +341,19 @@ protected:
     void onBeforeChangeProperty(const DocumentObject *Who, const Property *What);
     /// callback from the Document objects after property was changed
     void onChangedProperty(const DocumentObject *Who, const Property *What);
+    /// callback from the Document objects after they were touched
+    void onTouchedObject(DocumentObject *Who);
     /// helper which Recompute only this feature
     bool _recomputeFeature(DocumentObject* Feat);
+    /// helper which Recompute only this feature and returns the log entry instead of storing it
+    bool _recomputeFeature(DocumentObject* Feat, DocumentObjectExecReturn*& log);
+    /// helper which executes a recompute job of the parallel recompute
+    void _recomputeJob(RecomputeJob& job);
     void _clearRedos();
-    /// refresh the internal dependency graph
+    /** refresh the internal dependency graph
+     * Normally the graph is updated on each change of a link property,
+     * so this is only needed after restoring a document.
+     */
     void _rebuildDependencyList(void);
     std::string getTransientDirectoryName(const std::string& uuid, const std::string& filename) const;
 
@@ -215,6 +215,8 @@ std::vector<PyObject *> DocumentObject::getPySubObjects(const std::vector<std::s
 void DocumentObject::touch(void)
 {
     StatusBits.set(0);
+    if (_pDoc)
+        _pDoc->onTouchedObject(this);
 }
 
 void DocumentObject::Save (Base::Writer &writer) const
@@ -113,6 +113,12 @@ public:
     bool isRestoring() const {return StatusBits.test(4);}
     /// recompute only this object
     virtual App::DocumentObjectExecReturn *recompute(void);
+    /** Returns true if this object can be recomputed by a worker thread
+     * concurrently to other independent objects of the document. Only classes
+     * whose execute() neither runs Python code nor uses the GUI, the sequencer,
+     * the parameters or any other shared state may return true.
+     */
+    virtual bool isRecomputeThreadSafe(void) const {return false;}
     /// return the status bits
     unsigned long getStatus() const {return StatusBits.to_ulong();}
     bool testStatus(ObjectStatus pos) const {return StatusBits.test((size_t)pos);}
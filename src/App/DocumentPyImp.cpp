@@ -29,6 +29,7 @@
 
 #include "Document.h"
 #include <Base/FileInfo.h>
+#include <Base/Interpreter.h>
 #include "DocumentObject.h"
 #include "DocumentObjectPy.h"
 
@@ -315,7 +316,14 @@ PyObject*  DocumentPy::recompute(PyObject * args)
 {
     if (!PyArg_ParseTuple(args, ""))     // convert args: Python->C 
         return NULL;                    // NULL triggers exception 
-    getDocumentPtr()->recompute();
+    if (getDocumentPtr()->getRecomputeMode() & Document::RecomputeParallel) {
+        // worker threads may need the interpreter lock, e.g. for console output
+        Base::PyGILStateRelease unlock;
+        getDocumentPtr()->recompute();
+    }
+    else {
+        getDocumentPtr()->recompute();
+    }
     Py_Return;
 }
 
@@ -431,6 +439,43 @@ void  DocumentPy::setUndoMode(Py::Int arg)
     getDocumentPtr()->setUndoMode(arg); 
 }
 
+Py::Int DocumentPy::getRecomputeMode(void) const
+{
+    return Py::Int(getDocumentPtr()->getRecomputeMode());
+}
+
+void  DocumentPy::setRecomputeMode(Py::Int arg)
+{
+    getDocumentPtr()->setRecomputeMode(arg);
+}
+
+Py::List DocumentPy::getSaveModes(void) const
+{
+    Py::List res;
+    const std::set<std::string>& modes = getDocumentPtr()->getSaveModes();
+    for (std::set<std::string>::const_iterator it = modes.begin(); it != modes.end(); ++it)
+        res.append(Py::String(*it));
+    return res;
+}
+
+void  DocumentPy::setSaveModes(Py::List arg)
+{
+    std::set<std::string> modes;
+    for (Py::List::iterator it = arg.begin(); it != arg.end(); ++it)
+        modes.insert(Py::String(*it).as_std_string());
+    getDocumentPtr()->setSaveModes(modes);
+}
+
+Py::Int DocumentPy::getRecomputeVisited(void) const
+{
+    return Py::Int(getDocumentPtr()->countVisitedObjects());
+}
+
+Py::Int DocumentPy::getRecomputeExecuted(void) const
+{
+    return Py::Int(getDocumentPtr()->countExecutedObjects());
+}
+
 Py::Int DocumentPy::getUndoRedoMemSize(void) const
 {
     return Py::Int((long)getDocumentPtr()->getUndoMemSize());
@@ -85,6 +85,10 @@ public:
     virtual DocumentObjectExecReturn *execute(void) {
         return imp->execute();
     }
+    /// the Python interpreter must not be entered from worker threads
+    virtual bool isRecomputeThreadSafe(void) const {
+        return false;
+    }
     /// returns the type name of the ViewProvider
     virtual const char* getViewProviderName(void) const {
         return FeatureT::getViewProviderName();
@@ -102,6 +102,8 @@ public:
   //@{
   /// recalculate the Feature
   virtual DocumentObjectExecReturn *execute(void);
+  /// only sets its own properties
+  virtual bool isRecomputeThreadSafe(void) const {return true;}
   /// returns the type name of the ViewProvider
   //FIXME: Propably it makes sense to have a view provider for unittests (e.g. Gui::ViewProviderTest)
   virtual const char* getViewProviderName(void) const {
@@ -68,3 +68,21 @@ void Persistence::SaveDocFile (Writer &/*writer*/) const
 void Persistence::RestoreDocFile(Reader &/*reader*/)
 {
 }
+
+bool Persistence::isRestoreThreadSafe() const
+{
+    return false;
+}
+
+void Persistence::decodeDocFile(Reader &/*reader*/)
+{
+}
+
+void Persistence::applyDocFile()
+{
+}
+
+bool Persistence::isSaveThreadSafe(const Writer &/*writer*/) const
+{
+    return false;
+}
@@ -146,6 +146,30 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+
+    /** @name Parallel restore
+     * If isRestoreThreadSafe() returns true the reader may restore the file
+     * in two steps: decodeDocFile() is called from a worker thread and must
+     * only keep the decoded data, it must not notify any observers or write
+     * to the console. Afterwards applyDocFile() is called from the main thread
+     * in the order of the files to set the decoded data.
+     * If decodeDocFile() throws an exception applyDocFile() is not called.
+     */
+    //@{
+    /// returns true if decodeDocFile() can be called from a worker thread
+    virtual bool isRestoreThreadSafe() const;
+    /// decode the file without changing the visible state of the object
+    virtual void decodeDocFile(Reader &/*reader*/);
+    /// set the data read in by decodeDocFile()
+    virtual void applyDocFile();
+    //@}
+
+    /** Returns true if SaveDocFile() can be called from a worker thread.
+     * The writer passed to SaveDocFile() then is a memory writer with the
+     * same modes as \a writer. If SaveDocFile() adds further files to it the
+     * object is saved again with \a writer. See ZipWriter::setParallel().
+     */
+    virtual bool isSaveThreadSafe(const Writer &/*writer*/) const;
 };
 
 } //namespace Base
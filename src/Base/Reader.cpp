@@ -31,6 +31,9 @@
 #endif
 
 #include <locale>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <QtConcurrentMap>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Reader.h"
@@ -60,7 +63,7 @@ using namespace std;
 // ---------------------------------------------------------------------------
 
 Base::XMLReader::XMLReader(const char* FileName, std::istream& str) 
-  : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0), _File(FileName)
+  : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0), _File(FileName), _parallel(false)
 {
 #ifdef _MSC_VER
     str.imbue(std::locale::empty());
@@ -273,8 +276,67 @@ void Base::XMLReader::readBinFile(const char* filename)
     to.close();
 }
 
+void Base::XMLReader::setParallelRestore(bool on)
+{
+    _parallel = on;
+}
+
+bool Base::XMLReader::isParallelRestore() const
+{
+    return _parallel;
+}
+
+namespace Base {
+struct DocFileJob
+{
+    Base::Persistence* object;
+    std::string fileName;
+    std::string data;
+    bool failed;
+};
+}
+
+static void decodeDocFileJob(Base::DocFileJob& job, int version)
+{
+    if (job.failed)
+        return;
+    try {
+        std::istringstream str(job.data);
+        // the data is not needed any more
+        std::string().swap(job.data);
+        Base::Reader reader(str, job.fileName, version);
+        job.object->decodeDocFile(reader);
+    }
+    catch (...) {
+        job.failed = true;
+    }
+}
+
+// Decodes the files in parallel and hands the data over to the objects in the
+// order of the files
+static void finishDocFileJobs(std::vector<Base::DocFileJob>& jobs, int version)
+{
+    QtConcurrent::blockingMap(jobs, boost::bind(&decodeDocFileJob, _1, version));
+    for (std::vector<Base::DocFileJob>::iterator jt = jobs.begin(); jt != jobs.end(); ++jt) {
+        try {
+            if (jt->failed)
+                throw Base::Exception("Decoding failed");
+            jt->object->applyDocFile();
+        }
+        catch(...) {
+            Base::Console().Error("Reading failed from embedded file: %s\n", jt->fileName.c_str());
+        }
+    }
+    jobs.clear();
+}
+
 void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
 {
+    if (_parallel) {
+        readFilesParallel(zipstream);
+        return;
+    }
+
     // It's possible that not all objects inside the document could be created, e.g. if a module
     // is missing that would know these object types. So, there may be data files inside the zip
     // file that cannot be read. We simply ignore these files. 
@@ -304,7 +366,7 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // no file name for the current entry in the zip was registered.
         if (jt != FileList.end()) {
             try {
-                Base::Reader reader(zipstream,DocumentSchema);
+                Base::Reader reader(zipstream,jt->FileName,DocumentSchema);
                 jt->Object->RestoreDocFile(reader);
             }
             catch(...) {
@@ -332,6 +394,71 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
     }
 }
 
+void Base::XMLReader::readFilesParallel(zipios::ZipInputStream &zipstream) const
+{
+    // The registered files are searched in the order of the zip file like in
+    // readFiles(). The files of thread-safe objects are read into memory and
+    // decoded in parallel. Any other object first waits until all files before
+    // it are restored and then reads its file directly from the zip stream. So
+    // it may read further files of the stream itself, e.g. the GUI document
+    // reads the files registered by its view providers.
+    zipios::ConstEntryPointer entry;
+    try {
+        entry = zipstream.getNextEntry();
+    }
+    catch (const std::exception&) {
+        return;
+    }
+
+    std::vector<DocFileJob> jobs;
+    std::vector<FileEntry>::const_iterator it = FileList.begin();
+    Base::SequencerLauncher seq("Importing project files...", FileList.size());
+    while (entry->isValid() && it != FileList.end()) {
+        std::vector<FileEntry>::const_iterator jt = it;
+        while (jt != FileList.end() && entry->getName() != jt->FileName)
+            ++jt;
+        if (jt != FileList.end()) {
+            if (jt->Object->isRestoreThreadSafe()) {
+                DocFileJob job;
+                job.object = jt->Object;
+                job.fileName = jt->FileName;
+                job.failed = false;
+                jobs.push_back(job);
+                try {
+                    std::string& data = jobs.back().data;
+                    data.assign(std::istreambuf_iterator<char>(zipstream),
+                                std::istreambuf_iterator<char>());
+                }
+                catch (...) {
+                    jobs.back().failed = true;
+                }
+            }
+            else {
+                finishDocFileJobs(jobs, DocumentSchema);
+                try {
+                    Base::Reader reader(zipstream,jt->FileName,DocumentSchema);
+                    jt->Object->RestoreDocFile(reader);
+                }
+                catch(...) {
+                    Base::Console().Error("Reading failed from embedded file: %s\n", entry->toString().c_str());
+                }
+            }
+            it = jt + 1;
+        }
+
+        seq.next();
+
+        try {
+            entry = zipstream.getNextEntry();
+        }
+        catch (const std::exception&) {
+            break;
+        }
+    }
+
+    finishDocFileJobs(jobs, DocumentSchema);
+}
+
 const char *Base::XMLReader::addFile(const char* Name, Base::Persistence *Object)
 {
     FileEntry temp;
@@ -481,9 +608,14 @@ void Base::XMLReader::resetErrors()
 
 // ----------------------------------------------------------
 
-Base::Reader::Reader(std::istream& str, int version)
-  : std::istream(str.rdbuf()), _str(str), fileVersion(version)
+Base::Reader::Reader(std::istream& str, const std::string& name, int version)
+  : std::istream(str.rdbuf()), _str(str), _name(name), fileVersion(version)
+{
+}
+
+std::string Base::Reader::getFileName() const
 {
+    return this->_name;
 }
 
 int Base::Reader::getFileVersion() const
@@ -156,6 +156,12 @@ public:
     const char *addFile(const char* Name, Base::Persistence *Object);
     /// process the requested file writes
     void readFiles(zipios::ZipInputStream &zipstream) const;
+    /** Decode the files of objects that support it in parallel. The files of
+     * these objects are read into memory first, see Persistence::isRestoreThreadSafe().
+     * Other objects read their files from the zip stream as with readFiles().
+     */
+    void setParallelRestore(bool);
+    bool isParallelRestore() const;
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
     bool isRegistered(Base::Persistence *Object) const;
@@ -200,6 +206,9 @@ protected:
     void fatalError(const XERCES_CPP_NAMESPACE_QUALIFIER SAXParseException& exc);
     void resetErrors();
 
+    /// the parallel version of readFiles()
+    void readFilesParallel(zipios::ZipInputStream &zipstream) const;
+
 
     int Level;
     std::string LocalName;
@@ -224,6 +233,7 @@ protected:
     XERCES_CPP_NAMESPACE_QUALIFIER SAX2XMLReader* parser;
     XERCES_CPP_NAMESPACE_QUALIFIER XMLPScanToken token;
     bool _valid;
+    bool _parallel;
 
     struct FileEntry {
         std::string FileName;
@@ -236,12 +246,15 @@ protected:
 class BaseExport Reader : public std::istream
 {
 public:
-    Reader(std::istream&, int version);
+    Reader(std::istream&, const std::string&, int version);
     int getFileVersion() const;
     std::istream& getStream();
+    /// name of the embedded file that is read in
+    std::string getFileName() const;
 
 private:
     std::istream& _str;
+    std::string _name;
     int fileVersion;
 };
 
@@ -28,6 +28,8 @@
 # include <iostream>
 #endif
 
+#include <boost/cstdint.hpp>
+
 # include <QTime>
 #include <Python.h>
 #include "Tools.h"
@@ -152,6 +154,79 @@ std::string Base::Tools::escapedUnicodeFromUtf8(const char *s)
     return escapedstr;
 }
 
+bool Base::Tools::scanNumber(const char*& p, const char* end, double& value)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* s = p;
+    bool negative = false;
+    if (s != end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    // at most 19 significant digits fit into the mantissa, further digits only scale it
+    boost::uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; s != end && *s >= '0' && *s <= '9'; ++s) {
+        any = true;
+        if (digits < 19) {
+            mantissa = 10 * mantissa + (*s - '0');
+            if (mantissa > 0)
+                digits++;
+        }
+        else {
+            exponent++;
+        }
+    }
+    if (s != end && *s == '.') {
+        for (++s; s != end && *s >= '0' && *s <= '9'; ++s) {
+            any = true;
+            if (digits < 19) {
+                mantissa = 10 * mantissa + (*s - '0');
+                if (mantissa > 0)
+                    digits++;
+                exponent--;
+            }
+        }
+    }
+    if (!any)
+        return false;
+
+    if (s != end && (*s == 'e' || *s == 'E')) {
+        ++s;
+        bool negexp = false;
+        if (s != end && (*s == '-' || *s == '+')) {
+            negexp = (*s == '-');
+            ++s;
+        }
+        if (s == end || *s < '0' || *s > '9')
+            return false;
+        int e = 0;
+        for (; s != end && *s >= '0' && *s <= '9'; ++s) {
+            if (e < 10000)
+                e = 10 * e + (*s - '0');
+        }
+        exponent += negexp ? -e : e;
+    }
+
+    double v = (double)mantissa;
+    if (exponent < 0 && exponent >= -22)
+        v /= pow10[-exponent];
+    else if (exponent > 0 && exponent <= 22)
+        v *= pow10[exponent];
+    else if (exponent != 0)
+        v *= std::pow(10.0, exponent);
+
+    value = negative ? -v : v;
+    p = s;
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 
 using namespace Base;
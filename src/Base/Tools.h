@@ -154,6 +154,14 @@ struct BaseExport Tools
     static std::wstring widen(const std::string& str);
     static std::string narrow(const std::wstring& str);
     static std::string escapedUnicodeFromUtf8(const char *s);
+    /// Checks for a space or tab or any other white space except of a line break
+    static inline bool isBlank(char c)
+    { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+    /** Reads a number of the form [+-]ddd.ddd[eE[+-]ddd] from the range [\a p, \a end)
+     * and advances \a p behind it. Unlike strtod() it neither depends on the locale
+     * nor needs a null-terminated string. Returns false if there is no number at \a p.
+     */
+    static bool scanNumber(const char*& p, const char* end, double& value);
 };
 
 } // namespace Base
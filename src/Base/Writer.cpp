@@ -37,6 +37,9 @@
 
 #include <algorithm>
 #include <locale>
+#include <boost/bind.hpp>
+#include <QtConcurrentMap>
+#include <zlib.h>
 
 using namespace Base;
 using namespace std;
@@ -98,6 +101,34 @@ bool Writer::isForceXML(void)
     return forceXML;
 }
 
+void Writer::setMode(const std::string& mode)
+{
+    Modes.insert(mode);
+}
+
+void Writer::setModes(const std::set<std::string>& modes)
+{
+    Modes.insert(modes.begin(), modes.end());
+}
+
+bool Writer::getMode(const std::string& mode) const
+{
+    std::set<std::string>::const_iterator it = Modes.find(mode);
+    return (it != Modes.end());
+}
+
+const std::set<std::string>& Writer::getModes() const
+{
+    return Modes;
+}
+
+void Writer::clearMode(const std::string& mode)
+{
+    std::set<std::string>::iterator it = Modes.find(mode);
+    if (it != Modes.end())
+        Modes.erase(it);
+}
+
 void Writer::setFileVersion(int v)
 {
     fileVersion = v;
@@ -179,7 +210,7 @@ void Writer::decInd(void)
 }
 
 ZipWriter::ZipWriter(const char* FileName) 
-  : ZipStream(FileName)
+  : ZipStream(FileName), Level(ZipOutputStreambuf::DEFAULT_COMPRESSION), Parallel(false)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -192,7 +223,7 @@ ZipWriter::ZipWriter(const char* FileName)
 }
 
 ZipWriter::ZipWriter(std::ostream& os) 
-  : ZipStream(os)
+  : ZipStream(os), Level(ZipOutputStreambuf::DEFAULT_COMPRESSION), Parallel(false)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -204,16 +235,169 @@ ZipWriter::ZipWriter(std::ostream& os)
     ZipStream.setf(ios::fixed,ios::floatfield);
 }
 
+namespace Base {
+struct ZipFileJob
+{
+    const Base::Persistence* object;
+    std::string fileName;
+    bool threadSafe;
+    bool stored;
+    bool failed;
+    std::string data;
+    zipios::uint32 size;
+    zipios::uint32 crc;
+};
+}
+
+/* Serializes the file of the job into memory and compresses it with raw
+ * deflate as needed for zip entries. Returns false if the object added
+ * further files to the writer, which would be lost with the memory writer.
+ * Then the object must be saved with the real writer.
+ */
+static bool encodeZipFile(ZipFileJob& job, const std::set<std::string>& modes,
+                          int version, int level)
+{
+    StringWriter writer;
+    writer.Stream().imbue(std::locale::classic());
+    writer.Stream().precision(12);
+    writer.Stream().setf(ios::fixed,ios::floatfield);
+    writer.setModes(modes);
+    writer.setFileVersion(version);
+    job.object->SaveDocFile(writer);
+    if (!writer.getFilenames().empty())
+        return false;
+
+    std::string raw = writer.getString();
+    job.size = static_cast<uint32>(raw.size());
+    job.crc = crc32(0, Z_NULL, 0);
+    job.crc = crc32(job.crc, reinterpret_cast<const Bytef*>(raw.data()), job.size);
+    if (job.stored) {
+        job.data.swap(raw);
+        return true;
+    }
+
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+    // negative window bits to omit the zlib header
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw Base::Exception("Cannot initialize compression");
+    std::vector<char> buf(deflateBound(&zs, job.size));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(raw.data()));
+    zs.avail_in = job.size;
+    zs.next_out = reinterpret_cast<Bytef*>(&buf[0]);
+    zs.avail_out = static_cast<uInt>(buf.size());
+    int err = deflate(&zs, Z_FINISH);
+    uLong count = zs.total_out;
+    deflateEnd(&zs);
+    if (err != Z_STREAM_END)
+        throw Base::Exception("Compression failed");
+    job.data.assign(&buf[0], count);
+    return true;
+}
+
+// runs in a worker thread
+static void encodeZipFileJob(ZipFileJob& job, const std::set<std::string>& modes,
+                             int version, int level)
+{
+    if (!job.threadSafe)
+        return;
+    try {
+        if (!encodeZipFile(job, modes, version, level)) {
+            job.failed = true;
+            std::string().swap(job.data);
+        }
+    }
+    catch (...) {
+        job.failed = true;
+        std::string().swap(job.data);
+    }
+}
+
+bool ZipWriter::isStored(const std::string& fileName) const
+{
+    if (StoredExtensions.empty())
+        return false;
+    std::string::size_type pos = fileName.rfind('.');
+    if (pos == std::string::npos)
+        return false;
+    return StoredExtensions.find(fileName.substr(pos+1)) != StoredExtensions.end();
+}
+
 void ZipWriter::writeFiles(void)
 {
+    if (Parallel) {
+        writeFilesParallel();
+        return;
+    }
+
     // use a while loop because it is possible that while
     // processing the files new ones can be added
     size_t index = 0;
     while (index < FileList.size()) {
         FileEntry entry = FileList.begin()[index];
+        index++;
+        if (isStored(entry.FileName)) {
+            // the sizes must be known in advance
+            ZipFileJob job;
+            job.object = entry.Object;
+            job.fileName = entry.FileName;
+            job.threadSafe = false;
+            job.stored = true;
+            job.failed = false;
+            if (encodeZipFile(job, Modes, fileVersion, Level)) {
+                ZipStream.putRawEntry(ZipCDirEntry(job.fileName), STORED,
+                    job.data.c_str(), job.size, job.size, job.crc);
+                continue;
+            }
+            // the object adds further files, so it is compressed as usual
+        }
+
         ZipStream.putNextEntry(entry.FileName);
         entry.Object->SaveDocFile(*this);
-        index++;
+    }
+}
+
+void ZipWriter::writeFilesParallel(void)
+{
+    // Files can be added while processing the files, they are
+    // handled in the next round
+    size_t index = 0;
+    while (index < FileList.size()) {
+        std::vector<ZipFileJob> jobs;
+        for (size_t i = index; i < FileList.size(); i++) {
+            ZipFileJob job;
+            job.object = FileList[i].Object;
+            job.fileName = FileList[i].FileName;
+            job.threadSafe = job.object->isSaveThreadSafe(*this);
+            job.stored = isStored(job.fileName);
+            job.failed = false;
+            job.size = 0;
+            job.crc = 0;
+            jobs.push_back(job);
+        }
+        index = FileList.size();
+
+        QtConcurrent::blockingMap(jobs, boost::bind(&encodeZipFileJob, _1,
+            boost::cref(Modes), fileVersion, Level));
+
+        for (std::vector<ZipFileJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            // objects that are not thread-safe or failed are saved the usual way,
+            // as are objects that add further files to the writer
+            if (!it->threadSafe || it->failed) {
+                if (!it->stored || it->failed || !encodeZipFile(*it, Modes, fileVersion, Level)) {
+                    ZipStream.putNextEntry(it->fileName);
+                    it->object->SaveDocFile(*this);
+                    continue;
+                }
+            }
+
+            ZipStream.putRawEntry(ZipCDirEntry(it->fileName),
+                it->stored ? STORED : DEFLATED,
+                it->data.c_str(), static_cast<uint32>(it->data.size()), it->size, it->crc);
+            std::string().swap(it->data);
+        }
     }
 }
 
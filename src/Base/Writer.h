@@ -24,6 +24,7 @@
 #define BASE_WRITER_H
 
 
+#include <set>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -65,6 +66,23 @@ public:
     void setFileVersion(int);
     int getFileVersion() const;
 
+    /** @name Modes
+     * The modes give the persistent objects a hint how to write their
+     * data, e.g. to choose a file format.
+     */
+    //@{
+    /// set a mode
+    void setMode(const std::string& mode);
+    /// set several modes at once
+    void setModes(const std::set<std::string>& modes);
+    /// check if the mode is set
+    bool getMode(const std::string& mode) const;
+    /// get all modes
+    const std::set<std::string>& getModes() const;
+    /// unset a mode
+    void clearMode(const std::string& mode);
+    //@}
+
     /// insert a file as CDATA section in the XML file
     void insertAsciiFile(const char* FileName);
     /// insert a binary file BASE64 coded as CDATA section in the XML file
@@ -103,6 +121,7 @@ protected:
     };
     std::vector<FileEntry> FileList;
     std::vector<std::string> FileNames;
+    std::set<std::string> Modes;
 
     short indent;
     char indBuf[256];
@@ -131,11 +150,26 @@ public:
     virtual std::ostream &Stream(void){return ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    void setLevel(int level){Level = level; ZipStream.setLevel( level );}
     void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
 
+    /** Serialize and compress the files of objects that support it in
+     * worker threads, see Persistence::isSaveThreadSafe(). The files are
+     * still written to the archive in the order they were added.
+     */
+    void setParallel(bool on){Parallel = on;}
+    /// Store files with this extension without compression, e.g. already compressed data
+    void addStoredExtension(const std::string& ext){StoredExtensions.insert(ext);}
+
+private:
+    bool isStored(const std::string& fileName) const;
+    void writeFilesParallel(void);
+
 private:
     zipios::ZipOutputStream ZipStream;
+    int Level;
+    bool Parallel;
+    std::set<std::string> StoredExtensions;
 };
 
 /** The StringWriter class 
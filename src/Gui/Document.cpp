@@ -712,9 +712,11 @@ void Document::RestoreDocFile(Base::Reader &reader)
 
     xmlReader.readEndElement("Document");
 
-    // In the file GuiDocument.xml new data files might be added
-    if (!xmlReader.getFilenames().empty())
-        xmlReader.readFiles(static_cast<zipios::ZipInputStream&>(reader.getStream()));
+    // In the file GuiDocument.xml new data files might be added. They can only
+    // be read if this file is read directly from the zip stream.
+    zipios::ZipInputStream* zipstream = dynamic_cast<zipios::ZipInputStream*>(&reader.getStream());
+    if (!xmlReader.getFilenames().empty() && zipstream)
+        xmlReader.readFiles(*zipstream);
 
     // reset modified flag
     setModified(false);
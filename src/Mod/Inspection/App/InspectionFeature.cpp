@@ -23,13 +23,25 @@
 
 #include "PreCompiled.h"
 #include <gp_Pnt.hxx>
+#include <Bnd_Box.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
 
-#include <QEventLoop>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QMutexLocker>
 #include <QtConcurrentMap>
 
 #include <boost/signals.hpp>
@@ -37,7 +49,6 @@
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
-#include <Base/FutureWatcherProgress.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
@@ -45,6 +56,7 @@
 #include <Mod/Mesh/App/Mesh.h>
 #include <Mod/Mesh/App/MeshFeature.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/BVH.h>
 #include <Mod/Mesh/App/Core/Grid.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
@@ -74,8 +86,10 @@ unsigned long InspectActualMesh::countPoints() const
 
 Base::Vector3f InspectActualMesh::getPoint(unsigned long index)
 {
-    _iter.Set(index);
-    return *_iter;
+    // the iterator keeps the current point, so use a copy per call
+    MeshCore::MeshPointIterator iter(_iter);
+    iter.Set(index);
+    return *iter;
 }
 
 // ----------------------------------------------------------------
@@ -195,13 +209,44 @@ namespace Inspection {
                     for (ulY = ulY1; ulY <= ulY2; ulY++) {
                         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
                             if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                                InsertElement(ulX, ulY, ulZ, ulFacetIndex);
                         }
                     }
                 }
             }
             else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+                InsertElement(ulX1, ulY1, ulZ1, ulFacetIndex);
+        }
+
+        void FindGrids (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const
+        {
+            MeshCore::MeshGeomFacet clFacet = _pclMesh->GetFacet(ulIndex);
+            for (int i=0; i<3; i++)
+                clFacet._aclPoints[i] = _transform * clFacet._aclPoints[i];
+
+            unsigned long ulX, ulY, ulZ;
+            unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
+
+            Base::BoundBox3f clBB;
+            clBB &= clFacet._aclPoints[0];
+            clBB &= clFacet._aclPoints[1];
+            clBB &= clFacet._aclPoints[2];
+
+            Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
+            Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
+
+            if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2)) {
+                for (ulX = ulX1; ulX <= ulX2; ulX++) {
+                    for (ulY = ulY1; ulY <= ulY2; ulY++) {
+                        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
+                            if (clFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
+                                raulGrids.push_back(GetIndexToPosition(ulX, ulY, ulZ));
+                        }
+                    }
+                }
+            }
+            else
+                raulGrids.push_back(GetIndexToPosition(ulX1, ulY1, ulZ1));
         }
 
         void InitGrid (void)
@@ -224,6 +269,13 @@ namespace Inspection {
             _fMinZ = clBBMesh.MinZ - 0.5f;
 
             _aulGrid.clear();
+            _aulOffsets.clear();
+            _aulElements.clear();
+            if (_bCompact) {
+                _aulOffsets.resize(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+                return;
+            }
+
             _aulGrid.resize(_ulCtGridsX);
             for (i = 0; i < _ulCtGridsX; i++) {
                 _aulGrid[i].resize(_ulCtGridsY);
@@ -236,6 +288,10 @@ namespace Inspection {
         {
             _ulCtElements = _pclMesh->CountFacets();
             InitGrid();
+            if (_bCompact) {
+                RebuildCompact();
+                return;
+            }
  
             unsigned long i = 0;
             MeshCore::MeshFacetIterator clFIter(*_pclMesh);
@@ -295,12 +351,13 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point)
 
     float fMinDist=FLT_MAX;
     bool positive = true;
+    MeshCore::MeshFacetIterator iter(_iter);
     for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
+        iter.Set(*it);
+        float fDist = iter->DistanceToPoint(point);
         if (fabs(fDist) < fabs(fMinDist)) {
             fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
+            positive = point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) > 0;
         }
     }
 
@@ -368,12 +425,13 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point)
 
     float fMinDist=FLT_MAX;
     bool positive = true;
+    MeshCore::MeshFacetIterator iter(_iter);
     for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
+        iter.Set(*it);
+        float fDist = iter->DistanceToPoint(point);
         if (fabs(fDist) < fabs(fMinDist)) {
             fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
+            positive = point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) > 0;
         }
     }
 
@@ -418,28 +476,190 @@ float InspectNominalPoints::getDistance(const Base::Vector3f& point)
 
 // ----------------------------------------------------------------
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius) : _rShape(shape)
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius)
+  : _rShape(shape), _fRadius(radius), _fDeflection(0.0f), _pMesh(0), _pBVH(0)
 {
-    distss = new BRepExtrema_DistShapeShape();
-    distss->LoadS1(_rShape);
-    //distss->SetDeflection(radius);
+    _pFaces = new std::vector<TopoDS_Face>();
+    _pExactShape = new TopoDS_Shape(_rShape);
+
+    Bnd_Box bounds;
+    BRepBndLib::Add(_rShape, bounds);
+    if (bounds.IsVoid())
+        return;
+
+    // use the same accuracy as for the tessellation of an actual shape
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    Standard_Real deflection = ((xMax-xMin) + (yMax-yMin) + (zMax-zMin))/300.0 * deviation;
+    BRepMesh_IncrementalMesh MESH(_rShape, deflection);
+
+    // collect the triangles of all faces and remember the face of each triangle,
+    // everything that has no triangles is checked with the exact evaluators
+    BRep_Builder builder;
+    TopoDS_Compound exact;
+    builder.MakeCompound(exact);
+    bool hasExact = false;
+
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    TopExp_Explorer ex;
+    for (ex.Init(_rShape, TopAbs_FACE); ex.More(); ex.Next()) {
+        const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
+        TopLoc_Location aLoc;
+        Handle(Poly_Triangulation) aPoly = BRep_Tool::Triangulation(aFace,aLoc);
+        if (aPoly.IsNull()) {
+            builder.Add(exact, aFace);
+            hasExact = true;
+            continue;
+        }
+
+        gp_Trsf myTransf = aLoc.Transformation();
+        unsigned long offset = points.size();
+        const TColgp_Array1OfPnt& Nodes = aPoly->Nodes();
+        for (Standard_Integer i=1; i<=aPoly->NbNodes(); i++) {
+            gp_Pnt V = Nodes(i).Transformed(myTransf);
+            points.push_back(MeshCore::MeshPoint(Base::Vector3f((float)V.X(),(float)V.Y(),(float)V.Z())));
+        }
+
+        const Poly_Array1OfTriangle& Triangles = aPoly->Triangles();
+        for (Standard_Integer i=1; i<=aPoly->NbTriangles(); i++) {
+            Standard_Integer N1,N2,N3;
+            Triangles(i).Get(N1,N2,N3);
+            facets.push_back(MeshCore::MeshFacet(offset+N1-1, offset+N2-1, offset+N3-1));
+            _faceOfFacet.push_back(_pFaces->size());
+        }
+
+        _pFaces->push_back(aFace);
+    }
+
+    if (facets.empty())
+        return;
+
+    // edges without a face and vertices without an edge
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndAncestors(_rShape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+    for (int i=1; i<=edgeFaces.Extent(); i++) {
+        if (edgeFaces(i).IsEmpty()) {
+            builder.Add(exact, edgeFaces.FindKey(i));
+            hasExact = true;
+        }
+    }
+    TopTools_IndexedDataMapOfShapeListOfShape vertexEdges;
+    TopExp::MapShapesAndAncestors(_rShape, TopAbs_VERTEX, TopAbs_EDGE, vertexEdges);
+    for (int i=1; i<=vertexEdges.Extent(); i++) {
+        if (vertexEdges(i).IsEmpty()) {
+            builder.Add(exact, vertexEdges.FindKey(i));
+            hasExact = true;
+        }
+    }
+
+    if (hasExact)
+        *_pExactShape = exact;
+    else
+        _pExactShape->Nullify();
+
+    _fDeflection = (float)deflection;
+    _pMesh = new MeshCore::MeshKernel();
+    _pMesh->Adopt(points, facets);
+    _pBVH = new MeshCore::MeshFacetBVH(*_pMesh);
 }
 
 InspectNominalShape::~InspectNominalShape()
 {
-    delete distss;
+    delete _pBVH;
+    delete _pMesh;
+    delete _pFaces;
+    delete _pExactShape;
+    for (std::vector<BRepExtrema_DistShapeShape*>::iterator it = _evaluators.begin(); it != _evaluators.end(); ++it)
+        delete *it;
 }
 
 float InspectNominalShape::getDistance(const Base::Vector3f& point)
 {
+    float fExactDist = FLT_MAX;
+    if (!_pExactShape->IsNull())
+        fExactDist = getShapeDistance(point);
+    if (!_pBVH)
+        return fExactDist;
+
+    // the tessellation deviates from the faces by at most the deflection
+    unsigned long facet;
+    Base::Vector3f res;
+    if (!_pBVH->NearestPointFromPoint(point, facet, res, _fRadius + _fDeflection))
+        return fExactDist;
+    float fMeshDist = Base::Distance(point, res);
+    if (fMeshDist - _fDeflection > _fRadius)
+        return std::min<float>(fMeshDist, fExactDist);
+
+    // the nearest face has a triangle not farther away than this
+    std::vector<unsigned long> facets;
+    _pBVH->FacetsWithinDistance(point, fMeshDist + 2.0f * _fDeflection, facets);
+    std::vector<unsigned long> faces;
+    faces.reserve(facets.size());
+    for (std::vector<unsigned long>::iterator it = facets.begin(); it != facets.end(); ++it)
+        faces.push_back(_faceOfFacet[*it]);
+    std::sort(faces.begin(), faces.end());
+    faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+
     BRepBuilderAPI_MakeVertex mkVert(gp_Pnt(point.x,point.y,point.z));
-    distss->LoadS2(mkVert.Vertex());
     float fMinDist=FLT_MAX;
-    if (distss->Perform() && distss->NbSolution() > 0)
-        fMinDist = (float)distss->Value();
+    for (std::vector<unsigned long>::iterator it = faces.begin(); it != faces.end(); ++it) {
+        BRepExtrema_DistShapeShape distss(mkVert.Vertex(), (*_pFaces)[*it]);
+        if (distss.IsDone() && distss.NbSolution() > 0)
+            fMinDist = std::min<float>(fMinDist, (float)distss.Value());
+    }
+
+    // use the tessellation if the projection failed
+    if (fMinDist == FLT_MAX)
+        fMinDist = fMeshDist;
+    return std::min<float>(fMinDist, fExactDist);
+}
+
+float InspectNominalShape::getShapeDistance(const Base::Vector3f& point)
+{
+    BRepExtrema_DistShapeShape* distss = acquireEvaluator();
+    float fMinDist=FLT_MAX;
+    try {
+        BRepBuilderAPI_MakeVertex mkVert(gp_Pnt(point.x,point.y,point.z));
+        distss->LoadS2(mkVert.Vertex());
+        if (distss->Perform() && distss->NbSolution() > 0)
+            fMinDist = (float)distss->Value();
+    }
+    catch (...) {
+        releaseEvaluator(distss);
+        throw;
+    }
+
+    releaseEvaluator(distss);
     return fMinDist;
 }
 
+BRepExtrema_DistShapeShape* InspectNominalShape::acquireEvaluator()
+{
+    QMutexLocker locker(&_mutex);
+    if (!_evaluators.empty()) {
+        BRepExtrema_DistShapeShape* distss = _evaluators.back();
+        _evaluators.pop_back();
+        return distss;
+    }
+    locker.unlock();
+
+    // at most one evaluator per thread is created
+    BRepExtrema_DistShapeShape* distss = new BRepExtrema_DistShapeShape();
+    distss->LoadS1(*_pExactShape);
+    return distss;
+}
+
+void InspectNominalShape::releaseEvaluator(BRepExtrema_DistShapeShape* distss)
+{
+    QMutexLocker locker(&_mutex);
+    _evaluators.push_back(distss);
+}
+
 // ----------------------------------------------------------------
 
 TYPESYSTEM_SOURCE(Inspection::PropertyDistanceList, App::PropertyLists);
@@ -693,52 +913,28 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             inspectNominal.push_back(nominal);
     }
 
-#if 0 // test with some huge data sets
-    Standard::SetReentrant(Standard_True);
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, _1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-    watcher.setFuture(future);
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
     unsigned long count = actual->countPoints();
     std::stringstream str;
     str << "Inspecting " << this->Label.getValue() << "...";
     Base::SequencerLauncher seq(str.str().c_str(), count);
 
+    // the points are inspected in parallel block by block to show the progress
+    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
     std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        Base::Vector3f pnt = actual->getPoint(index);
-
-        float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
-        }
-
-        if (fMinDist > this->SearchRadius.getValue())
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->SearchRadius.getValue())
-            fMinDist = -FLT_MAX;
-        vals[index] = fMinDist;
-        seq.next();
+    std::vector<unsigned long> index;
+    unsigned long block = std::max<unsigned long>(count / 100, 1000);
+    for (unsigned long first = 0; first < count; first += block) {
+        unsigned long last = std::min<unsigned long>(first + block, count);
+        index.resize(last - first);
+        std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(first));
+        QFuture<float> future = QtConcurrent::mapped
+            (index, boost::bind(&DistanceInspection::mapped, &check, _1));
+        QFutureWatcher<float> watcher;
+        watcher.setFuture(future);
+        watcher.waitForFinished();
+        std::copy(future.begin(), future.end(), vals.begin() + first);
+        seq.setProgress(last);
     }
-#endif
 
     Distances.setValues(vals);
 
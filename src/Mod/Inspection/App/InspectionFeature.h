@@ -24,6 +24,8 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <QMutex>
+
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/DocumentObjectGroup.h>
@@ -32,11 +34,13 @@
 #include <Mod/Points/App/Points.h>
 
 class TopoDS_Shape;
+class TopoDS_Face;
 class BRepExtrema_DistShapeShape;
 
 namespace MeshCore {
 class MeshKernel;
 class MeshGrid;
+class MeshFacetBVH;
 }
 
 namespace Mesh   { class MeshObject; }
@@ -46,7 +50,9 @@ namespace Part   { class TopoShape;  }
 namespace Inspection
 {
 
-/** Delivers the number of points to be checked and returns the appropriate point to an index. */
+/** Delivers the number of points to be checked and returns the appropriate point to an index.
+ * getPoint() is called from several threads at once.
+ */
 class InspectionExport InspectActualGeometry
 {
 public:
@@ -93,7 +99,9 @@ private:
     std::vector<Base::Vector3d> points;
 };
 
-/** Calculates the shortest distance of the underlying geometry to a given point. */
+/** Calculates the shortest distance of the underlying geometry to a given point.
+ * getDistance() is called from several threads at once.
+ */
 class InspectionExport InspectNominalGeometry
 {
 public:
@@ -141,6 +149,11 @@ private:
     Points::PointsGrid* _pGrid;
 };
 
+/** The shape is tessellated once and the faces near to a point are searched with a
+ * bounding volume hierarchy of the triangles. The exact distance is only computed
+ * to these faces. Shapes without faces are handled by a pool of evaluators for the
+ * whole shape, where each evaluator is used by one thread at a time.
+ */
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
 {
 public:
@@ -149,8 +162,23 @@ public:
     virtual float getDistance(const Base::Vector3f&);
 
 private:
-    BRepExtrema_DistShapeShape* distss;
+    float getShapeDistance(const Base::Vector3f&);
+    BRepExtrema_DistShapeShape* acquireEvaluator();
+    void releaseEvaluator(BRepExtrema_DistShapeShape*);
+
+private:
     const TopoDS_Shape& _rShape;
+    // The shape checked with the exact evaluators, i.e. the whole shape if nothing is
+    // tessellated or otherwise the untriangulated faces, free edges and free vertices
+    TopoDS_Shape* _pExactShape;
+    float _fRadius;
+    float _fDeflection;
+    MeshCore::MeshKernel* _pMesh;
+    MeshCore::MeshFacetBVH* _pBVH;
+    std::vector<TopoDS_Face>* _pFaces;
+    std::vector<unsigned long> _faceOfFacet;
+    std::vector<BRepExtrema_DistShapeShape*> _evaluators;
+    QMutex _mutex;
 };
 
 class InspectionExport PropertyDistanceList: public App::PropertyLists
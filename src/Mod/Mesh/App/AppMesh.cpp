@@ -28,6 +28,8 @@
 
 #include <Base/Console.h>
 #include <Base/Interpreter.h>
+#include <Base/Parameter.h>
+#include <App/Application.h>
 
 #include "Mesh.h"
 #include "MeshPy.h"
@@ -43,10 +45,35 @@
 #include "FeatureMeshSetOperations.h"
 #include "FeatureMeshDefects.h"
 #include "FeatureMeshSolid.h"
+#include "Core/Grid.h"
 
 /* registration table  */
 extern struct PyMethodDef Mesh_Import_methods[];
 
+namespace {
+// Applies the preference CompactGrid to the grids created afterwards.
+// It lives as long as the parameter group and is therefore never deleted.
+class GridLayoutObserver : public ParameterGrp::ObserverType
+{
+public:
+    GridLayoutObserver()
+    {
+        hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Mesh");
+        hGrp->Attach(this);
+        MeshCore::MeshGrid::SetDefaultCompactLayout(hGrp->GetBool("CompactGrid", true));
+    }
+    void OnChange(Base::Subject<const char*> &rCaller, const char * sReason)
+    {
+        if (sReason && strcmp(sReason, "CompactGrid") == 0)
+            MeshCore::MeshGrid::SetDefaultCompactLayout(hGrp->GetBool("CompactGrid", true));
+    }
+
+private:
+    ParameterGrp::handle hGrp;
+};
+}
+
 
 PyDoc_STRVAR(module_doc,
 "The functions in this module allow working with mesh objects.\n"
@@ -65,6 +92,8 @@ void MeshExport initMesh()
     PyObject* meshModule = Py_InitModule3("Mesh", Mesh_Import_methods, module_doc);   /* mod name, table ptr */
     Base::Console().Log("Loading Mesh module... done\n");
 
+    new GridLayoutObserver();
+
     // NOTE: To finish the initialization of our own type objects we must
     // call PyType_Ready, otherwise we run into a segmentation fault, later on.
     // This function is responsible for adding inherited slots from a type's base class.
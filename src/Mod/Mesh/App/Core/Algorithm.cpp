@@ -27,8 +27,13 @@
 # include <algorithm>
 #endif
 
+#include <boost/bind.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include "Algorithm.h"
 #include "Approximation.h"
+#include "BVH.h"
 #include "Elements.h"
 #include "Iterator.h"
 #include "Grid.h"
@@ -175,6 +180,12 @@ bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::
     return bSol;
 }
 
+bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetBVH &rclBVH,
+                                       Base::Vector3f &rclRes, unsigned long &rulFacet) const
+{
+    return rclBVH.NearestFacetOnRay(rclPt, rclDir, rclRes, rulFacet);
+}
+
 bool MeshAlgorithm::RayNearestField (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const std::vector<unsigned long> &raulFacets,
                                      Base::Vector3f &rclRes, unsigned long &rulFacet, float fMaxAngle) const
 {
@@ -1401,6 +1412,12 @@ bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const Me
   return true;
 }
 
+bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetBVH& rclBVH,
+                                           unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const
+{
+  return rclBVH.NearestPointFromPoint(rclPt, rclResFacetIndex, rclResPoint);
+}
+
 bool MeshAlgorithm::CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                                   std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const
 {
@@ -1903,6 +1920,305 @@ void MeshRefPointToPoints::RemoveNeighbour(unsigned long pos, unsigned long face
 
 //----------------------------------------------------------------------------
 
+unsigned long MeshIndexTable::GetMemoryUsage (void) const
+{
+    return (_aulOffsets.capacity() + _aulIndices.capacity()) * sizeof(unsigned long);
+}
+
+void MeshIndexTable::Build (unsigned long ulCount, const IndexSource& rclSource)
+{
+    _aulOffsets.clear();
+    _aulOffsets.resize(ulCount + 1, 0);
+    _aulIndices.clear();
+    _aulSizes.resize(ulCount);
+
+    // the elements are processed in parallel on chunks of consecutive elements
+    std::vector<Chunk> aclChunks;
+    unsigned long ulChunkSize = std::max<unsigned long>(4096,
+        ulCount / (4 * std::max<unsigned long>(QThread::idealThreadCount(), 1)) + 1);
+    for (unsigned long i = 0; i < ulCount; i += ulChunkSize) {
+        Chunk clChunk;
+        clChunk.ulBegin = i;
+        clChunk.ulEnd = std::min<unsigned long>(i + ulChunkSize, ulCount);
+        aclChunks.push_back(clChunk);
+    }
+
+    // counting pass
+    if (aclChunks.size() > 1)
+        QtConcurrent::blockingMap(aclChunks, boost::bind(&MeshIndexTable::CountChunk, this, boost::cref(rclSource), _1));
+    else if (aclChunks.size() == 1)
+        CountChunk(rclSource, aclChunks.front());
+
+    for (unsigned long i = 0; i < ulCount; i++)
+        _aulOffsets[i + 1] += _aulOffsets[i];
+    _aulIndices.resize(_aulOffsets.back());
+
+    // filling pass
+    if (aclChunks.size() > 1)
+        QtConcurrent::blockingMap(aclChunks, boost::bind(&MeshIndexTable::FillChunk, this, boost::cref(rclSource), _1));
+    else if (aclChunks.size() == 1)
+        FillChunk(rclSource, aclChunks.front());
+
+    // close the gaps of the removed duplicates, the elements only move to the front
+    unsigned long ulPos = 0;
+    for (unsigned long i = 0; i < ulCount; i++) {
+        unsigned long ulOld = _aulOffsets[i];
+        _aulOffsets[i] = ulPos;
+        if (ulOld != ulPos)
+            std::copy(_aulIndices.begin() + ulOld, _aulIndices.begin() + ulOld + _aulSizes[i], _aulIndices.begin() + ulPos);
+        ulPos += _aulSizes[i];
+    }
+    _aulOffsets[ulCount] = ulPos;
+    _aulIndices.resize(ulPos);
+    std::vector<unsigned long>(_aulIndices).swap(_aulIndices);
+    std::vector<unsigned long>().swap(_aulSizes);
+}
+
+void MeshIndexTable::CountChunk (const IndexSource& rclSource, Chunk& rclChunk)
+{
+    for (unsigned long i = rclChunk.ulBegin; i < rclChunk.ulEnd; i++)
+        _aulOffsets[i + 1] = rclSource.CountIndices(i);
+}
+
+void MeshIndexTable::FillChunk (const IndexSource& rclSource, Chunk& rclChunk)
+{
+    unsigned long* base = _aulIndices.empty() ? 0 : &_aulIndices[0];
+    for (unsigned long i = rclChunk.ulBegin; i < rclChunk.ulEnd; i++) {
+        unsigned long* first = base + _aulOffsets[i];
+        unsigned long* last = rclSource.FillIndices(i, first);
+        std::sort(first, last);
+        _aulSizes[i] = std::unique(first, last) - first;
+    }
+}
+
+//----------------------------------------------------------------------------
+
+void MeshCompactPointToFacets::Rebuild (void)
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+
+    // a single pass over the facets is cheaper than a parallel build, the facets of
+    // each point are sorted because the facets are added in order
+    _aulOffsets.clear();
+    _aulOffsets.resize(rPoints.size() + 1, 0);
+    MeshFacetArray::_TConstIterator pFIter;
+    for (pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
+        const unsigned long* p = pFIter->_aulPoints;
+        _aulOffsets[p[0] + 1]++;
+        if (p[1] != p[0])
+            _aulOffsets[p[1] + 1]++;
+        if (p[2] != p[0] && p[2] != p[1])
+            _aulOffsets[p[2] + 1]++;
+    }
+    for (std::size_t i = 0; i < rPoints.size(); i++)
+        _aulOffsets[i + 1] += _aulOffsets[i];
+
+    _aulIndices.clear();
+    _aulIndices.resize(_aulOffsets.back());
+    std::vector<unsigned long> aulFill(_aulOffsets.begin(), _aulOffsets.end() - 1);
+    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
+    for (pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
+        const unsigned long* p = pFIter->_aulPoints;
+        unsigned long ulFacet = pFIter - pFBegin;
+        _aulIndices[aulFill[p[0]]++] = ulFacet;
+        if (p[1] != p[0])
+            _aulIndices[aulFill[p[1]]++] = ulFacet;
+        if (p[2] != p[0] && p[2] != p[1])
+            _aulIndices[aulFill[p[2]]++] = ulFacet;
+    }
+}
+
+Base::Vector3f MeshCompactPointToFacets::GetNormal(unsigned long pos) const
+{
+    MeshIndexRange n = (*this)[pos];
+    Base::Vector3f normal;
+    MeshGeomFacet f;
+    for (MeshIndexRange::const_iterator it = n.begin(); it != n.end(); ++it) {
+        f = _rclMesh.GetFacet(*it);
+        normal += f.Area() * f.GetNormal();
+    }
+
+    normal.Normalize();
+    return normal;
+}
+
+std::set<unsigned long> MeshCompactPointToFacets::NeighbourPoints(const std::vector<unsigned long>& pt, int level) const
+{
+    std::set<unsigned long> cp,nb,lp;
+    cp.insert(pt.begin(), pt.end());
+    lp.insert(pt.begin(), pt.end());
+    MeshFacetArray::_TConstIterator f_it = _rclMesh.GetFacets().begin();
+    for (int i=0; i < level; i++) {
+        std::set<unsigned long> cur;
+        for (std::set<unsigned long>::iterator it = lp.begin(); it != lp.end(); ++it) {
+            MeshIndexRange ft = (*this)[*it];
+            for (MeshIndexRange::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
+                for (int j = 0; j < 3; j++) {
+                    unsigned long index = f_it[*jt]._aulPoints[j];
+                    if (cp.find(index) == cp.end() && nb.find(index) == nb.end()) {
+                        nb.insert(index);
+                        cur.insert(index);
+                    }
+                }
+            }
+        }
+
+        lp = cur;
+        if (lp.empty())
+            break;
+    }
+    return nb;
+}
+
+void MeshCompactPointToFacets::Neighbours (unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const
+{
+    std::set<unsigned long> visited;
+    Base::Vector3f  clCenter = _rclMesh.GetFacet(ulFacetInd).GetGravityPoint();
+
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    SearchNeighbours(rFacets, ulFacetInd, clCenter, fMaxDist * fMaxDist, visited, collect);
+}
+
+void MeshCompactPointToFacets::SearchNeighbours(const MeshFacetArray& rFacets, unsigned long index, const Base::Vector3f &rclCenter,
+                                                float fMaxDist2, std::set<unsigned long>& visited, MeshCollector& collect) const
+{
+    if (visited.find(index) != visited.end())
+        return;
+
+    const MeshFacet& face = rFacets[index];
+    if (Base::DistanceP2(rclCenter, _rclMesh.GetFacet(face).GetGravityPoint()) > fMaxDist2)
+        return;
+
+    visited.insert(index);
+    collect.Append(_rclMesh, index);
+    for (int i = 0; i < 3; i++) {
+        MeshIndexRange f = (*this)[face._aulPoints[i]];
+
+        for (MeshIndexRange::const_iterator j = f.begin(); j != f.end(); ++j) {
+            SearchNeighbours(rFacets, *j, rclCenter, fMaxDist2, visited, collect);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+
+namespace MeshCore {
+/* Collects the facets sharing a point with a facet. */
+class FacetToFacetsSource : public MeshIndexTable::IndexSource
+{
+public:
+    FacetToFacetsSource(const MeshFacetArray& rFacets, const MeshCompactPointToFacets& rPF)
+      : _rFacets(rFacets), _rPF(rPF) { }
+    unsigned long CountIndices (unsigned long pos) const
+    {
+        const MeshFacet& rFacet = _rFacets[pos];
+        return _rPF[rFacet._aulPoints[0]].size() + _rPF[rFacet._aulPoints[1]].size() +
+               _rPF[rFacet._aulPoints[2]].size();
+    }
+    unsigned long* FillIndices (unsigned long pos, unsigned long* out) const
+    {
+        const MeshFacet& rFacet = _rFacets[pos];
+        for (int i = 0; i < 3; i++) {
+            MeshIndexRange faces = _rPF[rFacet._aulPoints[i]];
+            out = std::copy(faces.begin(), faces.end(), out);
+        }
+        return out;
+    }
+
+private:
+    const MeshFacetArray& _rFacets;
+    const MeshCompactPointToFacets& _rPF;
+};
+
+/* Collects the points sharing an edge with a point. Like MeshRefPointToPoints the
+ * point itself is added for facets that index it more than once.
+ */
+class PointToPointsSource : public MeshIndexTable::IndexSource
+{
+public:
+    PointToPointsSource(const MeshFacetArray& rFacets, const MeshCompactPointToFacets& rPF)
+      : _rFacets(rFacets), _rPF(rPF) { }
+    unsigned long CountIndices (unsigned long pos) const
+    {
+        unsigned long count = 0;
+        MeshIndexRange faces = _rPF[pos];
+        for (MeshIndexRange::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            for (int i = 0; i < 3; i++) {
+                if (_rFacets[*it]._aulPoints[i] == pos)
+                    count += 2;
+            }
+        }
+        return count;
+    }
+    unsigned long* FillIndices (unsigned long pos, unsigned long* out) const
+    {
+        MeshIndexRange faces = _rPF[pos];
+        for (MeshIndexRange::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            const unsigned long* p = _rFacets[*it]._aulPoints;
+            for (int i = 0; i < 3; i++) {
+                if (p[i] == pos) {
+                    *out++ = p[(i+1)%3];
+                    *out++ = p[(i+2)%3];
+                }
+            }
+        }
+        return out;
+    }
+
+private:
+    const MeshFacetArray& _rFacets;
+    const MeshCompactPointToFacets& _rPF;
+};
+}
+
+void MeshCompactFacetToFacets::Rebuild (void)
+{
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    MeshCompactPointToFacets vertexFace(_rclMesh);
+    Build(rFacets.size(), FacetToFacetsSource(rFacets, vertexFace));
+}
+
+//----------------------------------------------------------------------------
+
+void MeshCompactPointToPoints::Rebuild (void)
+{
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    MeshCompactPointToFacets vertexFace(_rclMesh);
+    Build(_rclMesh.CountPoints(), PointToPointsSource(rFacets, vertexFace));
+}
+
+Base::Vector3f MeshCompactPointToPoints::GetNormal(unsigned long pos) const
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    MeshCore::PlaneFit pf;
+    pf.AddPoint(rPoints[pos]);
+    MeshIndexRange cv = (*this)[pos];
+    for (MeshIndexRange::const_iterator cv_it = cv.begin(); cv_it != cv.end(); ++cv_it) {
+        pf.AddPoint(rPoints[*cv_it]);
+    }
+
+    pf.Fit();
+
+    Base::Vector3f normal = pf.GetNormal();
+    normal.Normalize();
+    return normal;
+}
+
+float MeshCompactPointToPoints::GetAverageEdgeLength(unsigned long index) const
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    float len=0.0f;
+    MeshIndexRange n = (*this)[index];
+    const Base::Vector3f& p = rPoints[index];
+    for (MeshIndexRange::const_iterator it = n.begin(); it != n.end(); ++it) {
+        len += Base::Distance(p, rPoints[*it]);
+    }
+    return (len/n.size());
+}
+
+//----------------------------------------------------------------------------
+
 void MeshRefEdgeToFacets::Rebuild (void)
 {
     _map.clear();
@@ -45,6 +45,7 @@ class MeshGeomFacet;
 class MeshGeomEdge;
 class MeshKernel;
 class MeshFacetGrid;
+class MeshFacetBVH;
 class MeshFacetArray;
 class MeshRefPointToFacets;
 class AbstractPolygonTriangulator;
@@ -92,6 +93,16 @@ public:
    */
   bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const std::vector<unsigned long> &raulFacets,
                           Base::Vector3f &rclRes, unsigned long &rulFacet) const;
+  /**
+   * Searches for the nearest facet to the ray defined by
+   * (\a rclPt, \a rclDir).
+   * The point \a rclRes holds the intersection point with the ray and the
+   * nearest facet with index \a rulFacet.
+   * \note This method uses the bounding volume hierarchy \a rclBVH. Unlike
+   * the grid it also works well for meshes with very uneven facet sizes.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetBVH &rclBVH,
+                          Base::Vector3f &rclRes, unsigned long &rulFacet) const;
   /**
    * Searches for the nearest facet to the ray defined by (\a rclPt, \a  rclDir). The point \a rclRes holds
    * the intersection point with the ray and the nearest facet with index \a rulFacet.
@@ -276,6 +287,8 @@ public:
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetGrid& rclGrid, float fMaxSearchArea,
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
+  bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetBVH& rclBVH,
+                              unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   /** Cuts the mesh with a plane. The result is a list of polylines. */
   bool CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                      std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
@@ -445,6 +458,164 @@ protected:
     std::vector<std::set<unsigned long> > _map;
 };
 
+/**
+ * The MeshIndexRange gives access to the indices of one element of a MeshIndexTable.
+ * It can be iterated like the std::set of the MeshRef* structures and its indices are
+ * sorted as well.
+ */
+class MeshExport MeshIndexRange
+{
+public:
+    typedef const unsigned long* const_iterator;
+
+    MeshIndexRange (const_iterator first, const_iterator last) : _first(first), _last(last)
+    { }
+
+    const_iterator begin (void) const { return _first; }
+    const_iterator end (void) const { return _last; }
+    std::size_t size (void) const { return _last - _first; }
+    bool empty (void) const { return _first == _last; }
+
+private:
+    const_iterator _first, _last;
+};
+
+/**
+ * The MeshIndexTable stores the sorted indices of all elements in compressed sparse row
+ * format, i.e. one array with the offset of each element into a second array that holds
+ * the indices of all elements. Compared to a std::set per element it needs only a
+ * fraction of the memory and allocations.
+ * \note Unlike the MeshRef* structures a table cannot be modified after it is built.
+ */
+class MeshExport MeshIndexTable
+{
+public:
+    /** Computes the indices of single elements to build a table. */
+    class IndexSource
+    {
+    public:
+        virtual ~IndexSource (void) { }
+        /// Returns an upper bound of the number of indices of element \a pos.
+        virtual unsigned long CountIndices (unsigned long pos) const = 0;
+        /// Writes the indices of element \a pos to \a out and returns the end.
+        virtual unsigned long* FillIndices (unsigned long pos, unsigned long* out) const = 0;
+    };
+
+    MeshIndexTable (void) { }
+    virtual ~MeshIndexTable (void) { }
+
+    /// Returns the sorted indices of element \a pos.
+    MeshIndexRange operator[] (unsigned long pos) const
+    {
+        const unsigned long* first = _aulIndices.empty() ? 0 : &_aulIndices[0];
+        return MeshIndexRange(first + _aulOffsets[pos], first + _aulOffsets[pos + 1]);
+    }
+    /// Returns the number of elements.
+    unsigned long Size (void) const
+    { return _aulOffsets.empty() ? 0 : _aulOffsets.size() - 1; }
+    /// Returns the number of bytes used by the table.
+    unsigned long GetMemoryUsage (void) const;
+
+protected:
+    /** Builds the table for \a ulCount elements. The upper bounds of the element sizes
+     * are counted in parallel, then the indices are written, sorted and made unique in
+     * parallel. At last the gaps left by removed duplicates are closed.
+     */
+    void Build (unsigned long ulCount, const IndexSource& rclSource);
+
+private:
+    struct Chunk
+    {
+        unsigned long ulBegin, ulEnd;
+    };
+    void CountChunk (const IndexSource& rclSource, Chunk& rclChunk);
+    void FillChunk (const IndexSource& rclSource, Chunk& rclChunk);
+
+protected:
+    std::vector<unsigned long> _aulOffsets; /**< Offset of each element, plus the end. */
+    std::vector<unsigned long> _aulIndices; /**< Indices of all elements. */
+
+private:
+    std::vector<unsigned long> _aulSizes;
+};
+
+/**
+ * The MeshCompactPointToFacets does the same as MeshRefPointToFacets but stores the
+ * facets of all points in a MeshIndexTable.
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshCompactPointToFacets : public MeshIndexTable
+{
+public:
+    /// Construction
+    MeshCompactPointToFacets (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshCompactPointToFacets (void)
+    { }
+
+    /// Rebuilds up data structure
+    void Rebuild (void);
+    std::set<unsigned long> NeighbourPoints(const std::vector<unsigned long>& , int level) const;
+    void Neighbours (unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const;
+    Base::Vector3f GetNormal(unsigned long) const;
+
+protected:
+    void SearchNeighbours(const MeshFacetArray& rFacets, unsigned long index, const Base::Vector3f &rclCenter, 
+        float fMaxDist, std::set<unsigned long> &visit, MeshCollector& collect) const;
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+};
+
+/**
+ * The MeshCompactFacetToFacets does the same as MeshRefFacetToFacets but stores the
+ * facets sharing a point with a facet in a MeshIndexTable.
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshCompactFacetToFacets : public MeshIndexTable
+{
+public:
+    /// Construction
+    MeshCompactFacetToFacets (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshCompactFacetToFacets (void)
+    { }
+    /// Rebuilds up data structure
+    void Rebuild (void);
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+};
+
+/**
+ * The MeshCompactPointToPoints does the same as MeshRefPointToPoints but stores the
+ * neighbour points of all points in a MeshIndexTable.
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshCompactPointToPoints : public MeshIndexTable
+{
+public:
+    /// Construction
+    MeshCompactPointToPoints (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshCompactPointToPoints (void)
+    { }
+
+    /// Rebuilds up data structure
+    void Rebuild (void);
+    Base::Vector3f GetNormal(unsigned long) const;
+    float GetAverageEdgeLength(unsigned long) const;
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+};
+
 /**
  * The MeshRefEdgeToFacets builds up a structure to have access to all facets 
  * of an edge. On a manifold mesh an edge has one or two facets associated.
@@ -0,0 +1,735 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+#endif
+
+#include <boost/bind.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "BVH.h"
+#include "Elements.h"
+#include "MeshKernel.h"
+
+using namespace MeshCore;
+
+namespace MeshCore {
+
+// the traversal stacks have a fixed size, so the depth of the tree is limited
+static const int BVH_MAX_DEPTH = 56;
+static const int BVH_STACK_SIZE = 64;
+static const unsigned long BVH_LEAF_SIZE = 4;
+static const unsigned long BVH_MAX_LEAF_SIZE = 16;
+static const int BVH_BINS = 16;
+
+static float SurfaceArea(const Base::BoundBox3f& rclBox)
+{
+    if (!rclBox.IsValid())
+        return 0.0f;
+    float dx = rclBox.MaxX - rclBox.MinX;
+    float dy = rclBox.MaxY - rclBox.MinY;
+    float dz = rclBox.MaxZ - rclBox.MinZ;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static float GetCoord(const Base::Vector3f& rclPt, int iAxis)
+{
+    return iAxis == 0 ? rclPt.x : (iAxis == 1 ? rclPt.y : rclPt.z);
+}
+
+static int GetBin(float fCoord, float fMin, float fScale)
+{
+    return std::min<int>(BVH_BINS - 1, int((fCoord - fMin) * fScale));
+}
+
+/* Computes the parameter range of the line P + t * D inside the box. The components of
+ * D that are zero are marked in \a abParallel. Returns false if the line misses the box.
+ */
+static bool LineBoxRange(const float afMin[3], const float afMax[3], const float afPt[3],
+                         const float afInvDir[3], const bool abParallel[3], float& rfMin, float& rfMax)
+{
+    float fMin = -FLOAT_MAX;
+    float fMax =  FLOAT_MAX;
+    for (int i = 0; i < 3; i++) {
+        if (abParallel[i]) {
+            if (afPt[i] < afMin[i] || afPt[i] > afMax[i])
+                return false;
+        }
+        else {
+            float t1 = (afMin[i] - afPt[i]) * afInvDir[i];
+            float t2 = (afMax[i] - afPt[i]) * afInvDir[i];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            fMin = std::max<float>(fMin, t1);
+            fMax = std::min<float>(fMax, t2);
+            if (fMin > fMax)
+                return false;
+        }
+    }
+
+    rfMin = fMin;
+    rfMax = fMax;
+    return true;
+}
+
+/* Returns the smallest distance of the parameter range [fMin, fMax] to zero. */
+static float RangeDistance(float fMin, float fMax)
+{
+    if (fMin > 0.0f)
+        return fMin;
+    if (fMax < 0.0f)
+        return -fMax;
+    return 0.0f;
+}
+
+static float BoxDistance2(const float afMin[3], const float afMax[3], const Base::Vector3f& rclPt)
+{
+    float afPt[3] = {rclPt.x, rclPt.y, rclPt.z};
+    float fDist2 = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = std::max<float>(std::max<float>(afMin[i] - afPt[i], afPt[i] - afMax[i]), 0.0f);
+        fDist2 += d * d;
+    }
+    return fDist2;
+}
+
+/* Squared distance of P to the triangle (A, B, C), see Ericson, Real-Time Collision Detection. */
+static float TriangleDistance2(const Base::Vector3f& p, const Base::Vector3f& a,
+                               const Base::Vector3f& b, const Base::Vector3f& c)
+{
+    Base::Vector3f ab = b - a;
+    Base::Vector3f ac = c - a;
+    Base::Vector3f ap = p - a;
+    float d1 = ab * ap;
+    float d2 = ac * ap;
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return ap.Sqr();
+
+    Base::Vector3f bp = p - b;
+    float d3 = ab * bp;
+    float d4 = ac * bp;
+    if (d3 >= 0.0f && d4 <= d3)
+        return bp.Sqr();
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        return (ap - v * ab).Sqr();
+    }
+
+    Base::Vector3f cp = p - c;
+    float d5 = ab * cp;
+    float d6 = ac * cp;
+    if (d6 >= 0.0f && d5 <= d6)
+        return cp.Sqr();
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        return (ap - w * ac).Sqr();
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return (bp - w * (c - b)).Sqr();
+    }
+
+    // the projection lies inside the triangle, degenerated triangles never get here
+    float denom = 1.0f / (va + vb + vc);
+    float v = vb * denom;
+    float w = vc * denom;
+    return (ap - v * ab - w * ac).Sqr();
+}
+
+} // namespace MeshCore
+
+MeshFacetBVH::MeshFacetBVH(const MeshKernel& rclM)
+  : _rclMesh(rclM)
+{
+    Rebuild();
+}
+
+MeshFacetBVH::~MeshFacetBVH()
+{
+}
+
+void MeshFacetBVH::Rebuild()
+{
+    _aclNodes.clear();
+    _aclPackets.clear();
+
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    unsigned long ulCtFacets = rFacets.size();
+    if (ulCtFacets == 0)
+        return;
+
+    std::vector<BuildItem> aclItems(ulCtFacets);
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        BuildItem& item = aclItems[i];
+        for (int j = 0; j < 3; j++)
+            item.clBox.Add(rPoints[rFacets[i]._aulPoints[j]]);
+        item.clCenter = item.clBox.CalcCenter();
+        item.ulFacet = i;
+    }
+
+    // enlarge the boxes a bit so that rays through edges are not missed due to rounding
+    Base::BoundBox3f clBox = _rclMesh.GetBoundBox();
+    float fEps = 1.0e-5f * std::max<float>(clBox.CalcDiagonalLength(), 1.0f);
+    for (std::vector<BuildItem>::iterator it = aclItems.begin(); it != aclItems.end(); ++it)
+        it->clBox.Enlarge(fEps);
+
+    _aclNodes.reserve(2 * ((ulCtFacets + BVH_LEAF_SIZE - 1) / BVH_LEAF_SIZE));
+    _aclNodes.resize(1);
+    BuildNode(aclItems, 0, 0, ulCtFacets, 0);
+}
+
+void MeshFacetBVH::BuildNode(std::vector<BuildItem>& raclItems, unsigned long ulNode,
+                             unsigned long ulBegin, unsigned long ulEnd, int iDepth)
+{
+    Base::BoundBox3f clBox, clCenters;
+    for (unsigned long i = ulBegin; i < ulEnd; i++) {
+        clBox.Add(raclItems[i].clBox);
+        clCenters.Add(raclItems[i].clCenter);
+    }
+
+    Node& rclNode = _aclNodes[ulNode];
+    rclNode.afMin[0] = clBox.MinX; rclNode.afMin[1] = clBox.MinY; rclNode.afMin[2] = clBox.MinZ;
+    rclNode.afMax[0] = clBox.MaxX; rclNode.afMax[1] = clBox.MaxY; rclNode.afMax[2] = clBox.MaxZ;
+
+    unsigned long ulCount = ulEnd - ulBegin;
+    if (ulCount <= BVH_LEAF_SIZE || iDepth >= BVH_MAX_DEPTH) {
+        BuildLeaf(raclItems, ulNode, ulBegin, ulEnd);
+        return;
+    }
+
+    // split along the longest extent of the facet centers
+    float afExt[3] = {clCenters.MaxX - clCenters.MinX,
+                      clCenters.MaxY - clCenters.MinY,
+                      clCenters.MaxZ - clCenters.MinZ};
+    int iAxis = 0;
+    if (afExt[1] > afExt[iAxis]) iAxis = 1;
+    if (afExt[2] > afExt[iAxis]) iAxis = 2;
+    float fMin = iAxis == 0 ? clCenters.MinX : (iAxis == 1 ? clCenters.MinY : clCenters.MinZ);
+
+    unsigned long ulMid = ulBegin;
+    if (afExt[iAxis] > 0.0f) {
+        // binned surface area heuristic
+        unsigned long aulBinCount[BVH_BINS];
+        Base::BoundBox3f aclBinBox[BVH_BINS];
+        std::fill(aulBinCount, aulBinCount + BVH_BINS, 0);
+        float fScale = float(BVH_BINS) / afExt[iAxis];
+        for (unsigned long i = ulBegin; i < ulEnd; i++) {
+            int iBin = GetBin(GetCoord(raclItems[i].clCenter, iAxis), fMin, fScale);
+            aulBinCount[iBin]++;
+            aclBinBox[iBin].Add(raclItems[i].clBox);
+        }
+
+        float afRightArea[BVH_BINS];
+        unsigned long aulRightCount[BVH_BINS];
+        Base::BoundBox3f clRight;
+        unsigned long ulRight = 0;
+        for (int i = BVH_BINS - 1; i > 0; i--) {
+            clRight.Add(aclBinBox[i]);
+            ulRight += aulBinCount[i];
+            afRightArea[i] = SurfaceArea(clRight);
+            aulRightCount[i] = ulRight;
+        }
+
+        Base::BoundBox3f clLeft;
+        unsigned long ulLeft = 0;
+        float fBestCost = FLOAT_MAX;
+        int iBestBin = -1;
+        for (int i = 0; i < BVH_BINS - 1; i++) {
+            clLeft.Add(aclBinBox[i]);
+            ulLeft += aulBinCount[i];
+            if (ulLeft == 0 || aulRightCount[i + 1] == 0)
+                continue;
+            float fCost = SurfaceArea(clLeft) * ulLeft + afRightArea[i + 1] * aulRightCount[i + 1];
+            if (fCost < fBestCost) {
+                fBestCost = fCost;
+                iBestBin = i;
+            }
+        }
+
+        // a leaf is cheaper if testing all facets costs less than one traversal step plus the children
+        float fArea = SurfaceArea(clBox);
+        if (ulCount <= BVH_MAX_LEAF_SIZE && fArea > 0.0f && 1.0f + fBestCost / fArea >= float(ulCount)) {
+            BuildLeaf(raclItems, ulNode, ulBegin, ulEnd);
+            return;
+        }
+
+        if (iBestBin >= 0) {
+            unsigned long i = ulBegin, j = ulEnd;
+            while (i < j) {
+                if (GetBin(GetCoord(raclItems[i].clCenter, iAxis), fMin, fScale) <= iBestBin)
+                    i++;
+                else
+                    std::swap(raclItems[i], raclItems[--j]);
+            }
+            ulMid = i;
+        }
+    }
+
+    // all centers on one spot or no useful split found, split in the middle
+    if (ulMid == ulBegin || ulMid == ulEnd) {
+        if (ulCount <= BVH_MAX_LEAF_SIZE) {
+            BuildLeaf(raclItems, ulNode, ulBegin, ulEnd);
+            return;
+        }
+        ulMid = ulBegin + ulCount / 2;
+    }
+
+    unsigned long ulLeftChild = _aclNodes.size();
+    _aclNodes.resize(ulLeftChild + 2);
+    _aclNodes[ulNode].ulFirst = ulLeftChild;
+    _aclNodes[ulNode].ulCount = 0;
+    BuildNode(raclItems, ulLeftChild, ulBegin, ulMid, iDepth + 1);
+    BuildNode(raclItems, ulLeftChild + 1, ulMid, ulEnd, iDepth + 1);
+}
+
+void MeshFacetBVH::BuildLeaf(const std::vector<BuildItem>& raclItems, unsigned long ulNode,
+                             unsigned long ulBegin, unsigned long ulEnd)
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+
+    _aclNodes[ulNode].ulFirst = _aclPackets.size();
+    _aclNodes[ulNode].ulCount = (ulEnd - ulBegin + 3) / 4;
+
+    for (unsigned long i = ulBegin; i < ulEnd; i += 4) {
+        TrianglePacket clPacket;
+        for (unsigned long k = 0; k < 4; k++) {
+            bool bUsed = i + k < ulEnd;
+            const MeshFacet& rFacet = rFacets[raclItems[bUsed ? i + k : i].ulFacet];
+            const Base::Vector3f& p0 = rPoints[rFacet._aulPoints[0]];
+            const Base::Vector3f& p1 = rPoints[rFacet._aulPoints[1]];
+            const Base::Vector3f& p2 = rPoints[rFacet._aulPoints[2]];
+            clPacket.x0[k] = p0.x; clPacket.y0[k] = p0.y; clPacket.z0[k] = p0.z;
+            clPacket.x1[k] = p1.x; clPacket.y1[k] = p1.y; clPacket.z1[k] = p1.z;
+            clPacket.x2[k] = p2.x; clPacket.y2[k] = p2.y; clPacket.z2[k] = p2.z;
+            clPacket.index[k] = bUsed ? raclItems[i + k].ulFacet : ULONG_MAX;
+        }
+        _aclPackets.push_back(clPacket);
+    }
+}
+
+Base::BoundBox3f MeshFacetBVH::GetBoundBox() const
+{
+    if (_aclNodes.empty())
+        return Base::BoundBox3f();
+    const Node& rclRoot = _aclNodes.front();
+    return Base::BoundBox3f(rclRoot.afMin[0], rclRoot.afMin[1], rclRoot.afMin[2],
+                            rclRoot.afMax[0], rclRoot.afMax[1], rclRoot.afMax[2]);
+}
+
+unsigned long MeshFacetBVH::GetMemoryUsage() const
+{
+    return _aclNodes.capacity() * sizeof(Node) + _aclPackets.capacity() * sizeof(TrianglePacket);
+}
+
+bool MeshFacetBVH::RayPacket(const TrianglePacket& rclPacket, const Base::Vector3f& rclPt,
+                             const Base::Vector3f& rclDir, float fCosAngle, float& rfParam,
+                             unsigned long& rulFacet) const
+{
+    // same computation as MeshGeomFacet::Foraminate() for four facets at once,
+    // the normals needn't be normalized because all tests are scale invariant
+    const float eps = 1e-06f;
+    float dd = rclDir * rclDir;
+    float afParam[4];
+    int aiHit[4];
+
+    for (int k = 0; k < 4; k++) {
+        float ux = rclPacket.x1[k] - rclPacket.x0[k];
+        float uy = rclPacket.y1[k] - rclPacket.y0[k];
+        float uz = rclPacket.z1[k] - rclPacket.z0[k];
+        float vx = rclPacket.x2[k] - rclPacket.x0[k];
+        float vy = rclPacket.y2[k] - rclPacket.y0[k];
+        float vz = rclPacket.z2[k] - rclPacket.z0[k];
+        float nx = uy * vz - uz * vy;
+        float ny = uz * vx - ux * vz;
+        float nz = ux * vy - uy * vx;
+
+        float nn = nx * nx + ny * ny + nz * nz;
+        float nd = nx * rclDir.x + ny * rclDir.y + nz * rclDir.z;
+
+        float w0x = rclPt.x - rclPacket.x0[k];
+        float w0y = rclPt.y - rclPacket.y0[k];
+        float w0z = rclPt.z - rclPacket.z0[k];
+        float r = -(nx * w0x + ny * w0y + nz * w0z) / nd;
+        float wx = w0x + r * rclDir.x;
+        float wy = w0y + r * rclDir.y;
+        float wz = w0z + r * rclDir.z;
+
+        float uu = ux * ux + uy * uy + uz * uz;
+        float uv = ux * vx + uy * vy + uz * vz;
+        float vv = vx * vx + vy * vy + vz * vz;
+        float wu = wx * ux + wy * uy + wz * uz;
+        float wv = wx * vx + wy * vy + wz * vz;
+        float det = std::fabs((uu * vv) - (uv * uv));
+        float s = (vv * wu) - (uv * wv);
+        float t = (uu * wv) - (uv * wu);
+
+        aiHit[k] = ((nd * nd) > (eps * dd * nn)) & (nd >= fCosAngle * std::sqrt(nn * dd)) &
+                   (s >= 0.0f) & (t >= 0.0f) & ((s + t) <= det);
+        afParam[k] = r;
+    }
+
+    bool bFound = false;
+    for (int k = 0; k < 4; k++) {
+        if (aiHit[k] && std::fabs(afParam[k]) < std::fabs(rfParam)) {
+            rfParam = afParam[k];
+            rulFacet = rclPacket.index[k];
+            bFound = true;
+        }
+    }
+
+    return bFound;
+}
+
+void MeshFacetBVH::PointPacket(const TrianglePacket& rclPacket, const Base::Vector3f& rclPt,
+                               float& rfDist2, unsigned long& rulFacet) const
+{
+    for (int k = 0; k < 4; k++) {
+        float fDist2 = TriangleDistance2(rclPt,
+            Base::Vector3f(rclPacket.x0[k], rclPacket.y0[k], rclPacket.z0[k]),
+            Base::Vector3f(rclPacket.x1[k], rclPacket.y1[k], rclPacket.z1[k]),
+            Base::Vector3f(rclPacket.x2[k], rclPacket.y2[k], rclPacket.z2[k]));
+        if (fDist2 < rfDist2) {
+            rfDist2 = fDist2;
+            rulFacet = rclPacket.index[k];
+        }
+    }
+}
+
+bool MeshFacetBVH::NearestFacetOnRay(const Base::Vector3f& rclPt, const Base::Vector3f& rclDir,
+                                     Base::Vector3f& rclRes, unsigned long& rulFacet,
+                                     float fMaxAngle) const
+{
+    if (_aclNodes.empty())
+        return false;
+
+    float afPt[3] = {rclPt.x, rclPt.y, rclPt.z};
+    float afDir[3] = {rclDir.x, rclDir.y, rclDir.z};
+    float afInvDir[3];
+    bool abParallel[3];
+    for (int i = 0; i < 3; i++) {
+        abParallel[i] = (afDir[i] == 0.0f);
+        afInvDir[i] = abParallel[i] ? 0.0f : 1.0f / afDir[i];
+    }
+    if (abParallel[0] && abParallel[1] && abParallel[2])
+        return false;
+
+    float fCosAngle = fMaxAngle < F_PI ? float(cos(fMaxAngle)) : -2.0f;
+
+    unsigned long aulStack[BVH_STACK_SIZE];
+    float afStack[BVH_STACK_SIZE];
+    int iTop = 0;
+
+    float fMin, fMax;
+    if (!LineBoxRange(_aclNodes[0].afMin, _aclNodes[0].afMax, afPt, afInvDir, abParallel, fMin, fMax))
+        return false;
+    aulStack[iTop] = 0;
+    afStack[iTop++] = RangeDistance(fMin, fMax);
+
+    float fParam = FLOAT_MAX;
+    unsigned long ulFacet = ULONG_MAX;
+    while (iTop > 0) {
+        --iTop;
+        if (afStack[iTop] > std::fabs(fParam))
+            continue;
+
+        const Node& rclNode = _aclNodes[aulStack[iTop]];
+        if (rclNode.ulCount > 0) {
+            for (unsigned long i = 0; i < rclNode.ulCount; i++)
+                RayPacket(_aclPackets[rclNode.ulFirst + i], rclPt, rclDir, fCosAngle, fParam, ulFacet);
+            continue;
+        }
+
+        // push the farther child first so that the nearer one is visited first
+        float afDist[2];
+        bool abHit[2];
+        for (int i = 0; i < 2; i++) {
+            const Node& rclChild = _aclNodes[rclNode.ulFirst + i];
+            abHit[i] = LineBoxRange(rclChild.afMin, rclChild.afMax, afPt, afInvDir, abParallel, fMin, fMax);
+            afDist[i] = abHit[i] ? RangeDistance(fMin, fMax) : FLOAT_MAX;
+            abHit[i] = abHit[i] && afDist[i] <= std::fabs(fParam);
+        }
+
+        int iNear = afDist[1] < afDist[0] ? 1 : 0;
+        int iFar = 1 - iNear;
+        if (abHit[iFar]) {
+            aulStack[iTop] = rclNode.ulFirst + iFar;
+            afStack[iTop++] = afDist[iFar];
+        }
+        if (abHit[iNear]) {
+            aulStack[iTop] = rclNode.ulFirst + iNear;
+            afStack[iTop++] = afDist[iNear];
+        }
+    }
+
+    if (ulFacet == ULONG_MAX)
+        return false;
+
+    rclRes = rclPt + fParam * rclDir;
+    rulFacet = ulFacet;
+    return true;
+}
+
+bool MeshFacetBVH::NearestPointFromPoint(const Base::Vector3f& rclPt, unsigned long& rulFacet,
+                                         Base::Vector3f& rclRes, float fMaxDistance) const
+{
+    if (_aclNodes.empty())
+        return false;
+
+    unsigned long aulStack[BVH_STACK_SIZE];
+    float afStack[BVH_STACK_SIZE];
+    int iTop = 0;
+
+    float fDist2 = fMaxDistance < FLOAT_MAX ? fMaxDistance * fMaxDistance : FLOAT_MAX;
+    float fBox2 = BoxDistance2(_aclNodes[0].afMin, _aclNodes[0].afMax, rclPt);
+    if (fBox2 > fDist2)
+        return false;
+    aulStack[iTop] = 0;
+    afStack[iTop++] = fBox2;
+
+    unsigned long ulFacet = ULONG_MAX;
+    while (iTop > 0) {
+        --iTop;
+        if (afStack[iTop] >= fDist2)
+            continue;
+
+        const Node& rclNode = _aclNodes[aulStack[iTop]];
+        if (rclNode.ulCount > 0) {
+            for (unsigned long i = 0; i < rclNode.ulCount; i++)
+                PointPacket(_aclPackets[rclNode.ulFirst + i], rclPt, fDist2, ulFacet);
+            continue;
+        }
+
+        const Node& rclLeft = _aclNodes[rclNode.ulFirst];
+        const Node& rclRight = _aclNodes[rclNode.ulFirst + 1];
+        float afDist[2] = {BoxDistance2(rclLeft.afMin, rclLeft.afMax, rclPt),
+                           BoxDistance2(rclRight.afMin, rclRight.afMax, rclPt)};
+        int iNear = afDist[1] < afDist[0] ? 1 : 0;
+        int iFar = 1 - iNear;
+        if (afDist[iFar] < fDist2) {
+            aulStack[iTop] = rclNode.ulFirst + iFar;
+            afStack[iTop++] = afDist[iFar];
+        }
+        if (afDist[iNear] < fDist2) {
+            aulStack[iTop] = rclNode.ulFirst + iNear;
+            afStack[iTop++] = afDist[iNear];
+        }
+    }
+
+    if (ulFacet == ULONG_MAX)
+        return false;
+
+    _rclMesh.GetFacet(ulFacet).DistanceToPoint(rclPt, rclRes);
+    rulFacet = ulFacet;
+    return true;
+}
+
+void MeshFacetBVH::FacetsWithinDistance(const Base::Vector3f& rclPt, float fMaxDistance,
+                                        std::vector<unsigned long>& raulFacets) const
+{
+    if (_aclNodes.empty())
+        return;
+
+    unsigned long aulStack[BVH_STACK_SIZE];
+    int iTop = 0;
+
+    float fDist2 = fMaxDistance * fMaxDistance;
+    if (BoxDistance2(_aclNodes[0].afMin, _aclNodes[0].afMax, rclPt) > fDist2)
+        return;
+    aulStack[iTop++] = 0;
+
+    while (iTop > 0) {
+        const Node& rclNode = _aclNodes[aulStack[--iTop]];
+        if (rclNode.ulCount > 0) {
+            for (unsigned long i = 0; i < rclNode.ulCount; i++) {
+                const TrianglePacket& rclPacket = _aclPackets[rclNode.ulFirst + i];
+                for (int k = 0; k < 4; k++) {
+                    if (rclPacket.index[k] == ULONG_MAX)
+                        continue;
+                    float fTria2 = TriangleDistance2(rclPt,
+                        Base::Vector3f(rclPacket.x0[k], rclPacket.y0[k], rclPacket.z0[k]),
+                        Base::Vector3f(rclPacket.x1[k], rclPacket.y1[k], rclPacket.z1[k]),
+                        Base::Vector3f(rclPacket.x2[k], rclPacket.y2[k], rclPacket.z2[k]));
+                    if (fTria2 <= fDist2)
+                        raulFacets.push_back(rclPacket.index[k]);
+                }
+            }
+            continue;
+        }
+
+        for (unsigned long i = 0; i < 2; i++) {
+            const Node& rclChild = _aclNodes[rclNode.ulFirst + i];
+            if (BoxDistance2(rclChild.afMin, rclChild.afMax, rclPt) <= fDist2)
+                aulStack[iTop++] = rclNode.ulFirst + i;
+        }
+    }
+}
+
+void MeshFacetBVH::FacetsInBox(const Base::BoundBox3f& rclBox, std::vector<unsigned long>& raulFacets) const
+{
+    if (_aclNodes.empty())
+        return;
+
+    float afMin[3] = {rclBox.MinX, rclBox.MinY, rclBox.MinZ};
+    float afMax[3] = {rclBox.MaxX, rclBox.MaxY, rclBox.MaxZ};
+
+    unsigned long aulStack[BVH_STACK_SIZE];
+    int iTop = 0;
+    aulStack[iTop++] = 0;
+
+    while (iTop > 0) {
+        const Node& rclNode = _aclNodes[aulStack[--iTop]];
+        if (rclNode.afMin[0] > afMax[0] || rclNode.afMax[0] < afMin[0] ||
+            rclNode.afMin[1] > afMax[1] || rclNode.afMax[1] < afMin[1] ||
+            rclNode.afMin[2] > afMax[2] || rclNode.afMax[2] < afMin[2])
+            continue;
+
+        if (rclNode.ulCount > 0) {
+            for (unsigned long i = 0; i < rclNode.ulCount; i++) {
+                const TrianglePacket& rclPacket = _aclPackets[rclNode.ulFirst + i];
+                int aiHit[4];
+                for (int k = 0; k < 4; k++) {
+                    float fMinX = std::min<float>(rclPacket.x0[k], std::min<float>(rclPacket.x1[k], rclPacket.x2[k]));
+                    float fMaxX = std::max<float>(rclPacket.x0[k], std::max<float>(rclPacket.x1[k], rclPacket.x2[k]));
+                    float fMinY = std::min<float>(rclPacket.y0[k], std::min<float>(rclPacket.y1[k], rclPacket.y2[k]));
+                    float fMaxY = std::max<float>(rclPacket.y0[k], std::max<float>(rclPacket.y1[k], rclPacket.y2[k]));
+                    float fMinZ = std::min<float>(rclPacket.z0[k], std::min<float>(rclPacket.z1[k], rclPacket.z2[k]));
+                    float fMaxZ = std::max<float>(rclPacket.z0[k], std::max<float>(rclPacket.z1[k], rclPacket.z2[k]));
+                    aiHit[k] = (fMinX <= afMax[0]) & (fMaxX >= afMin[0]) &
+                               (fMinY <= afMax[1]) & (fMaxY >= afMin[1]) &
+                               (fMinZ <= afMax[2]) & (fMaxZ >= afMin[2]);
+                }
+                for (int k = 0; k < 4; k++) {
+                    if (aiHit[k] && rclPacket.index[k] != ULONG_MAX)
+                        raulFacets.push_back(rclPacket.index[k]);
+                }
+            }
+            continue;
+        }
+
+        aulStack[iTop++] = rclNode.ulFirst;
+        aulStack[iTop++] = rclNode.ulFirst + 1;
+    }
+}
+
+void MeshFacetBVH::SplitQueries(unsigned long ulCount, std::vector<QueryChunk>& raclChunks) const
+{
+    unsigned long ulChunkSize = std::max<unsigned long>(256,
+        ulCount / (4 * std::max<unsigned long>(QThread::idealThreadCount(), 1)) + 1);
+    for (unsigned long i = 0; i < ulCount; i += ulChunkSize) {
+        QueryChunk clChunk;
+        clChunk.ulBegin = i;
+        clChunk.ulEnd = std::min<unsigned long>(i + ulChunkSize, ulCount);
+        clChunk.pclPts = 0;
+        clChunk.pclDirs = 0;
+        clChunk.pulFacets = 0;
+        clChunk.pclRes = 0;
+        clChunk.fParam = 0.0f;
+        raclChunks.push_back(clChunk);
+    }
+}
+
+void MeshFacetBVH::RayChunk(QueryChunk& rclChunk) const
+{
+    for (unsigned long i = rclChunk.ulBegin; i < rclChunk.ulEnd; i++) {
+        if (!NearestFacetOnRay(rclChunk.pclPts[i], rclChunk.pclDirs[i], rclChunk.pclRes[i],
+                               rclChunk.pulFacets[i], rclChunk.fParam))
+            rclChunk.pulFacets[i] = ULONG_MAX;
+    }
+}
+
+void MeshFacetBVH::PointChunk(QueryChunk& rclChunk) const
+{
+    for (unsigned long i = rclChunk.ulBegin; i < rclChunk.ulEnd; i++) {
+        if (!NearestPointFromPoint(rclChunk.pclPts[i], rclChunk.pulFacets[i],
+                                   rclChunk.pclRes[i], rclChunk.fParam))
+            rclChunk.pulFacets[i] = ULONG_MAX;
+    }
+}
+
+void MeshFacetBVH::NearestFacetsOnRays(const std::vector<Base::Vector3f>& raclPts,
+                                       const std::vector<Base::Vector3f>& raclDirs,
+                                       std::vector<unsigned long>& raulFacets,
+                                       std::vector<Base::Vector3f>& raclRes,
+                                       float fMaxAngle) const
+{
+    unsigned long ulCount = std::min<unsigned long>(raclPts.size(), raclDirs.size());
+    raulFacets.resize(ulCount);
+    raclRes.resize(ulCount);
+    if (ulCount == 0)
+        return;
+
+    std::vector<QueryChunk> aclChunks;
+    SplitQueries(ulCount, aclChunks);
+    for (std::vector<QueryChunk>::iterator it = aclChunks.begin(); it != aclChunks.end(); ++it) {
+        it->pclPts = &raclPts[0];
+        it->pclDirs = &raclDirs[0];
+        it->pulFacets = &raulFacets[0];
+        it->pclRes = &raclRes[0];
+        it->fParam = fMaxAngle;
+    }
+
+    if (aclChunks.size() > 1)
+        QtConcurrent::blockingMap(aclChunks, boost::bind(&MeshFacetBVH::RayChunk, this, _1));
+    else
+        RayChunk(aclChunks.front());
+}
+
+void MeshFacetBVH::NearestPointsFromPoints(const std::vector<Base::Vector3f>& raclPts,
+                                           std::vector<unsigned long>& raulFacets,
+                                           std::vector<Base::Vector3f>& raclRes,
+                                           float fMaxDistance) const
+{
+    unsigned long ulCount = raclPts.size();
+    raulFacets.resize(ulCount);
+    raclRes.resize(ulCount);
+    if (ulCount == 0)
+        return;
+
+    std::vector<QueryChunk> aclChunks;
+    SplitQueries(ulCount, aclChunks);
+    for (std::vector<QueryChunk>::iterator it = aclChunks.begin(); it != aclChunks.end(); ++it) {
+        it->pclPts = &raclPts[0];
+        it->pulFacets = &raulFacets[0];
+        it->pclRes = &raclRes[0];
+        it->fParam = fMaxDistance;
+    }
+
+    if (aclChunks.size() > 1)
+        QtConcurrent::blockingMap(aclChunks, boost::bind(&MeshFacetBVH::PointChunk, this, _1));
+    else
+        PointChunk(aclChunks.front());
+}
@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MESHCORE_BVH_H
+#define MESHCORE_BVH_H
+
+#include <vector>
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+#include "Definitions.h"
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshFacetBVH class is a bounding volume hierarchy over the facets of a
+ * mesh kernel. Unlike the MeshFacetGrid its resolution adapts to the facet
+ * density, so that queries on scans with very uneven triangle sizes or with
+ * large empty regions stay fast.
+ *
+ * The tree is built with the surface area heuristic and kept in a flat node
+ * array where the two children of an inner node are stored next to each other.
+ * The facets of a leaf are copied into packets of four triangles whose
+ * coordinates are laid out component-wise, so that the intersection and
+ * distance tests of a packet can be vectorized by the compiler.
+ *
+ * Apart from rounding the results of the queries are the same as those of the
+ * brute force methods of MeshAlgorithm. All query methods are const and can be
+ * called from several threads at once.
+ * \note The tree must be rebuilt whenever the geometry of the mesh changes.
+ */
+class MeshExport MeshFacetBVH
+{
+public:
+    /// Builds the hierarchy for \a rclM.
+    MeshFacetBVH(const MeshKernel& rclM);
+    ~MeshFacetBVH();
+
+    /** @name Structure */
+    //@{
+    /// Rebuilds the hierarchy from the attached mesh.
+    void Rebuild();
+    /// Returns the attached mesh.
+    const MeshKernel& GetMesh() const { return _rclMesh; }
+    /// Returns the bounding box of all facets.
+    Base::BoundBox3f GetBoundBox() const;
+    /// Returns the number of nodes of the hierarchy.
+    unsigned long CountNodes() const { return _aclNodes.size(); }
+    /// Returns the number of bytes used by the hierarchy.
+    unsigned long GetMemoryUsage() const;
+    //@}
+
+    /** @name Single queries */
+    //@{
+    /**
+     * Searches for the nearest facet to the ray defined by (\a rclPt, \a rclDir).
+     * As with MeshGeomFacet::Foraminate() the ray is handled as a line and only
+     * facets whose normals have an angle of at most \a fMaxAngle to \a rclDir
+     * are taken into account. \a rclRes holds the intersection point with the
+     * facet \a rulFacet which is closest to \a rclPt.
+     * \note With the default \a fMaxAngle a ray opposite to a facet normal always
+     * hits, while Foraminate() may reject it due to rounding of the angle.
+     */
+    bool NearestFacetOnRay(const Base::Vector3f& rclPt, const Base::Vector3f& rclDir,
+                           Base::Vector3f& rclRes, unsigned long& rulFacet,
+                           float fMaxAngle = F_PI) const;
+    /**
+     * Searches for the facet \a rulFacet nearest to \a rclPt. \a rclRes holds
+     * the nearest point on this facet. Facets farther away than \a fMaxDistance
+     * are ignored.
+     */
+    bool NearestPointFromPoint(const Base::Vector3f& rclPt, unsigned long& rulFacet,
+                               Base::Vector3f& rclRes, float fMaxDistance = FLOAT_MAX) const;
+    /**
+     * Appends the indices of all facets with a distance of at most \a fMaxDistance
+     * to \a rclPt to \a raulFacets. The indices are not sorted.
+     */
+    void FacetsWithinDistance(const Base::Vector3f& rclPt, float fMaxDistance,
+                              std::vector<unsigned long>& raulFacets) const;
+    /**
+     * Appends the indices of all facets whose bounding boxes overlap \a rclBox
+     * to \a raulFacets. The indices are not sorted.
+     */
+    void FacetsInBox(const Base::BoundBox3f& rclBox, std::vector<unsigned long>& raulFacets) const;
+    //@}
+
+    /** @name Batch queries
+     * The batch queries answer their requests in parallel. If a query fails
+     * the facet index is set to ULONG_MAX.
+     */
+    //@{
+    /// Calls NearestFacetOnRay() for each pair of \a raclPts and \a raclDirs.
+    void NearestFacetsOnRays(const std::vector<Base::Vector3f>& raclPts,
+                             const std::vector<Base::Vector3f>& raclDirs,
+                             std::vector<unsigned long>& raulFacets,
+                             std::vector<Base::Vector3f>& raclRes,
+                             float fMaxAngle = F_PI) const;
+    /// Calls NearestPointFromPoint() for each point of \a raclPts.
+    void NearestPointsFromPoints(const std::vector<Base::Vector3f>& raclPts,
+                                 std::vector<unsigned long>& raulFacets,
+                                 std::vector<Base::Vector3f>& raclRes,
+                                 float fMaxDistance = FLOAT_MAX) const;
+    //@}
+
+private:
+    /** A node of the hierarchy. If \a ulCount is zero it is an inner node and
+     * \a ulFirst is the index of its left child, the right child follows it.
+     * Otherwise it is a leaf with \a ulCount packets starting at \a ulFirst.
+     */
+    struct Node
+    {
+        float afMin[3];
+        float afMax[3];
+        unsigned long ulFirst;
+        unsigned long ulCount;
+    };
+
+    /** Four triangles with their coordinates stored component-wise. Unused
+     * lanes repeat the first triangle and have the index ULONG_MAX.
+     */
+    struct TrianglePacket
+    {
+        float x0[4], y0[4], z0[4];
+        float x1[4], y1[4], z1[4];
+        float x2[4], y2[4], z2[4];
+        unsigned long index[4];
+    };
+
+    struct BuildItem
+    {
+        Base::BoundBox3f clBox;
+        Base::Vector3f clCenter;
+        unsigned long ulFacet;
+    };
+
+    struct QueryChunk
+    {
+        unsigned long ulBegin, ulEnd;
+        const Base::Vector3f* pclPts;
+        const Base::Vector3f* pclDirs;
+        unsigned long* pulFacets;
+        Base::Vector3f* pclRes;
+        float fParam;
+    };
+
+    void BuildNode(std::vector<BuildItem>& raclItems, unsigned long ulNode,
+                   unsigned long ulBegin, unsigned long ulEnd, int iDepth);
+    void BuildLeaf(const std::vector<BuildItem>& raclItems, unsigned long ulNode,
+                   unsigned long ulBegin, unsigned long ulEnd);
+    bool RayPacket(const TrianglePacket& rclPacket, const Base::Vector3f& rclPt,
+                   const Base::Vector3f& rclDir, float fCosAngle, float& rfParam,
+                   unsigned long& rulFacet) const;
+    void PointPacket(const TrianglePacket& rclPacket, const Base::Vector3f& rclPt,
+                     float& rfDist2, unsigned long& rulFacet) const;
+    void RayChunk(QueryChunk& rclChunk) const;
+    void PointChunk(QueryChunk& rclChunk) const;
+    void SplitQueries(unsigned long ulCount, std::vector<QueryChunk>& raclChunks) const;
+
+private:
+    const MeshKernel& _rclMesh;
+    std::vector<Node> _aclNodes;
+    std::vector<TrianglePacket> _aclPackets;
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_BVH_H
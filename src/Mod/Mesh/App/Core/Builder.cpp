@@ -25,8 +25,14 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cmath>
 #endif
 
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Base/Sequencer.h>
 #include <Base/Exception.h>
 
@@ -36,6 +42,114 @@
 using namespace MeshCore;
 
 
+MeshSpatialHash::MeshSpatialHash (float tolerance)
+  : _tolerance(tolerance), _cellSize(8.0 * tolerance)
+{
+    Rehash(1024);
+}
+
+MeshSpatialHash::~MeshSpatialHash (void)
+{
+}
+
+void MeshSpatialHash::CellOf (const Base::Vector3f& point, float offset, boost::int64_t cell[3]) const
+{
+    float coords[3] = { point.x, point.y, point.z };
+    for (int i = 0; i < 3; i++) {
+        if (_tolerance > 0.0f) {
+            // far away points are kept in the outermost cells
+            static const double limit = 4.0e18;
+            double c = std::floor(((double)coords[i] + offset) / _cellSize);
+            cell[i] = (boost::int64_t)std::max<double>(-limit, std::min<double>(limit, c));
+        }
+        else {
+            // without tolerance only identical points are merged, 0 and -0 share the cell
+            cell[i] = coords[i] == 0.0f ? 0 : (boost::int64_t)boost::hash_value(coords[i]);
+        }
+    }
+}
+
+std::size_t MeshSpatialHash::BucketOf (boost::int64_t x, boost::int64_t y, boost::int64_t z) const
+{
+    std::size_t seed = 0;
+    boost::hash_combine(seed, x);
+    boost::hash_combine(seed, y);
+    boost::hash_combine(seed, z);
+    return seed & (_buckets.size() - 1);
+}
+
+void MeshSpatialHash::Rehash (std::size_t count)
+{
+    std::size_t size = 1024;
+    while (size < 2 * count)
+        size *= 2;
+    if (size <= _buckets.size())
+        return;
+
+    _buckets.assign(size, ULONG_MAX);
+    _next.resize(_points.size());
+    for (unsigned long i = 0; i < _points.size(); i++) {
+        boost::int64_t cell[3];
+        CellOf(_points[i], 0.0f, cell);
+        std::size_t bucket = BucketOf(cell[0], cell[1], cell[2]);
+        _next[i] = _buckets[bucket];
+        _buckets[bucket] = i;
+    }
+}
+
+void MeshSpatialHash::Adopt (std::vector<Base::Vector3f>& points)
+{
+    _points.swap(points);
+    points.clear();
+    _buckets.clear();
+    Rehash(_points.size());
+}
+
+template <class Pred>
+unsigned long MeshSpatialHash::Find (const Base::Vector3f& point, unsigned long limit, Pred pred) const
+{
+    // the cells that overlap the box of the tolerance around the point
+    boost::int64_t lower[3], upper[3];
+    CellOf(point, -_tolerance, lower);
+    CellOf(point,  _tolerance, upper);
+
+    unsigned long found = ULONG_MAX;
+    for (boost::int64_t x = lower[0]; x <= upper[0]; x++) {
+        for (boost::int64_t y = lower[1]; y <= upper[1]; y++) {
+            for (boost::int64_t z = lower[2]; z <= upper[2]; z++) {
+                // the points of a bucket are chained in descending order
+                std::size_t bucket = BucketOf(x, y, z);
+                for (unsigned long index = _buckets[bucket]; index != ULONG_MAX; index = _next[index]) {
+                    if (index >= found || index >= limit)
+                        continue;
+                    const Base::Vector3f& p = _points[index];
+                    bool close = (_tolerance > 0.0f)
+                        ? (fabs(p.x - point.x) < _tolerance && fabs(p.y - point.y) < _tolerance &&
+                           fabs(p.z - point.z) < _tolerance)
+                        : (p.x == point.x && p.y == point.y && p.z == point.z);
+                    if (close && pred(index))
+                        found = index;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+namespace MeshCore {
+
+struct MeshAnyPoint
+{
+    bool operator()(unsigned long) const
+    {
+        return true;
+    }
+};
+
+}
+
+// ----------------------------------------------------------------------------
+
 MeshBuilder::MeshBuilder (MeshKernel& kernel) : _meshKernel(kernel), _seq(0)
 {
     _fSaveTolerance = MeshDefinitions::_fMinPointDistanceD1;
@@ -249,3 +363,169 @@ void MeshBuilder::Finish (bool freeMemory)
 
     _meshKernel.RecalcBoundBox();
 }
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+
+/** A range of points to search for nearby points. */
+struct MeshPointRange
+{
+    unsigned long begin, end;
+};
+
+/** Accepts the points that are not welded to another point. */
+struct MeshWeldTarget
+{
+    const std::vector<unsigned long>* weld;
+    bool operator()(unsigned long index) const
+    {
+        return (*weld)[index] == index;
+    }
+};
+
+}
+
+/** Finds for each point of the range the lowest point nearby, which may be the point itself. */
+static void FindClosePoints(const MeshSpatialHash& hash, std::vector<unsigned long>& weld,
+                            MeshPointRange& range)
+{
+    for (unsigned long i = range.begin; i < range.end; i++)
+        weld[i] = hash.Find(hash.GetPoint(i), i + 1, MeshAnyPoint());
+}
+
+MeshFastBuilder::MeshFastBuilder (MeshKernel& kernel) : _meshKernel(kernel), _seq(0)
+{
+    _tolerance = MeshDefinitions::_fMinPointDistanceD1;
+}
+
+MeshFastBuilder::~MeshFastBuilder (void)
+{
+    delete this->_seq;
+}
+
+void MeshFastBuilder::SetTolerance(float fTol)
+{
+    _tolerance = fTol;
+}
+
+void MeshFastBuilder::Initialize (unsigned long ctFacets)
+{
+    _meshKernel.Clear();
+    _points.clear();
+    _points.reserve(3 * ctFacets);
+
+    // one step per added facet and one per facet when numbering the points
+    delete this->_seq;
+    this->_seq = new Base::SequencerLauncher("create mesh structure...", ctFacets * 2);
+}
+
+void MeshFastBuilder::AddFacet (const MeshGeomFacet& facet)
+{
+    Base::Vector3f facetPoints[4] = { facet._aclPoints[0], facet._aclPoints[1],
+                                      facet._aclPoints[2], facet.GetNormal() };
+    AddFacet(facetPoints);
+}
+
+void MeshFastBuilder::AddFacet (const Base::Vector3f* facetPoints)
+{
+    this->_seq->next(true); // allow to cancel
+
+    // adjust circulation direction
+    _points.push_back(facetPoints[0]);
+    if ((((facetPoints[1] - facetPoints[0]) % (facetPoints[2] - facetPoints[0])) * facetPoints[3]) < 0.0f) {
+        _points.push_back(facetPoints[2]);
+        _points.push_back(facetPoints[1]);
+    }
+    else {
+        _points.push_back(facetPoints[1]);
+        _points.push_back(facetPoints[2]);
+    }
+}
+
+void MeshFastBuilder::AddFacets (const std::vector<Base::Vector3f>& points)
+{
+    std::size_t count = points.size() - points.size() % 3;
+    for (std::size_t i = 0; i < count; i += 3)
+        this->_seq->next(true); // allow to cancel
+    _points.insert(_points.end(), points.begin(), points.begin() + count);
+}
+
+void MeshFastBuilder::AddFacets (const std::vector<MeshGeomFacet>& facets)
+{
+    _points.reserve(_points.size() + 3 * facets.size());
+    for (std::vector<MeshGeomFacet>::const_iterator it = facets.begin(); it != facets.end(); ++it)
+        AddFacet(*it);
+}
+
+void MeshFastBuilder::Finish ()
+{
+    MeshSpatialHash hash(_tolerance);
+    hash.Adopt(_points);
+    unsigned long countPoints = hash.Size();
+
+    std::vector<unsigned long> weld(countPoints);
+    std::vector<MeshPointRange> ranges;
+    unsigned long size = std::max<unsigned long>(4096,
+        countPoints / (4 * std::max<int>(QThread::idealThreadCount(), 1)) + 1);
+    for (unsigned long i = 0; i < countPoints; i += size) {
+        MeshPointRange range;
+        range.begin = i;
+        range.end = std::min<unsigned long>(i + size, countPoints);
+        ranges.push_back(range);
+    }
+    QtConcurrent::blockingMap(ranges, boost::bind(&FindClosePoints, boost::cref(hash), boost::ref(weld), _1));
+
+    // Like MeshBuilder a point is welded to the first point nearby that is kept. Usually
+    // this is the lowest point nearby, otherwise the kept points must be searched.
+    MeshWeldTarget target;
+    target.weld = &weld;
+    for (unsigned long i = 0; i < countPoints; i++) {
+        unsigned long index = weld[i];
+        if (index == ULONG_MAX || index == i) {
+            weld[i] = i;
+        }
+        else if (weld[index] != index) {
+            index = hash.Find(hash.GetPoint(i), i, target);
+            weld[i] = (index == ULONG_MAX) ? i : index;
+        }
+    }
+
+    // Like MeshBuilder the points are numbered in the order of their first occurrence,
+    // then degenerated facets and the points only used by them are removed
+    MeshFacetArray facets;
+    facets.reserve(countPoints / 3);
+    std::vector<unsigned long> order;
+    std::vector<bool> seen(countPoints, false), used(countPoints, false);
+    for (unsigned long i = 0; i + 2 < countPoints; i += 3) {
+        this->_seq->next(true); // allow to cancel
+        unsigned long corner[3] = { weld[i], weld[i+1], weld[i+2] };
+        for (int j = 0; j < 3; j++) {
+            if (!seen[corner[j]]) {
+                seen[corner[j]] = true;
+                order.push_back(corner[j]);
+            }
+        }
+
+        if (corner[0] == corner[1] || corner[0] == corner[2] || corner[1] == corner[2])
+            continue;
+        for (int j = 0; j < 3; j++)
+            used[corner[j]] = true;
+        facets.push_back(MeshFacet(corner[0], corner[1], corner[2]));
+    }
+
+    MeshPointArray points;
+    std::vector<unsigned long> index(countPoints, ULONG_MAX);
+    for (std::vector<unsigned long>::iterator it = order.begin(); it != order.end(); ++it) {
+        if (used[*it]) {
+            index[*it] = points.size();
+            points.push_back(MeshPoint(hash.GetPoint(*it)));
+        }
+    }
+    for (MeshFacetArray::_TIterator it = facets.begin(); it != facets.end(); ++it) {
+        for (int j = 0; j < 3; j++)
+            it->_aulPoints[j] = index[it->_aulPoints[j]];
+    }
+
+    _meshKernel.Adopt(points, facets, true);
+}
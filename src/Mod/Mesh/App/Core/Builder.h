@@ -25,6 +25,7 @@
 
 #include <set>
 #include <vector>
+#include <boost/cstdint.hpp>
 
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
@@ -39,6 +40,42 @@ class MeshKernel;
 class MeshPoint;
 class MeshGeomFacet;
 
+/**
+ * Spatial hash of points to find coincident points. The points are sorted into grid
+ * cells a few times larger than the tolerance, so usually only one cell must be checked
+ * for points that are closer than the tolerance in each coordinate. The points of a
+ * bucket are chained by their indices which avoids allocations per point.
+ */
+class MeshExport MeshSpatialHash
+{
+public:
+    MeshSpatialHash(float tolerance);
+    ~MeshSpatialHash(void);
+
+    /** Takes over the points, \a points is empty afterwards. */
+    void Adopt (std::vector<Base::Vector3f>& points);
+    /** Returns the lowest index below \a limit of a point that is closer than the tolerance
+     * and whose index is accepted by \a pred, or ULONG_MAX if there is none.
+     */
+    template <class Pred>
+    unsigned long Find (const Base::Vector3f& point, unsigned long limit, Pred pred) const;
+    const Base::Vector3f& GetPoint (unsigned long index) const
+    { return _points[index]; }
+    unsigned long Size (void) const
+    { return _points.size(); }
+
+private:
+    void CellOf (const Base::Vector3f& point, float offset, boost::int64_t cell[3]) const;
+    std::size_t BucketOf (boost::int64_t x, boost::int64_t y, boost::int64_t z) const;
+    void Rehash (std::size_t count);
+
+    float _tolerance;
+    double _cellSize;
+    std::vector<unsigned long> _buckets; /**< Last point added to each bucket. */
+    std::vector<unsigned long> _next;    /**< Previous point of the same bucket. */
+    std::vector<Base::Vector3f> _points;
+};
+
 /**
  * Class for creating the mesh structure by adding facets. Building the structure needs 3 steps:
  * 1. initializing  
@@ -164,6 +201,65 @@ private:
     float _fSaveTolerance;
 };
 
+/**
+ * Class for creating the mesh structure from a triangle soup, e.g. the facets of an STL file.
+ * The points are welded within the tolerance like MeshBuilder does, but with a spatial hash
+ * that is searched by several threads, and the neighbourhood is built in parallel. So the
+ * structure of large meshes is built much faster. Like MeshBuilder it shows the progress
+ * and can be cancelled while adding the facets and numbering the points.
+ * \code
+ * MeshFastBuilder builder(someMeshReference);
+ * builder.Initialize(numberOfFacets);
+ * ...
+ * for (...)
+ *   builder.AddFacet(...);
+ * ...
+ * builder.Finish();
+ * \endcode
+ */
+class MeshExport MeshFastBuilder
+{
+public:
+    MeshFastBuilder(MeshKernel &rclM);
+    ~MeshFastBuilder(void);
+
+    /**
+     * Set the tolerance for the comparison of points, 0 only merges identical points.
+     * By default the tolerance of MeshBuilder is used.
+     */
+    void SetTolerance(float);
+
+    /** Initializes the class. Must be done before adding facets
+     * @param ctFacets count of facets.
+     */
+    void Initialize (unsigned long ctFacets);
+    /** Add new facet, the points are re-ordered to match the normal
+     */
+    void AddFacet (const MeshGeomFacet& facet);
+    /** Add new facet
+     * @param facetPoints Array of vectors (size 4) in order of vec1, vec2,
+     *                    vec3, normal
+     */
+    void AddFacet (const Base::Vector3f* facetPoints);
+    /** Adds the facets given by three consecutive points each, the
+     * orientation is taken as is.
+     */
+    void AddFacets (const std::vector<Base::Vector3f>& points);
+    /** Adds the facets, the points are re-ordered to match their normals
+     */
+    void AddFacets (const std::vector<MeshGeomFacet>& facets);
+    /** Finishes building up the mesh structure. Must be done after adding facets.
+     * Degenerated facets and their points are removed.
+     */
+    void Finish ();
+
+private:
+    MeshKernel& _meshKernel;
+    std::vector<Base::Vector3f> _points;
+    float _tolerance;
+    Base::SequencerLauncher* _seq;
+};
+
 } // namespace MeshCore
 
 #endif 
@@ -61,7 +61,7 @@ void MeshCurvature::ComputePerFace(bool parallel)
     Base::Vector3f rkDir0, rkDir1, rkPnt;
     Base::Vector3f rkNormal;
     myCurvature.clear();
-    MeshRefPointToFacets search(myKernel);
+    MeshCompactPointToFacets search(myKernel);
     FacetCurvature face(myKernel, search, myRadius, myMinPoints);
 
     if (!parallel) {
@@ -150,7 +150,7 @@ private:
 
 // --------------------------------------------------------
 
-FacetCurvature::FacetCurvature(const MeshKernel& kernel, const MeshRefPointToFacets& search, float r, unsigned long pt)
+FacetCurvature::FacetCurvature(const MeshKernel& kernel, const MeshCompactPointToFacets& search, float r, unsigned long pt)
   : myKernel(kernel), mySearch(search), myMinPoints(pt), myRadius(r)
 {
 }
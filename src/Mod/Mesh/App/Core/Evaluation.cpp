@@ -28,6 +28,10 @@
 # include <vector>
 #endif
 
+#include <boost/bind.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
 
@@ -38,6 +42,7 @@
 #include "MeshIO.h"
 #include "Helpers.h"
 #include "Grid.h"
+#include "BVH.h"
 #include "TopoAlgorithm.h"
 #include <Base/Matrix.h>
 
@@ -586,76 +591,115 @@ bool MeshFixSingleFacet::Fixup ()
 
 // ----------------------------------------------------------------
 
-bool MeshEvalSelfIntersection::Evaluate ()
+namespace MeshCore {
+
+/** A range of facets with the found self-intersections. */
+struct SelfIntersectionRange
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
+    unsigned long begin, end;
+    std::vector<std::pair<unsigned long, unsigned long> > pairs;
+};
 
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
+}
+
+/** Tests each facet of \a range against the facets with a higher index whose bounding
+ * boxes overlap. If \a onlyFirst is true the search stops at the first intersection.
+ */
+static void IntersectFacets(const MeshKernel& mesh, const MeshFacetBVH& bvh,
+                            const std::vector<Base::BoundBox3f>& boxes, bool onlyFirst,
+                            SelfIntersectionRange& range)
+{
+    const MeshFacetArray& rFaces = mesh.GetFacets();
+    std::vector<unsigned long> candidates;
+    Base::Vector3f pt1, pt2;
+    for (unsigned long i = range.begin; i < range.end; i++) {
+        candidates.clear();
+        bvh.FacetsInBox(boxes[i], candidates);
+        std::sort(candidates.begin(), candidates.end());
+
+        const Base::BoundBox3f& box1 = boxes[i];
+        const MeshFacet& rface1 = rFaces[i];
+        MeshGeomFacet facet1 = mesh.GetFacet(i);
+        std::vector<unsigned long>::iterator jt;
+        for (jt = std::upper_bound(candidates.begin(), candidates.end(), i); jt != candidates.end(); ++jt) {
+            // If the facets share a common vertex we do not check for self-intersections because they 
+            // could but usually do not intersect each other and the algorithm below would detect false-positives,
+            // otherwise
+            const MeshFacet& rface2 = rFaces[*jt];
+            bool common = false;
+            for (int k = 0; k < 3; k++) {
+                if (rface1._aulPoints[k] == rface2._aulPoints[0] ||
+                    rface1._aulPoints[k] == rface2._aulPoints[1] ||
+                    rface1._aulPoints[k] == rface2._aulPoints[2])
+                    common = true;
+            }
+            if (common)
+                continue; // ignore facets sharing a common vertex
+
+            const Base::BoundBox3f& box2 = boxes[*jt];
+            if (box1 && box2) {
+                MeshGeomFacet facet2 = mesh.GetFacet(*jt);
+                int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
+                if (ret == 2) {
+                    range.pairs.push_back(std::make_pair(i, *jt));
+                    if (onlyFirst)
+                        return;
+                }
+            }
+        }
+    }
+}
 
+void MeshEvalSelfIntersection::FindIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection,
+                                                 bool onlyFirst) const
+{
+    // Contains bounding boxes for every facet 
+    std::vector<Base::BoundBox3f> boxes;
+    boxes.reserve(_rclMesh.CountFacets());
     MeshFacetIterator cMFI(_rclMesh);
     for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
         boxes.push_back((*cMFI).GetBoundBox());
     }
 
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next();
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
-        Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        // abort after the first detected self-intersection
-                        return false;
-                    }
-                }
-            }
+    // Unlike a grid the hierarchy returns each facet only once, so that every pair
+    // is tested once by the facet with the lower index
+    MeshFacetBVH bvh(_rclMesh);
+
+    // Calculates the intersections in parallel block by block to show the progress
+    unsigned long count = boxes.size();
+    unsigned long block = std::max<unsigned long>(count / 100, 4096);
+    unsigned long size = std::max<unsigned long>(256,
+        block / (4 * std::max<int>(QThread::idealThreadCount(), 1)) + 1);
+    Base::SequencerLauncher seq("Checking for self-intersections...", (count + block - 1) / block);
+    std::vector<SelfIntersectionRange> ranges;
+    for (unsigned long first = 0; first < count; first += block) {
+        unsigned long last = std::min<unsigned long>(first + block, count);
+        ranges.clear();
+        for (unsigned long i = first; i < last; i += size) {
+            SelfIntersectionRange range;
+            range.begin = i;
+            range.end = std::min<unsigned long>(i + size, last);
+            ranges.push_back(range);
         }
+
+        QtConcurrent::blockingMap(ranges, boost::bind(&IntersectFacets, boost::cref(_rclMesh),
+            boost::cref(bvh), boost::cref(boxes), onlyFirst, _1));
+        for (std::vector<SelfIntersectionRange>::iterator it = ranges.begin(); it != ranges.end(); ++it)
+            intersection.insert(intersection.end(), it->pairs.begin(), it->pairs.end());
+        if (onlyFirst && !intersection.empty())
+            return;
+
+        // only collecting all intersections can be aborted by the user
+        seq.next(!onlyFirst);
     }
+}
 
-    return true;
+bool MeshEvalSelfIntersection::Evaluate ()
+{
+    // abort after the first detected self-intersection
+    std::vector<std::pair<unsigned long, unsigned long> > intersection;
+    FindIntersections(intersection, true);
+    return intersection.empty();
 }
 
 void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsigned long, unsigned long> >& indices,
@@ -684,72 +728,7 @@ void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsi
 
 void MeshEvalSelfIntersection::GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection) const
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-    //intersection.clear();
-
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
-
-    MeshFacetIterator cMFI(_rclMesh);
-    for(cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
-    }
-
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next(true);
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
-        Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        intersection.push_back(std::make_pair (*it,*jt));
-                    }
-                }
-            }
-        }
-    }
+    FindIntersections(intersection, false);
 }
 
 std::vector<unsigned long> MeshFixSelfIntersection::GetFacets() const
@@ -943,6 +922,72 @@ bool MeshFixNeighbourhood::Fixup()
     return true;
 }
 
+namespace MeshCore {
+
+/** A range of edges, optionally split into two sorted parts to be merged. */
+struct EdgeRange
+{
+    std::vector<Edge_Index>::iterator first, middle, last;
+};
+
+}
+
+static void SortEdgeRange(EdgeRange& range)
+{
+    std::sort(range.first, range.last, Edge_Less());
+}
+
+static void MergeEdgeRange(EdgeRange& range)
+{
+    std::inplace_merge(range.first, range.middle, range.last, Edge_Less());
+}
+
+static void SetEdgeNeighbours(MeshFacetArray& facets, unsigned long p0, unsigned long p1,
+                              unsigned long f0, unsigned long f1, int count)
+{
+    // we handle only the cases for 1 and 2, for all higher
+    // values we have a non-manifold that is ignorned here
+    if (count == 2) {
+        MeshFacet& rFace0 = facets[f0];
+        MeshFacet& rFace1 = facets[f1];
+        unsigned short side0 = rFace0.Side(p0,p1);
+        unsigned short side1 = rFace1.Side(p0,p1);
+        rFace0._aulNeighbours[side0] = f1;
+        rFace1._aulNeighbours[side1] = f0;
+    }
+    else if (count == 1) {
+        MeshFacet& rFace = facets[f0];
+        unsigned short side = rFace.Side(p0,p1);
+        rFace._aulNeighbours[side] = ULONG_MAX;
+    }
+}
+
+/** Sets the neighbours of the facets sharing the sorted edges of \a range. */
+static void SetNeighbours(MeshFacetArray& facets, EdgeRange& range)
+{
+    unsigned long p0 = ULONG_MAX, p1 = ULONG_MAX;
+    unsigned long f0 = ULONG_MAX, f1 = ULONG_MAX;
+    int count = 0;
+    std::vector<Edge_Index>::iterator pE;
+    for (pE = range.first; pE != range.last; pE++) {
+        if (p0 == pE->p0 && p1 == pE->p1) {
+            f1 = pE->f;
+            count++;
+        }
+        else {
+            SetEdgeNeighbours(facets, p0, p1, f0, f1, count);
+
+            p0 = pE->p0;
+            p1 = pE->p1;
+            f0 = pE->f;
+            count = 1;
+        }
+    }
+
+    SetEdgeNeighbours(facets, p0, p1, f0, f1, count);
+}
+
+
 void MeshKernel::RebuildNeighbours (unsigned long index)
 {
     std::vector<Edge_Index> edges;
@@ -961,57 +1006,68 @@ void MeshKernel::RebuildNeighbours (unsigned long index)
         }
     }
 
-    // sort the edges
-    std::sort(edges.begin(), edges.end(), Edge_Less());
+    // for small meshes the threads don't pay off
+    std::size_t threads = std::max<int>(QThread::idealThreadCount(), 1);
+    if (threads < 2 || edges.size() < 100000) {
+        std::sort(edges.begin(), edges.end(), Edge_Less());
+        EdgeRange range;
+        range.first = edges.begin();
+        range.middle = range.last = edges.end();
+        SetNeighbours(this->_aclFacetArray, range);
+        return;
+    }
 
-    unsigned long p0 = ULONG_MAX, p1 = ULONG_MAX;
-    unsigned long f0 = ULONG_MAX, f1 = ULONG_MAX;
-    int count = 0;
-    std::vector<Edge_Index>::iterator pE;
-    for (pE = edges.begin(); pE != edges.end(); pE++) {
-        if (p0 == pE->p0 && p1 == pE->p1) {
-            f1 = pE->f;
-            count++;
-        }
-        else {
-            // we handle only the cases for 1 and 2, for all higher
-            // values we have a non-manifold that is ignorned here
-            if (count == 2) {
-                MeshFacet& rFace0 = this->_aclFacetArray[f0];
-                MeshFacet& rFace1 = this->_aclFacetArray[f1];
-                unsigned short side0 = rFace0.Side(p0,p1);
-                unsigned short side1 = rFace1.Side(p0,p1);
-                rFace0._aulNeighbours[side0] = f1;
-                rFace1._aulNeighbours[side1] = f0;
-            }
-            else if (count == 1) {
-                MeshFacet& rFace = this->_aclFacetArray[f0];
-                unsigned short side = rFace.Side(p0,p1);
-                rFace._aulNeighbours[side] = ULONG_MAX;
+    // sort blocks of edges in parallel and merge them pairwise
+    std::vector<std::vector<Edge_Index>::iterator> bounds;
+    for (std::size_t i = 0; i <= threads; i++)
+        bounds.push_back(edges.begin() + edges.size() * i / threads);
+
+    std::vector<EdgeRange> ranges;
+    for (std::size_t i = 0; i < threads; i++) {
+        EdgeRange range;
+        range.first = bounds[i];
+        range.middle = range.last = bounds[i+1];
+        ranges.push_back(range);
+    }
+    QtConcurrent::blockingMap(ranges, SortEdgeRange);
+
+    while (bounds.size() > 2) {
+        std::size_t blocks = bounds.size() - 1;
+        std::vector<std::vector<Edge_Index>::iterator> merged;
+        ranges.clear();
+        for (std::size_t i = 0; i < blocks; i += 2) {
+            merged.push_back(bounds[i]);
+            if (i + 1 < blocks) {
+                EdgeRange range;
+                range.first = bounds[i];
+                range.middle = bounds[i+1];
+                range.last = bounds[i+2];
+                ranges.push_back(range);
             }
-
-            p0 = pE->p0;
-            p1 = pE->p1;
-            f0 = pE->f;
-            count = 1;
         }
+        merged.push_back(bounds.back());
+        QtConcurrent::blockingMap(ranges, MergeEdgeRange);
+        bounds.swap(merged);
     }
 
-    // we handle only the cases for 1 and 2, for all higher
-    // values we have a non-manifold that is ignorned here
-    if (count == 2) {
-        MeshFacet& rFace0 = this->_aclFacetArray[f0];
-        MeshFacet& rFace1 = this->_aclFacetArray[f1];
-        unsigned short side0 = rFace0.Side(p0,p1);
-        unsigned short side1 = rFace1.Side(p0,p1);
-        rFace0._aulNeighbours[side0] = f1;
-        rFace1._aulNeighbours[side1] = f0;
-    }
-    else if (count == 1) {
-        MeshFacet& rFace = this->_aclFacetArray[f0];
-        unsigned short side = rFace.Side(p0,p1);
-        rFace._aulNeighbours[side] = ULONG_MAX;
+    // all edges of a facet side must be handled by the same thread, so the
+    // ranges only end where the next edge differs
+    ranges.clear();
+    std::vector<Edge_Index>::iterator first = edges.begin();
+    for (std::size_t i = 1; i <= threads; i++) {
+        std::vector<Edge_Index>::iterator last = edges.begin() + edges.size() * i / threads;
+        if (last < first)
+            last = first;
+        while (last != edges.begin() && last != edges.end() &&
+               last->p0 == (last-1)->p0 && last->p1 == (last-1)->p1)
+            ++last;
+        EdgeRange range;
+        range.first = first;
+        range.middle = range.last = last;
+        ranges.push_back(range);
+        first = last;
     }
+    QtConcurrent::blockingMap(ranges, boost::bind(&SetNeighbours, boost::ref(this->_aclFacetArray), _1));
 }
 
 void MeshKernel::RebuildNeighbours (void)
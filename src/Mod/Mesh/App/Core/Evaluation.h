@@ -295,8 +295,13 @@ public:
     /// collect all intersection lines
     void GetIntersections(const std::vector<std::pair<unsigned long, unsigned long> >&,
         std::vector<std::pair<Base::Vector3f, Base::Vector3f> >&) const;
-    /// collect the index of all facets with self intersections
+    /** Collect the index of all facets with self intersections. The pairs are sorted and
+     * the lower index comes first. The facets are tested in parallel.
+     */
     void GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >&) const;
+
+private:
+    void FindIntersections(std::vector<std::pair<unsigned long, unsigned long> >&, bool onlyFirst) const;
 };
 
 /**
@@ -27,6 +27,10 @@
 # include <algorithm>
 #endif
 
+#include <boost/bind.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include "Grid.h"
 #include "Iterator.h"
 
@@ -36,8 +40,11 @@
 
 using namespace MeshCore;
 
+bool MeshGrid::_bDefaultCompact = true;
+
 MeshGrid::MeshGrid (const MeshKernel &rclM)
-: _pclMesh(&rclM),
+: _bCompact(_bDefaultCompact),
+  _pclMesh(&rclM),
   _ulCtElements(0),
   _ulCtGridsX(0), _ulCtGridsY(0), _ulCtGridsZ(0),
   _fGridLenX(0.0f), _fGridLenY(0.0f), _fGridLenZ(0.0f),
@@ -46,7 +53,8 @@ MeshGrid::MeshGrid (const MeshKernel &rclM)
 }
 
 MeshGrid::MeshGrid (void)
-: _pclMesh(NULL),
+: _bCompact(_bDefaultCompact),
+  _pclMesh(NULL),
   _ulCtElements(0),
   _ulCtGridsX(MESH_CT_GRID), _ulCtGridsY(MESH_CT_GRID), _ulCtGridsZ(MESH_CT_GRID),
   _fGridLenX(0.0f), _fGridLenY(0.0f), _fGridLenZ(0.0f),
@@ -63,6 +71,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 void MeshGrid::Clear (void)
 {
   _aulGrid.clear();
+  _aulOffsets.clear();
+  _aulElements.clear();
   _pclMesh = NULL;  
 }
 
@@ -129,6 +139,15 @@ void MeshGrid::InitGrid (void)
 
   // Daten-Struktur anlegen
   _aulGrid.clear();
+  _aulOffsets.clear();
+  _aulElements.clear();
+  if (_bCompact)
+  {
+    // empty grids until RebuildCompact() fills them
+    _aulOffsets.resize(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+    return;
+  }
+
   _aulGrid.resize(_ulCtGridsX);
   for (i = 0; i < _ulCtGridsX; i++)
   {
@@ -138,6 +157,132 @@ void MeshGrid::InitGrid (void)
   }
 }
 
+void MeshGrid::SetCompactLayout (bool bCompact)
+{
+  if (_bCompact == bCompact)
+    return;
+  _bCompact = bCompact;
+  _aulGrid.clear();
+  _aulOffsets.clear();
+  _aulElements.clear();
+  if (_pclMesh)
+    RebuildGrid();
+}
+
+unsigned long MeshGrid::GetMemoryUsage (void) const
+{
+  unsigned long ulSize = sizeof(MeshGrid);
+  if (_bCompact)
+  {
+    ulSize += _aulOffsets.capacity() * sizeof(unsigned long);
+    ulSize += _aulElements.capacity() * sizeof(unsigned long);
+  }
+  else
+  {
+    // a tree node holds three pointers and the color besides the value
+    const unsigned long ulNodeSize = 4 * sizeof(void*) + sizeof(unsigned long);
+    for (unsigned long i = 0; i < _aulGrid.size(); i++)
+    {
+      ulSize += _aulGrid[i].capacity() * sizeof(_aulGrid[i]);
+      for (unsigned long j = 0; j < _aulGrid[i].size(); j++)
+      {
+        ulSize += _aulGrid[i][j].capacity() * sizeof(std::set<unsigned long>);
+        for (unsigned long k = 0; k < _aulGrid[i][j].size(); k++)
+          ulSize += _aulGrid[i][j][k].size() * ulNodeSize;
+      }
+    }
+  }
+
+  return ulSize;
+}
+
+void MeshGrid::FindGrids (unsigned long, std::vector<unsigned long> &) const
+{
+}
+
+void MeshGrid::FindGridsOfChunk (GridChunk &rclChunk) const
+{
+  std::vector<unsigned long> aulGrids;
+  for (unsigned long i = rclChunk.ulBegin; i < rclChunk.ulEnd; i++)
+  {
+    aulGrids.clear();
+    FindGrids(i, aulGrids);
+    for (std::vector<unsigned long>::iterator it = aulGrids.begin(); it != aulGrids.end(); ++it)
+    {
+      rclChunk.aulGrids.push_back(*it);
+      rclChunk.aulElements.push_back(i);
+    }
+  }
+}
+
+void MeshGrid::InsertElement (unsigned long ulX, unsigned long ulY, unsigned long ulZ, unsigned long ulIndex)
+{
+  if (!_bCompact)
+  {
+    _aulGrid[ulX][ulY][ulZ].insert(ulIndex);
+    return;
+  }
+
+  // keep the elements of the grid sorted and unique like a std::set
+  unsigned long ulGrid = (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX;
+  std::vector<unsigned long>::iterator first = _aulElements.begin() + _aulOffsets[ulGrid];
+  std::vector<unsigned long>::iterator last = _aulElements.begin() + _aulOffsets[ulGrid + 1];
+  std::vector<unsigned long>::iterator it = std::lower_bound(first, last, ulIndex);
+  if (it != last && *it == ulIndex)
+    return;
+  _aulElements.insert(it, ulIndex);
+  for (unsigned long i = ulGrid + 1; i < _aulOffsets.size(); i++)
+    _aulOffsets[i]++;
+}
+
+void MeshGrid::RebuildCompact (void)
+{
+  unsigned long ulCtGrids = _ulCtGridsX * _ulCtGridsY * _ulCtGridsZ;
+  unsigned long ulCtElements = HasElements();
+
+  // the geometric tests are done in parallel on chunks of consecutive elements
+  std::vector<GridChunk> aclChunks;
+  unsigned long ulChunkSize = std::max<unsigned long>(4096,
+    ulCtElements / (4 * std::max<unsigned long>(QThread::idealThreadCount(), 1)) + 1);
+  for (unsigned long i = 0; i < ulCtElements; i += ulChunkSize)
+  {
+    GridChunk clChunk;
+    clChunk.ulBegin = i;
+    clChunk.ulEnd = std::min<unsigned long>(i + ulChunkSize, ulCtElements);
+    aclChunks.push_back(clChunk);
+  }
+
+  if (aclChunks.size() > 1)
+    QtConcurrent::blockingMap(aclChunks, boost::bind(&MeshGrid::FindGridsOfChunk, this, _1));
+  else if (aclChunks.size() == 1)
+    FindGridsOfChunk(aclChunks.front());
+
+  // counting pass
+  _aulOffsets.clear();
+  _aulOffsets.resize(ulCtGrids + 1, 0);
+  std::vector<GridChunk>::iterator it;
+  for (it = aclChunks.begin(); it != aclChunks.end(); ++it)
+  {
+    for (std::vector<unsigned long>::iterator jt = it->aulGrids.begin(); jt != it->aulGrids.end(); ++jt)
+      _aulOffsets[*jt + 1]++;
+  }
+  for (unsigned long i = 0; i < ulCtGrids; i++)
+    _aulOffsets[i + 1] += _aulOffsets[i];
+
+  // filling pass, the chunks are in order so that the elements of each grid are sorted
+  _aulElements.clear();
+  _aulElements.resize(_aulOffsets.back());
+  std::vector<unsigned long> aulFill(_aulOffsets.begin(), _aulOffsets.end() - 1);
+  for (it = aclChunks.begin(); it != aclChunks.end(); ++it)
+  {
+    for (std::size_t j = 0; j < it->aulGrids.size(); j++)
+      _aulElements[aulFill[it->aulGrids[j]]++] = it->aulElements[j];
+
+    std::vector<unsigned long>().swap(it->aulGrids);
+    std::vector<unsigned long>().swap(it->aulElements);
+  }
+}
+
 unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements,
                                 bool bDelDoubles) const
 {
@@ -155,7 +300,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        AddElements(i, j, k, raulElements);
       }
     }
   }  
@@ -190,7 +335,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).CalcCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          AddElements(i, j, k, raulElements);
       }
     }
   }  
@@ -221,7 +366,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        AddElements(i, j, k, raulElements);
       }
     }
   }  
@@ -451,7 +596,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              AddElements(nX, i, j, raclInd);
           }
           nX++;
         }
@@ -465,7 +610,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              AddElements(nX, i, j, raclInd);
           }
           nX++;
         }
@@ -479,7 +624,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              AddElements(i, nY, j, raclInd);
           }
           nY++;
         }
@@ -493,7 +638,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              AddElements(i, nY, j, raclInd);
           }
           nY--;
         }
@@ -507,7 +652,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              AddElements(i, j, nZ, raclInd);
           }
           nZ++;
         }
@@ -521,7 +666,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              AddElements(i, j, nZ, raclInd);
           }
           nZ--;
         }
@@ -587,14 +732,11 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
-  {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
-  }
+  unsigned long ulCount = GetCtElements(ulX, ulY, ulZ);
+  if (ulCount > 0)
+    AddElements(ulX, ulY, ulZ, raclInd);
 
-  return 0;
+  return ulCount;
 }
 
 unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<unsigned long>& aulFacets) const
@@ -603,9 +745,8 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.clear();
+  AddElements(ulX, ulY, ulZ, aulFacets);
   return aulFacets.size();
 }
 
@@ -708,6 +849,12 @@ void MeshFacetGrid::RebuildGrid (void)
   _ulCtElements = _pclMesh->CountFacets();
 
   InitGrid();
+
+  if (_bCompact)
+  {
+    RebuildCompact();
+    return;
+  }
  
   // Daten-Struktur fuellen
   MeshFacetIterator clFIter(*_pclMesh);
@@ -915,10 +1062,58 @@ void MeshFacetGrid::SearchNearestFacetInHull (unsigned long ulX, unsigned long u
   }
 }
 
+void MeshFacetGrid::FindGrids (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const
+{
+  // same as AddFacet()
+  MeshGeomFacet clFacet = _pclMesh->GetFacet(ulIndex);
+  unsigned long ulX, ulY, ulZ;
+  unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
+
+  Base::BoundBox3f clBB;
+  clBB &= clFacet._aclPoints[0];
+  clBB &= clFacet._aclPoints[1];
+  clBB &= clFacet._aclPoints[2];
+
+  Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
+  Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
+
+  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
+  {
+    for (ulX = ulX1; ulX <= ulX2; ulX++)
+    {
+      for (ulY = ulY1; ulY <= ulY2; ulY++)
+      {
+        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
+        {
+          if (clFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
+            raulGrids.push_back((ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX);
+        }
+      }
+    }
+  }
+  else
+    raulGrids.push_back((ulZ1 * _ulCtGridsY + ulY1) * _ulCtGridsX + ulX1);
+}
+
 void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ulY, unsigned long ulZ, 
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
+  if (_bCompact)
+  {
+    unsigned long ulIndex = (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX;
+    for (unsigned long i = _aulOffsets[ulIndex]; i < _aulOffsets[ulIndex + 1]; i++)
+    {
+      float fDist = _pclMesh->GetFacet(_aulElements[i]).DistanceToPoint(rclPt);
+      if (fDist < rfMinDist)
+      {
+        rfMinDist   = fDist;
+        rulFacetInd = _aulElements[i];
+      }
+    }
+    return;
+  }
+
   const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
   for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); pI++)
   {
@@ -970,7 +1165,16 @@ void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, f
   unsigned long ulX, ulY, ulZ;
   Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    InsertElement(ulX, ulY, ulZ, ulPtIndex);
+}
+
+void MeshPointGrid::FindGrids (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const
+{
+  // same as AddPoint()
+  unsigned long ulX, ulY, ulZ;
+  Pos(_pclMesh->GetPoint(ulIndex), ulX, ulY, ulZ);
+  if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
+    raulGrids.push_back((ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX);
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1019,6 +1223,12 @@ void MeshPointGrid::RebuildGrid (void)
   _ulCtElements = _pclMesh->CountPoints();
 
   InitGrid();
+
+  if (_bCompact)
+  {
+    RebuildCompact();
+    return;
+  }
  
   // Daten-Struktur fuellen
 
@@ -1090,7 +1300,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    _rclGrid.AddElements(_ulX, _ulY, _ulZ, raulElements);
     _bValidRay = true;
   }
   else
@@ -1103,7 +1313,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      _rclGrid.AddElements(_ulX, _ulY, _ulZ, raulElements);
       _bValidRay = true;
     }
   }
@@ -1154,7 +1364,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    _rclGrid.AddElements(_ulX, _ulY, _ulZ, raulElements); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
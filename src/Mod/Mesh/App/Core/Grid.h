@@ -124,8 +124,7 @@ public:
    */
   bool GetPositionToIndex(unsigned long id, unsigned long& ulX, unsigned long& ulY, unsigned long& ulZ) const;
   /** Returns the number of elements in a given grid. */
-  unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return _aulGrid[ulX][ulY][ulZ].size(); }
+  inline unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const;
   /** Validates the grid structure and rebuilds it if needed. Must be implemented in sub-classes. */
   virtual void Validate (const MeshKernel &rclM) = 0;
   /** Verifies the grid structure and returns false if inconsistencies are found. */
@@ -142,6 +141,26 @@ public:
   /** Get the indices of all elements lying in the grids around a given grid with distance \a ulDistance. */
   void GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ, unsigned long ulDistance, std::set<unsigned long> &raclInd) const;
 
+  /** @name Storage layout */
+  //@{
+  /** Sets the storage layout of the grid. In the compact layout (the default) the element indices of all
+   * grids are kept in one contiguous array together with an array of offsets per grid. Otherwise each grid
+   * keeps its own std::set. An attached mesh is rebuilt with the new layout.
+   */
+  void SetCompactLayout (bool bCompact);
+  /** Returns true if the compact layout is used. */
+  bool IsCompactLayout (void) const
+  { return _bCompact; }
+  /** Sets the storage layout of all grids created afterwards. */
+  static void SetDefaultCompactLayout (bool bCompact)
+  { _bDefaultCompact = bCompact; }
+  /** Returns true if new grids use the compact layout. */
+  static bool IsDefaultCompactLayout (void)
+  { return _bDefaultCompact; }
+  /** Returns the approximate number of bytes used by the grid structure. */
+  unsigned long GetMemoryUsage (void) const;
+  //@}
+
 protected:
   /** Initializes the size of the internal structure. */
   virtual void InitGrid (void);
@@ -155,9 +174,37 @@ protected:
   virtual void RebuildGrid (void) = 0;
   /** Returns the number of stored elements. Must be implemented in sub-classes. */
   virtual unsigned long HasElements (void) const = 0;
+  /** Collects the indices (see GetIndexToPosition()) of all grids the element \a ulIndex belongs to. Must be
+   * implemented in sub-classes that use the compact layout. This method may be called from several threads.
+   */
+  virtual void FindGrids (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const;
+  /** Fills the compact layout with all elements. The grids of the elements are searched in parallel,
+   * afterwards the elements are sorted into the grids by a counting pass.
+   */
+  void RebuildCompact (void);
+  /** Appends the indices of the elements in the given grid. */
+  inline void AddElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ, std::vector<unsigned long> &raulElements) const;
+  /** Inserts the indices of the elements in the given grid. */
+  inline void AddElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ, std::set<unsigned long> &raulElements) const;
+  /** Inserts the element \a ulIndex into the given grid. This works with both layouts but in the compact
+   * layout all following elements must be moved, so it is much slower than rebuilding the grid at once.
+   */
+  void InsertElement (unsigned long ulX, unsigned long ulY, unsigned long ulZ, unsigned long ulIndex);
+
+  /** Elements of a subset of the mesh elements and their grids, used to build the compact layout. */
+  struct GridChunk
+  {
+    unsigned long ulBegin, ulEnd;
+    std::vector<unsigned long> aulGrids;
+    std::vector<unsigned long> aulElements;
+  };
+  void FindGridsOfChunk (GridChunk &rclChunk) const;
 
 protected:
   std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  std::vector<unsigned long> _aulOffsets;  /**< Compact layout: start of each grid in _aulElements, one more than grids. */
+  std::vector<unsigned long> _aulElements; /**< Compact layout: element indices of all grids. */
+  bool              _bCompact;    /**< Compact layout or one set per grid. */
   const MeshKernel* _pclMesh;     /**< The mesh kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -169,6 +216,7 @@ protected:
   float             _fMinX;       /**< Grid null position in x. */
   float             _fMinY;       /**< Grid null position in y. */ 
   float             _fMinZ;       /**< Grid null position in z. */
+  static bool       _bDefaultCompact; /**< Layout of new grids. */
 
   // friends
   friend class MeshGridIterator;
@@ -231,6 +279,8 @@ protected:
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountFacets(); }
+  /** Collects the grids that intersect the facet \a ulIndex. */
+  virtual void FindGrids (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const;
   /** Rebuilds the grid structure. */
   virtual void RebuildGrid (void);
 };
@@ -276,6 +326,8 @@ protected:
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountPoints(); }
+  /** Collects the grid that contains the point \a ulIndex. */
+  virtual void FindGrids (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const;
   /** Rebuilds the grid structure. */
   virtual void RebuildGrid (void);
 };
@@ -295,7 +347,7 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    _rclGrid.AddElements(_ulX, _ulY, _ulZ, raulElements);
   }
   /** Returns the number of elements in the current grid. */
   unsigned long GetCtElements() const
@@ -391,6 +443,49 @@ inline bool MeshGrid::CheckPos (unsigned long ulX, unsigned long ulY, unsigned l
   return ((ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ));
 }
 
+inline unsigned long MeshGrid::GetCtElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+{
+  if (_bCompact)
+  {
+    unsigned long ulIndex = (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX;
+    return _aulOffsets[ulIndex + 1] - _aulOffsets[ulIndex];
+  }
+
+  return _aulGrid[ulX][ulY][ulZ].size();
+}
+
+inline void MeshGrid::AddElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ, std::vector<unsigned long> &raulElements) const
+{
+  if (_bCompact)
+  {
+    unsigned long ulIndex = (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX;
+    unsigned long ulBegin = _aulOffsets[ulIndex], ulEnd = _aulOffsets[ulIndex + 1];
+    if (ulBegin < ulEnd)
+      raulElements.insert(raulElements.end(), &_aulElements[0] + ulBegin, &_aulElements[0] + ulEnd);
+  }
+  else
+  {
+    const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
+    raulElements.insert(raulElements.end(), rclSet.begin(), rclSet.end());
+  }
+}
+
+inline void MeshGrid::AddElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ, std::set<unsigned long> &raulElements) const
+{
+  if (_bCompact)
+  {
+    unsigned long ulIndex = (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX;
+    unsigned long ulBegin = _aulOffsets[ulIndex], ulEnd = _aulOffsets[ulIndex + 1];
+    if (ulBegin < ulEnd)
+      raulElements.insert(&_aulElements[0] + ulBegin, &_aulElements[0] + ulEnd);
+  }
+  else
+  {
+    const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
+    raulElements.insert(rclSet.begin(), rclSet.end());
+  }
+}
+
 // --------------------------------------------------------------
 
 inline void MeshFacetGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -503,13 +598,13 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
         {
           if ( rclFacet.IntersectBoundingBox( GetBoundBox(ulX, ulY, ulZ) ) )
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+            InsertElement(ulX, ulY, ulZ, ulFacetIndex);
         }
       }
     }
   }
   else
-    _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+    InsertElement(ulX1, ulY1, ulZ1, ulFacetIndex);
 
 #endif
 }
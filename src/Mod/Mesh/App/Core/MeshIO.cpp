@@ -37,6 +37,7 @@
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
 #include <Base/Placement.h>
+#include <Base/Tools.h>
 #include <zipios++/gzipoutputstream.h>
 
 #include <cmath>
@@ -44,6 +45,9 @@
 #include <iomanip>
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
 
 
 using namespace MeshCore;
@@ -107,6 +111,270 @@ int numDigits(int number)
     return digits;
 }
 
+// --------------------------------------------------------------
+
+namespace MeshCore {
+
+/** A range of complete lines of an ASCII file and the data read from them. */
+struct MeshTextChunk
+{
+    const char* begin;
+    const char* end;
+    std::vector<Base::Vector3f> points;
+    MeshFacetArray facets;
+    // the segments of an OBJ file are continued across the chunks
+    unsigned long segments;
+    bool hasData, firstIsFacet, lastIsVertex;
+};
+
+}
+
+static inline void skipBlanks(const char*& p, const char* end)
+{
+    while (p != end && Base::Tools::isBlank(*p))
+        ++p;
+}
+
+/** Reads three numbers that are preceded by white spaces. */
+static bool scanVector(const char*& p, const char* end, Base::Vector3f& v)
+{
+    double c[3];
+    for (int i = 0; i < 3; i++) {
+        const char* q = p;
+        skipBlanks(p, end);
+        if (p == q || !Base::Tools::scanNumber(p, end, c[i]))
+            return false;
+    }
+    v.Set((float)c[0], (float)c[1], (float)c[2]);
+    return true;
+}
+
+/** Reads an OBJ vertex index of the form i[/[t][/[n]]] that is preceded by white spaces. */
+static bool scanIndex(const char*& p, const char* end, unsigned long& index)
+{
+    const char* q = p;
+    skipBlanks(p, end);
+    if (p == q || p == end || *p < '0' || *p > '9')
+        return false;
+    index = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+        index = 10 * index + (*p - '0');
+    for (int i = 0; i < 2 && p != end && *p == '/'; i++) {
+        for (++p; p != end && *p >= '0' && *p <= '9'; ++p)
+            ;
+    }
+    return true;
+}
+
+/** Checks case-insensitively for a keyword that is followed by a white space or the line end. */
+static bool scanKeyword(const char*& p, const char* end, const char* keyword)
+{
+    const char* s = p;
+    skipBlanks(s, end);
+    for (; *keyword; ++keyword, ++s) {
+        if (s == end || tolower(*s) != *keyword)
+            return false;
+    }
+    if (s != end && !Base::Tools::isBlank(*s))
+        return false;
+    p = s;
+    return true;
+}
+
+static inline bool isLineEnd(const char* p, const char* end)
+{
+    skipBlanks(p, end);
+    return p == end;
+}
+
+/** Splits the data into chunks of complete lines. If \a keyword is given a chunk
+ * only starts with a line beginning with the keyword.
+ */
+static std::vector<MeshTextChunk> splitChunks(const char* data, std::size_t size, const char* keyword)
+{
+    std::vector<MeshTextChunk> chunks;
+    const char* end = data + size;
+    std::size_t chunkSize = std::max<std::size_t>(1024 * 1024,
+        size / (4 * std::max<int>(QThread::idealThreadCount(), 1)) + 1);
+    for (const char* begin = data; begin != end;) {
+        const char* stop = begin + std::min<std::size_t>(chunkSize, end - begin);
+        stop = std::find(stop, end, '\n');
+        if (stop != end)
+            ++stop;
+        while (keyword && stop != end) {
+            const char* eol = std::find(stop, end, '\n');
+            const char* p = stop;
+            if (scanKeyword(p, eol, keyword))
+                break;
+            stop = (eol == end) ? eol : eol + 1;
+        }
+
+        MeshTextChunk chunk;
+        chunk.begin = begin;
+        chunk.end = stop;
+        chunk.segments = 0;
+        chunk.hasData = chunk.firstIsFacet = chunk.lastIsVertex = false;
+        chunks.push_back(chunk);
+        begin = stop;
+    }
+
+    return chunks;
+}
+
+/** Reads the oriented facets of a chunk starting with a 'facet' line. */
+static void parseSTLChunk(MeshTextChunk& chunk)
+{
+    Base::Vector3f normal, corner[3];
+    int count = 0;
+    const char* p = chunk.begin;
+    while (p != chunk.end) {
+        const char* eol = std::find(p, chunk.end, '\n');
+
+        Base::Vector3f v;
+        if (scanKeyword(p, eol, "vertex")) {
+            if (scanVector(p, eol, v) && isLineEnd(p, eol)) {
+                corner[count++] = v;
+                if (count == 3) {
+                    // adjust circulation direction
+                    chunk.points.push_back(corner[0]);
+                    if ((((corner[1] - corner[0]) % (corner[2] - corner[0])) * normal) < 0.0f) {
+                        chunk.points.push_back(corner[2]);
+                        chunk.points.push_back(corner[1]);
+                    }
+                    else {
+                        chunk.points.push_back(corner[1]);
+                        chunk.points.push_back(corner[2]);
+                    }
+                    count = 0;
+                }
+            }
+        }
+        else if (scanKeyword(p, eol, "facet") && scanKeyword(p, eol, "normal")) {
+            if (scanVector(p, eol, v) && isLineEnd(p, eol))
+                normal = v;
+        }
+
+        p = (eol == chunk.end) ? eol : eol + 1;
+    }
+}
+
+/** Reads the vertices and the triangles or quads of an OBJ chunk. */
+static void parseOBJChunk(MeshTextChunk& chunk)
+{
+    bool readvertices = false;
+    MeshFacet item;
+    const char* p = chunk.begin;
+    while (p != chunk.end) {
+        const char* eol = std::find(p, chunk.end, '\n');
+
+        Base::Vector3f v;
+        unsigned long index[4];
+        if (scanKeyword(p, eol, "v")) {
+            // further values like colors are ignored
+            if (scanVector(p, eol, v)) {
+                readvertices = true;
+                chunk.points.push_back(v);
+                chunk.hasData = chunk.lastIsVertex = true;
+            }
+        }
+        else if (scanKeyword(p, eol, "f")) {
+            int count = 0;
+            while (count < 4 && scanIndex(p, eol, index[count]))
+                count++;
+            if (count >= 3 && isLineEnd(p, eol)) {
+                if (!chunk.hasData)
+                    chunk.firstIsFacet = true;
+                chunk.hasData = true;
+                chunk.lastIsVertex = false;
+
+                // starts a new segment
+                if (readvertices) {
+                    readvertices = false;
+                    chunk.segments++;
+                }
+
+                item.SetVertices(index[0]-1,index[1]-1,index[2]-1);
+                item.SetProperty(chunk.segments);
+                chunk.facets.push_back(item);
+
+                // 4-vertex face
+                if (count == 4) {
+                    item.SetVertices(index[2]-1,index[3]-1,index[0]-1);
+                    item.SetProperty(chunk.segments);
+                    chunk.facets.push_back(item);
+                }
+            }
+        }
+
+        p = (eol == chunk.end) ? eol : eol + 1;
+    }
+}
+
+static void parseChunks(std::vector<MeshTextChunk>& chunks, void (*parse)(MeshTextChunk&))
+{
+    if (chunks.size() > 1)
+        QtConcurrent::blockingMap(chunks, parse);
+    else if (chunks.size() == 1)
+        parse(chunks.front());
+}
+
+/** Reads the rest of a stream into memory. */
+static void readStream(std::istream& rstrIn, std::vector<char>& data)
+{
+    std::streambuf* buf = rstrIn.rdbuf();
+    if (!buf)
+        return;
+
+    std::streamoff pos = buf->pubseekoff(0, std::ios::cur, std::ios::in);
+    std::streamoff end = buf->pubseekoff(0, std::ios::end, std::ios::in);
+    if (pos >= 0 && end >= pos) {
+        buf->pubseekoff(pos, std::ios::beg, std::ios::in);
+        data.resize((std::size_t)(end - pos));
+        if (!data.empty())
+            data.resize((std::size_t)buf->sgetn(&data[0], end - pos));
+    }
+    else {
+        // not a seekable stream
+        char block[65536];
+        std::streamsize count;
+        while ((count = buf->sgetn(block, sizeof(block))) > 0)
+            data.insert(data.end(), block, block + count);
+    }
+}
+
+/** Maps the whole file into memory, returns 0 if this isn't possible. */
+static const char* mapFile(QFile& file)
+{
+    if (!file.open(QIODevice::ReadOnly) || file.size() <= 0)
+        return 0;
+    return reinterpret_cast<const char*>(file.map(0, file.size()));
+}
+
+/** Checks the bytes behind the 80 byte header of an STL file for keywords of the ASCII format. */
+static bool hasAsciiSTLKeywords(char* szBuf)
+{
+    upper(szBuf);
+    return (strstr(szBuf, "SOLID") != NULL)  || (strstr(szBuf, "FACET") != NULL)    || (strstr(szBuf, "NORMAL") != NULL) ||
+           (strstr(szBuf, "VERTEX") != NULL) || (strstr(szBuf, "ENDFACET") != NULL) || (strstr(szBuf, "ENDLOOP") != NULL);
+}
+
+/** Checks whether the data of an STL file is in ASCII format, see MeshInput::LoadSTL(). */
+static bool isAsciiSTL(const char* data, std::size_t size)
+{
+    char szBuf[200];
+    uint32_t ulCt, ulBytes=50;
+    if (size < 84)
+        return false;
+    memcpy(&ulCt, data + 80, sizeof(ulCt));
+    if (ulCt > 1)
+        ulBytes = 100;
+    if (size < 84 + ulBytes)
+        return false;
+    memcpy(szBuf, data + 84, ulBytes);
+    szBuf[ulBytes] = 0;
+    return hasAsciiSTLKeywords(szBuf);
+}
+
 /* Usage by CMeshNastran, CMeshCadmouldFE. Added by Sergey Sukhov (26.04.2002)*/
 struct NODE {float x, y, z;};
 struct TRIA {int iV[3];};
@@ -133,7 +401,13 @@ bool MeshInput::LoadAny(const char* FileName)
         // read file
         bool ok = false;
         if (fi.hasExtension("stl") || fi.hasExtension("ast")) {
-            ok = LoadSTL(str);
+            // ASCII files are parsed in parallel directly from the mapped file
+            QFile file(QString::fromUtf8(fi.filePath().c_str()));
+            const char* data = mapFile(file);
+            if (data && isAsciiSTL(data, (std::size_t)file.size()))
+                ok = LoadAsciiSTL(data, (std::size_t)file.size());
+            else
+                ok = LoadSTL(str);
         }
         else if (fi.hasExtension("iv")) {
             ok = LoadInventor( str );
@@ -144,7 +418,9 @@ bool MeshInput::LoadAny(const char* FileName)
             ok = LoadNastran( str );
         }
         else if (fi.hasExtension("obj")) {
-            ok = LoadOBJ( str );
+            QFile file(QString::fromUtf8(fi.filePath().c_str()));
+            const char* data = mapFile(file);
+            ok = data ? LoadOBJ(data, (std::size_t)file.size()) : LoadOBJ( str );
         }
         else if (fi.hasExtension("off")) {
             ok = LoadOFF( str );
@@ -187,11 +463,9 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
     if (!rstrIn.read(szBuf, ulBytes))
         return (ulCt==0);
     szBuf[ulBytes] = 0;
-    upper(szBuf);
 
     try {
-        if ((strstr(szBuf, "SOLID") == NULL)  && (strstr(szBuf, "FACET") == NULL)    && (strstr(szBuf, "NORMAL") == NULL) &&
-            (strstr(szBuf, "VERTEX") == NULL) && (strstr(szBuf, "ENDFACET") == NULL) && (strstr(szBuf, "ENDLOOP") == NULL)) {
+        if (!hasAsciiSTLKeywords(szBuf)) {
             // probably binary STL
             buf->pubseekoff(0, std::ios::beg, std::ios::in);
             return LoadBinarySTL(rstrIn);
@@ -225,82 +499,50 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
 /** Loads an OBJ file. */
 bool MeshInput::LoadOBJ (std::istream &rstrIn)
 {
-    boost::regex rx_p("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f3("^f\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*\\s*$");
-    boost::regex rx_f4("^f\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*\\s*$");
-    boost::cmatch what;
-
-    unsigned long segment=0;
-    MeshPointArray meshPoints;
-    MeshFacetArray meshFacets;
-
-    std::string line;
-    float fX, fY, fZ;
-    unsigned int  i1=1,i2=1,i3=1,i4=1;
-    MeshGeomFacet clFacet;
-    MeshFacet item;
-
     if (!rstrIn || rstrIn.bad() == true)
         return false;
 
-    std::streambuf* buf = rstrIn.rdbuf();
-    if (!buf)
-        return false;
-
-    bool readvertices=false;
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = tolower(*it);
-        if (boost::regex_match(line.c_str(), what, rx_p)) {
-            readvertices = true;
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f3)) {
-            // starts a new segment
-            if (readvertices) {
-                readvertices = false;
-                segment++;
-            }
+    std::vector<char> data;
+    readStream(rstrIn, data);
+    return LoadOBJ(data.empty() ? 0 : &data[0], data.size());
+}
 
-            // 3-vertex face
-            i1 = std::atoi(what[1].first);
-            i2 = std::atoi(what[2].first);
-            i3 = std::atoi(what[3].first);
-            item.SetVertices(i1-1,i2-1,i3-1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f4)) {
-            // starts a new segment
-            if (readvertices) {
-                readvertices = false;
-                segment++;
-            }
+/** Loads an OBJ file from memory. */
+bool MeshInput::LoadOBJ (const char* data, std::size_t size)
+{
+    std::vector<MeshTextChunk> chunks = splitChunks(data, size, 0);
+    parseChunks(chunks, parseOBJChunk);
 
-            // 4-vertex face
-            i1 = std::atoi(what[1].first);
-            i2 = std::atoi(what[2].first);
-            i3 = std::atoi(what[3].first);
-            i4 = std::atoi(what[4].first);
+    unsigned long countPoints = 0, countFacets = 0;
+    for (std::vector<MeshTextChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        countPoints += it->points.size();
+        countFacets += it->facets.size();
+    }
 
-            item.SetVertices(i1-1,i2-1,i3-1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
+    MeshPointArray meshPoints;
+    MeshFacetArray meshFacets;
+    meshPoints.reserve(countPoints);
+    meshFacets.reserve(countFacets);
 
-            item.SetVertices(i3-1,i4-1,i1-1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
+    // a new segment starts with the first facet after vertices, which may lie in a previous chunk
+    unsigned long segment=0;
+    bool readvertices=false;
+    for (std::vector<MeshTextChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        unsigned long offset = segment;
+        if (it->firstIsFacet && readvertices)
+            offset++;
+        for (std::vector<Base::Vector3f>::iterator jt = it->points.begin(); jt != it->points.end(); ++jt)
+            meshPoints.push_back(MeshPoint(*jt));
+        for (MeshFacetArray::_TIterator jt = it->facets.begin(); jt != it->facets.end(); ++jt) {
+            jt->_ulProp += offset;
+            meshFacets.push_back(*jt);
         }
+        segment = offset + it->segments;
+        if (it->hasData)
+            readvertices = it->lastIsVertex;
+
+        std::vector<Base::Vector3f>().swap(it->points);
+        MeshFacetArray().swap(it->facets);
     }
 
     this->_rclMesh.Clear(); // remove all data before
@@ -788,67 +1030,30 @@ bool MeshInput::LoadMeshNode (std::istream &rstrIn)
 /** Loads an ASCII STL file. */
 bool MeshInput::LoadAsciiSTL (std::istream &rstrIn)
 {
-    boost::regex rx_p("^\\s*VERTEX\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f("^\\s*FACET\\s+NORMAL\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::cmatch what;
-
-    std::string line;
-    float fX, fY, fZ;
-    unsigned long ulVertexCt, ulFacetCt=0;
-    MeshGeomFacet clFacet;
-
     if (!rstrIn || rstrIn.bad() == true)
         return false;
 
-    std::streamoff ulSize = 0;
-    std::streambuf* buf = rstrIn.rdbuf();
-    ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
-    ulSize -= 20;
+    std::vector<char> data;
+    readStream(rstrIn, data);
+    return LoadAsciiSTL(data.empty() ? 0 : &data[0], data.size());
+}
 
-    // count facets
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (line.find("ENDFACET") != std::string::npos)
-            ulFacetCt++;
-        // prevent from reading EOF (as I don't know how to reread the file then)
-        if (rstrIn.tellg() > ulSize)
-            break;
-        else if (line.find("ENDSOLID") != std::string::npos)
-            break;
-    }
+/** Loads an ASCII STL file from memory. */
+bool MeshInput::LoadAsciiSTL (const char* data, std::size_t size)
+{
+    // a facet must not be split up
+    std::vector<MeshTextChunk> chunks = splitChunks(data, size, "facet");
+    parseChunks(chunks, parseSTLChunk);
 
-    // restart from the beginning
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
+    unsigned long ulFacetCt = 0;
+    for (std::vector<MeshTextChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        ulFacetCt += it->points.size() / 3;
 
-    MeshBuilder builder(this->_rclMesh);
+    MeshFastBuilder builder(this->_rclMesh);
     builder.Initialize(ulFacetCt);
-
-    ulVertexCt = 0;
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (boost::regex_match(line.c_str(), what, rx_f)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet.SetNormal(Base::Vector3f(fX, fY, fZ));
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet._aclPoints[ulVertexCt++].Set(fX, fY, fZ);
-            if (ulVertexCt == 3) {
-                ulVertexCt = 0;
-                builder.AddFacet(clFacet);
-            }
-        }
+    for (std::vector<MeshTextChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        builder.AddFacets(it->points);
+        std::vector<Base::Vector3f>().swap(it->points);
     }
 
     builder.Finish();
@@ -891,7 +1096,7 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     if (ulCt > ulFac)
         return false;// not a valid STL file
  
-    MeshBuilder builder(this->_rclMesh);
+    MeshFastBuilder builder(this->_rclMesh);
     builder.Initialize(ulCt);
 
     for (uint32_t i = 0; i < ulCt; i++) {
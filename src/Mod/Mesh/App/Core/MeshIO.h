@@ -90,10 +90,14 @@ public:
     bool LoadSTL (std::istream &rstrIn);
     /** Loads an ASCII STL file. */
     bool LoadAsciiSTL (std::istream &rstrIn);
+    /** Loads an ASCII STL file from memory. */
+    bool LoadAsciiSTL (const char* data, std::size_t size);
     /** Loads a binary STL file. */
     bool LoadBinarySTL (std::istream &rstrIn);
     /** Loads an OBJ Mesh file. */
     bool LoadOBJ (std::istream &rstrIn);
+    /** Loads an OBJ Mesh file from memory. */
+    bool LoadOBJ (const char* data, std::size_t size);
     /** Loads an OFF Mesh file. */
     bool LoadOFF (std::istream &rstrIn);
     /** Loads a PLY Mesh file. */
@@ -70,12 +70,10 @@ MeshKernel& MeshKernel::operator = (const MeshKernel &rclMesh)
 
 MeshKernel& MeshKernel::operator = (const std::vector<MeshGeomFacet> &rclFAry)
 {
-    MeshBuilder builder(*this);
+    // welds the points and builds the neighbourhood in parallel
+    MeshFastBuilder builder(*this);
     builder.Initialize(rclFAry.size());
-
-    for (std::vector<MeshGeomFacet>::const_iterator it = rclFAry.begin(); it != rclFAry.end(); it++)
-        builder.AddFacet(*it);
-
+    builder.AddFacets(rclFAry);
     builder.Finish();
 
     return *this;
@@ -756,7 +754,14 @@ MeshFacetArray MeshKernel::GetFacets(const std::vector<unsigned long>& indices)
     return ary;
 }
 
-void MeshKernel::Write (std::ostream &rclOut) const 
+// Versions of the binary format: the compact format doesn't store the
+// neighbourhood of the facets which is then rebuilt on reading.
+static const uint32_t MeshFormatVersion        = 0x010000;
+static const uint32_t MeshFormatVersionCompact = 0x010001;
+// Number of elements that are converted at once
+static const std::size_t MeshBlockSize         = 65536;
+
+void MeshKernel::Write (std::ostream &rclOut, bool neighbours) const 
 {
     if (!rclOut || rclOut.bad())
         return;
@@ -765,7 +770,7 @@ void MeshKernel::Write (std::ostream &rclOut) const
 
     // Write a header with a "magic number" and a version
     str << (uint32_t)0xA0B0C0D0;
-    str << (uint32_t)0x010000;
+    str << (neighbours ? MeshFormatVersion : MeshFormatVersionCompact);
 
     char szInfo[257]; // needs an additional byte for zero-termination
     strcpy(szInfo, "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-"
@@ -777,18 +782,38 @@ void MeshKernel::Write (std::ostream &rclOut) const
     // write the number of points and facets
     str << (uint32_t)CountPoints() << (uint32_t)CountFacets();
 
-    // write the data
-    for (MeshPointArray::_TConstIterator it = _aclPointArray.begin(); it != _aclPointArray.end(); ++it) {
-        str << it->x << it->y << it->z;
+    // write the data in blocks, the stream uses the native byte order
+    std::vector<float> coords;
+    coords.reserve(3 * MeshBlockSize);
+    for (std::size_t i = 0; i < _aclPointArray.size(); i += MeshBlockSize) {
+        std::size_t n = std::min<std::size_t>(MeshBlockSize, _aclPointArray.size() - i);
+        coords.clear();
+        for (std::size_t j = i; j < i + n; j++) {
+            const MeshPoint& p = _aclPointArray[j];
+            coords.push_back(p.x);
+            coords.push_back(p.y);
+            coords.push_back(p.z);
+        }
+        rclOut.write((const char*)&(coords[0]), coords.size() * sizeof(float));
     }
 
-    for (MeshFacetArray::_TConstIterator it = _aclFacetArray.begin(); it != _aclFacetArray.end(); ++it) {
-        str << (uint32_t)it->_aulPoints[0] 
-            << (uint32_t)it->_aulPoints[1] 
-            << (uint32_t)it->_aulPoints[2];
-        str << (uint32_t)it->_aulNeighbours[0] 
-            << (uint32_t)it->_aulNeighbours[1] 
-            << (uint32_t)it->_aulNeighbours[2];
+    std::vector<uint32_t> indices;
+    indices.reserve(6 * MeshBlockSize);
+    for (std::size_t i = 0; i < _aclFacetArray.size(); i += MeshBlockSize) {
+        std::size_t n = std::min<std::size_t>(MeshBlockSize, _aclFacetArray.size() - i);
+        indices.clear();
+        for (std::size_t j = i; j < i + n; j++) {
+            const MeshFacet& f = _aclFacetArray[j];
+            indices.push_back((uint32_t)f._aulPoints[0]);
+            indices.push_back((uint32_t)f._aulPoints[1]);
+            indices.push_back((uint32_t)f._aulPoints[2]);
+            if (neighbours) {
+                indices.push_back((uint32_t)f._aulNeighbours[0]);
+                indices.push_back((uint32_t)f._aulNeighbours[1]);
+                indices.push_back((uint32_t)f._aulNeighbours[2]);
+            }
+        }
+        rclOut.write((const char*)&(indices[0]), indices.size() * sizeof(uint32_t));
     }
 
     str << _clBoundBox.MinX << _clBoundBox.MaxX;
@@ -796,6 +821,20 @@ void MeshKernel::Write (std::ostream &rclOut) const
     str << _clBoundBox.MinZ << _clBoundBox.MaxZ;
 }
 
+/** Reads \a count values and converts them to the native byte order. */
+template <class T>
+static void ReadBlock(std::istream& rclIn, std::vector<T>& block, std::size_t count, bool swap)
+{
+    block.resize(count);
+    rclIn.read((char*)&(block[0]), count * sizeof(T));
+    if (rclIn.gcount() != (std::streamsize)(count * sizeof(T)))
+        throw Base::Exception("Reading from stream failed");
+    if (swap) {
+        for (typename std::vector<T>::iterator it = block.begin(); it != block.end(); ++it)
+            Base::SwapEndian(*it);
+    }
+}
+
 void MeshKernel::Read (std::istream &rclIn)
 {
     if (!rclIn || rclIn.bad())
@@ -812,11 +851,16 @@ void MeshKernel::Read (std::istream &rclIn)
 
     // is it the new or old format?
     bool new_format = false;
-    if (magic == 0xA0B0C0D0 && version == 0x010000) {
+    bool swap = false;
+    if (magic == 0xA0B0C0D0 && (version == MeshFormatVersion ||
+                                version == MeshFormatVersionCompact)) {
         new_format = true;
     }
-    else if (swap_magic == 0xA0B0C0D0 && swap_version == 0x010000) {
+    else if (swap_magic == 0xA0B0C0D0 && (swap_version == MeshFormatVersion ||
+                                          swap_version == MeshFormatVersionCompact)) {
         new_format = true;
+        swap = true;
+        version = swap_version;
         str.setByteOrder(Base::Stream::BigEndian);
     }
 
@@ -828,28 +872,44 @@ void MeshKernel::Read (std::istream &rclIn)
         uint32_t uCtPts=0, uCtFts=0;
         str >> uCtPts >> uCtFts;
 
+        bool neighbours = (version == MeshFormatVersion);
+        int stride = neighbours ? 6 : 3;
+
         try {
-            // read the data
+            // read the data in blocks
             MeshPointArray pointArray;
             pointArray.resize(uCtPts);
-            for (MeshPointArray::_TIterator it = pointArray.begin(); it != pointArray.end(); ++it) {
-                str >> it->x >> it->y >> it->z;
+            std::vector<float> coords;
+            for (std::size_t i = 0; i < uCtPts; i += MeshBlockSize) {
+                std::size_t n = std::min<std::size_t>(MeshBlockSize, uCtPts - i);
+                ReadBlock(rclIn, coords, 3 * n, swap);
+                for (std::size_t j = 0; j < n; j++) {
+                    MeshPoint& p = pointArray[i + j];
+                    p.x = coords[3*j];
+                    p.y = coords[3*j+1];
+                    p.z = coords[3*j+2];
+                }
             }
-          
+
             MeshFacetArray facetArray;
             facetArray.resize(uCtFts);
-
-            uint32_t v1, v2, v3;
-            for (MeshFacetArray::_TIterator it = facetArray.begin(); it != facetArray.end(); ++it) {
-                str >> v1 >> v2 >> v3;
-                it->_aulPoints[0] = v1;
-                it->_aulPoints[1] = v2;
-                it->_aulPoints[2] = v3;
-
-                str >> v1 >> v2 >> v3;
-                it->_aulNeighbours[0] = v1;
-                it->_aulNeighbours[1] = v2;
-                it->_aulNeighbours[2] = v3;
+            std::vector<uint32_t> indices;
+            for (std::size_t i = 0; i < uCtFts; i += MeshBlockSize) {
+                std::size_t n = std::min<std::size_t>(MeshBlockSize, uCtFts - i);
+                ReadBlock(rclIn, indices, stride * n, swap);
+                for (std::size_t j = 0; j < n; j++) {
+                    MeshFacet& f = facetArray[i + j];
+                    const uint32_t* v = &(indices[stride * j]);
+                    f._aulPoints[0] = v[0];
+                    f._aulPoints[1] = v[1];
+                    f._aulPoints[2] = v[2];
+                    if (neighbours) {
+                        // an open edge is stored with 32 bits
+                        f._aulNeighbours[0] = v[3] == 0xFFFFFFFF ? ULONG_MAX : v[3];
+                        f._aulNeighbours[1] = v[4] == 0xFFFFFFFF ? ULONG_MAX : v[4];
+                        f._aulNeighbours[2] = v[5] == 0xFFFFFFFF ? ULONG_MAX : v[5];
+                    }
+                }
             }
 
             str >> _clBoundBox.MinX >> _clBoundBox.MaxX;
@@ -864,6 +924,9 @@ void MeshKernel::Read (std::istream &rclIn)
             // Special handling of std::length_error
             throw Base::Exception("Reading from stream failed");
         }
+
+        if (!neighbours)
+            RebuildNeighbours();
     }
     else {
         // The old format
@@ -900,9 +963,11 @@ void MeshKernel::Transform (const Base::Matrix4D &rclMat)
     }
 }
 
-void MeshKernel::Smooth(int iterations, float stepsize)
+void MeshKernel::Smooth(int iterations, float stepsize, bool parallel)
 {
-    LaplaceSmoothing(*this).Smooth(iterations);
+    LaplaceSmoothing smooth(*this);
+    smooth.SetParallel(parallel);
+    smooth.Smooth(iterations);
 }
 
 void MeshKernel::RecalcBoundBox (void)
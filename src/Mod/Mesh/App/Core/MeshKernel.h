@@ -74,8 +74,11 @@ public:
 
     /** @name I/O methods */
     //@{
-    /// Binary streaming of data
-    void Write (std::ostream &rclOut) const;
+    /** Binary streaming of data. Without \a neighbours the neighbour indices
+     * of the facets are not written but rebuilt on reading. Such a stream
+     * cannot be read by older versions.
+     */
+    void Write (std::ostream &rclOut, bool neighbours = true) const;
     void Read (std::istream &rclIn);
     //@}
 
@@ -385,8 +388,9 @@ public:
     inline void SetPoint (unsigned long ulPtIndex, const Base::Vector3f &rPoint);
     /** Sets the point at the given index to the new \a rPoint. */
     inline void SetPoint (unsigned long ulPtIndex, float x, float y, float z);
-    /** Smothes the mesh kernel. */
-    void Smooth(int iterations, float d_max);
+    /** Smothes the mesh kernel. If \a parallel is true the points are updated double-buffered
+     * by several threads, see AbstractSmoothing::SetParallel(). */
+    void Smooth(int iterations, float d_max, bool parallel = false);
     /**
      * CheckFacets() is invoked within this method and all found facets get deleted from the mesh structure. 
      * The facets to be deleted are returned with their geometric reprsentation.
@@ -23,8 +23,13 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
 #endif
 
+#include <boost/bind.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include "Smoothing.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
@@ -35,8 +40,27 @@
 
 using namespace MeshCore;
 
+static std::vector<unsigned long> UniqueIndices(const std::vector<unsigned long>& point_indices)
+{
+    std::vector<unsigned long> indices(point_indices);
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    return indices;
+}
+
+static std::vector<double> TaubinSteps(unsigned int iterations, double lambda, double micro)
+{
+    std::vector<double> steps;
+    steps.reserve(2*iterations);
+    for (unsigned int i=0; i<iterations; i++) {
+        steps.push_back(lambda);
+        steps.push_back(-(lambda+micro));
+    }
+    return steps;
+}
+
 
-AbstractSmoothing::AbstractSmoothing(MeshKernel& m) : kernel(m)
+AbstractSmoothing::AbstractSmoothing(MeshKernel& m) : kernel(m), parallel(false)
 {
 }
 
@@ -50,6 +74,18 @@ void AbstractSmoothing::initialize(Component comp, Continuity cont)
     this->continuity = cont;
 }
 
+void AbstractSmoothing::SplitChunks(unsigned long count, std::vector<Chunk>& chunks) const
+{
+    unsigned long size = std::max<unsigned long>(4096,
+        count / (4 * std::max<unsigned long>(QThread::idealThreadCount(), 1)) + 1);
+    for (unsigned long i = 0; i < count; i += size) {
+        Chunk chunk;
+        chunk.begin = i;
+        chunk.end = std::min<unsigned long>(i + size, count);
+        chunks.push_back(chunk);
+    }
+}
+
 PlaneFitSmoothing::PlaneFitSmoothing(MeshKernel& m)
   : AbstractSmoothing(m)
 {
@@ -61,11 +97,16 @@ PlaneFitSmoothing::~PlaneFitSmoothing()
 
 void PlaneFitSmoothing::Smooth(unsigned int iterations)
 {
+    if (parallel) {
+        SmoothParallel(iterations, 0);
+        return;
+    }
+
     MeshCore::MeshPoint center;
     MeshCore::MeshPointArray PointArray = kernel.GetPoints();
 
     MeshCore::MeshPointIterator v_it(kernel);
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
     MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
 
     for (unsigned int i=0; i<iterations; i++) {
@@ -74,11 +115,11 @@ void PlaneFitSmoothing::Smooth(unsigned int iterations)
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshIndexRange cv = vv_it[v_it.Position()];
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshIndexRange::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -114,11 +155,18 @@ void PlaneFitSmoothing::Smooth(unsigned int iterations)
 
 void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
+    if (parallel) {
+        // each point must be written by one thread only
+        std::vector<unsigned long> indices = UniqueIndices(point_indices);
+        SmoothParallel(iterations, &indices);
+        return;
+    }
+
     MeshCore::MeshPoint center;
     MeshCore::MeshPointArray PointArray = kernel.GetPoints();
 
     MeshCore::MeshPointIterator v_it(kernel);
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
     MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
 
     for (unsigned int i=0; i<iterations; i++) {
@@ -128,11 +176,11 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshIndexRange cv = vv_it[v_it.Position()];
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshIndexRange::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -166,6 +214,83 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
     }
 }
 
+void PlaneFitSmoothing::SmoothParallel(unsigned int iterations, const std::vector<unsigned long>* indices)
+{
+    const MeshCore::MeshPointArray& points = kernel.GetPoints();
+    std::vector<Base::Vector3f> source(points.begin(), points.end());
+    std::vector<Base::Vector3f> target(source);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
+
+    std::vector<Chunk> chunks;
+    SplitChunks(indices ? indices->size() : source.size(), chunks);
+
+    Step step;
+    step.vv = &vv_it;
+    step.vf = 0;
+    step.indices = indices;
+    step.stepsize = 0.0;
+    for (unsigned int i=0; i<iterations; i++) {
+        step.source = &source;
+        step.target = &target;
+        if (chunks.size() > 1)
+            QtConcurrent::blockingMap(chunks, boost::bind(&PlaneFitSmoothing::PlaneFitChunk, this, boost::cref(step), _1));
+        else if (chunks.size() == 1)
+            PlaneFitChunk(step, chunks.front());
+        source.swap(target);
+    }
+
+    // the points that were not smoothed are unchanged in both buffers
+    unsigned long count = kernel.CountPoints();
+    for (unsigned long idx = 0; idx < count; idx++) {
+        kernel.SetPoint(idx, source[idx]);
+    }
+}
+
+void PlaneFitSmoothing::PlaneFitChunk(const Step& step, Chunk& chunk) const
+{
+    const std::vector<Base::Vector3f>& source = *step.source;
+    std::vector<Base::Vector3f>& target = *step.target;
+
+    Base::Vector3f center, N, L;
+    for (unsigned long i = chunk.begin; i < chunk.end; i++) {
+        unsigned long pos = step.indices ? (*step.indices)[i] : i;
+        const Base::Vector3f& v = source[pos];
+        MeshIndexRange cv = (*step.vv)[pos];
+        if (cv.size() < 3) {
+            target[pos] = v;
+            continue;
+        }
+
+        MeshCore::PlaneFit pf;
+        pf.AddPoint(v);
+        center = v;
+        MeshIndexRange::const_iterator cv_it;
+        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
+            pf.AddPoint(source[*cv_it]);
+            center += source[*cv_it];
+        }
+
+        float scale = 1.0f/((float)cv.size()+1.0f);
+        center.Scale(scale,scale,scale);
+
+        // get the mean plane of the current vertex with the surrounding vertices
+        pf.Fit();
+        N = pf.GetNormal();
+        N.Normalize();
+
+        // look in which direction we should move the vertex
+        L.Set(v.x - center.x, v.y - center.y, v.z - center.z);
+        if (N*L < 0.0)
+            N.Scale(-1.0, -1.0, -1.0);
+
+        // maximum value to move is distance to mean plane
+        float d = std::min<float>((float)fabs(this->tolerance),(float)fabs(N*L));
+        N.Scale(d,d,d);
+
+        target[pos].Set(v.x - N.x, v.y - N.y, v.z - N.z);
+    }
+}
+
 LaplaceSmoothing::LaplaceSmoothing(MeshKernel& m)
   : AbstractSmoothing(m), lambda(0.6307)
 {
@@ -175,8 +300,8 @@ LaplaceSmoothing::~LaplaceSmoothing()
 {
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize)
+void LaplaceSmoothing::Umbrella(const MeshCompactPointToPoints& vv_it,
+                                const MeshCompactPointToFacets& vf_it, double stepsize)
 {
     const MeshCore::MeshPointArray& points = kernel.GetPoints();
     MeshCore::MeshPointArray::_TConstIterator v_it,
@@ -184,7 +309,7 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
 
     unsigned long pos = 0;
     for (v_it = points.begin(); v_it != v_end; ++v_it,++pos) {
-        const std::set<unsigned long>& cv = vv_it[pos];
+        MeshIndexRange cv = vv_it[pos];
         if (cv.size() < 3)
             continue;
         if (cv.size() != vf_it[pos].size()) {
@@ -197,7 +322,7 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
         w=1.0/double(n_count);
 
         double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
+        MeshIndexRange::const_iterator cv_it;
         for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
             delx += w*((v_beg[*cv_it]).x-v_it->x);
             dely += w*((v_beg[*cv_it]).y-v_it->y);
@@ -211,15 +336,15 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
     }
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize,
+void LaplaceSmoothing::Umbrella(const MeshCompactPointToPoints& vv_it,
+                                const MeshCompactPointToFacets& vf_it, double stepsize,
                                 const std::vector<unsigned long>& point_indices)
 {
     const MeshCore::MeshPointArray& points = kernel.GetPoints();
     MeshCore::MeshPointArray::_TConstIterator v_beg = points.begin();
 
     for (std::vector<unsigned long>::const_iterator pos = point_indices.begin(); pos != point_indices.end(); ++pos) {
-        const std::set<unsigned long>& cv = vv_it[*pos];
+        MeshIndexRange cv = vv_it[*pos];
         if (cv.size() < 3)
             continue;
         if (cv.size() != vf_it[*pos].size()) {
@@ -232,7 +357,7 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
         w=1.0/double(n_count);
 
         double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
+        MeshIndexRange::const_iterator cv_it;
         for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
             delx += w*((v_beg[*cv_it]).x-(v_beg[*pos]).x);
             dely += w*((v_beg[*cv_it]).y-(v_beg[*pos]).y);
@@ -246,10 +371,84 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
     }
 }
 
+void LaplaceSmoothing::UmbrellaParallel(const MeshCompactPointToPoints& vv_it,
+                                        const MeshCompactPointToFacets& vf_it,
+                                        const std::vector<double>& steps,
+                                        const std::vector<unsigned long>* indices)
+{
+    const MeshCore::MeshPointArray& points = kernel.GetPoints();
+    std::vector<Base::Vector3f> source(points.begin(), points.end());
+    std::vector<Base::Vector3f> target(source);
+
+    std::vector<Chunk> chunks;
+    SplitChunks(indices ? indices->size() : source.size(), chunks);
+
+    Step step;
+    step.vv = &vv_it;
+    step.vf = &vf_it;
+    step.indices = indices;
+    for (std::vector<double>::const_iterator it = steps.begin(); it != steps.end(); ++it) {
+        step.source = &source;
+        step.target = &target;
+        step.stepsize = *it;
+        if (chunks.size() > 1)
+            QtConcurrent::blockingMap(chunks, boost::bind(&LaplaceSmoothing::UmbrellaChunk, this, boost::cref(step), _1));
+        else if (chunks.size() == 1)
+            UmbrellaChunk(step, chunks.front());
+        source.swap(target);
+    }
+
+    // the points that were not smoothed are unchanged in both buffers
+    unsigned long count = kernel.CountPoints();
+    for (unsigned long idx = 0; idx < count; idx++) {
+        kernel.SetPoint(idx, source[idx]);
+    }
+}
+
+void LaplaceSmoothing::UmbrellaChunk(const Step& step, Chunk& chunk) const
+{
+    const std::vector<Base::Vector3f>& source = *step.source;
+    std::vector<Base::Vector3f>& target = *step.target;
+
+    for (unsigned long i = chunk.begin; i < chunk.end; i++) {
+        unsigned long pos = step.indices ? (*step.indices)[i] : i;
+        const Base::Vector3f& v = source[pos];
+        MeshIndexRange cv = (*step.vv)[pos];
+        if (cv.size() < 3 || cv.size() != (*step.vf)[pos].size()) {
+            // do nothing for border points
+            target[pos] = v;
+            continue;
+        }
+
+        // sum up the neighbours and scale only once
+        double sumx=0.0,sumy=0.0,sumz=0.0;
+        MeshIndexRange::const_iterator cv_it;
+        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
+            const Base::Vector3f& n = source[*cv_it];
+            sumx += n.x;
+            sumy += n.y;
+            sumz += n.z;
+        }
+
+        double w = 1.0/double(cv.size());
+        double delx = sumx*w - v.x;
+        double dely = sumy*w - v.y;
+        double delz = sumz*w - v.z;
+        target[pos].Set((float)(v.x+step.stepsize*delx),
+                        (float)(v.y+step.stepsize*dely),
+                        (float)(v.z+step.stepsize*delz));
+    }
+}
+
 void LaplaceSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
+    MeshCore::MeshCompactPointToFacets vf_it(kernel);
+
+    if (parallel) {
+        UmbrellaParallel(vv_it, vf_it, std::vector<double>(iterations, lambda), 0);
+        return;
+    }
 
     for (unsigned int i=0; i<iterations; i++) {
         Umbrella(vv_it, vf_it, lambda);
@@ -258,8 +457,15 @@ void LaplaceSmoothing::Smooth(unsigned int iterations)
 
 void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
+    MeshCore::MeshCompactPointToFacets vf_it(kernel);
+
+    if (parallel) {
+        // each point must be written by one thread only
+        std::vector<unsigned long> indices = UniqueIndices(point_indices);
+        UmbrellaParallel(vv_it, vf_it, std::vector<double>(iterations, lambda), &indices);
+        return;
+    }
 
     for (unsigned int i=0; i<iterations; i++) {
         Umbrella(vv_it, vf_it, lambda, point_indices);
@@ -278,11 +484,16 @@ TaubinSmoothing::~TaubinSmoothing()
 void TaubinSmoothing::Smooth(unsigned int iterations)
 {
     MeshCore::MeshPointArray::_TConstIterator v_it;
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
+    MeshCore::MeshCompactPointToFacets vf_it(kernel);
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
+    if (parallel) {
+        UmbrellaParallel(vv_it, vf_it, TaubinSteps(iterations, lambda, micro), 0);
+        return;
+    }
+
     for (unsigned int i=0; i<iterations; i++) {
         Umbrella(vv_it, vf_it, lambda);
         Umbrella(vv_it, vf_it, -(lambda+micro));
@@ -292,11 +503,18 @@ void TaubinSmoothing::Smooth(unsigned int iterations)
 void TaubinSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
     MeshCore::MeshPointArray::_TConstIterator v_it;
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel);
+    MeshCore::MeshCompactPointToFacets vf_it(kernel);
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
+    if (parallel) {
+        // each point must be written by one thread only
+        std::vector<unsigned long> indices = UniqueIndices(point_indices);
+        UmbrellaParallel(vv_it, vf_it, TaubinSteps(iterations, lambda, micro), &indices);
+        return;
+    }
+
     for (unsigned int i=0; i<iterations; i++) {
         Umbrella(vv_it, vf_it, lambda, point_indices);
         Umbrella(vv_it, vf_it, -(lambda+micro), point_indices);
@@ -25,12 +25,13 @@
 #define MESH_SMOOTHING_H
 
 #include <vector>
+#include <Base/Vector3D.h>
 
 namespace MeshCore
 {
 class MeshKernel;
-class MeshRefPointToPoints;
-class MeshRefPointToFacets;
+class MeshCompactPointToPoints;
+class MeshCompactPointToFacets;
 
 /** Base class for smoothing algorithms. */
 class MeshExport AbstractSmoothing
@@ -56,12 +57,39 @@ public:
     virtual void Smooth(unsigned int) = 0;
     virtual void SmoothPoints(unsigned int, const std::vector<unsigned long>&) = 0;
 
+    /** Switches between the serial in-place update (the default) and the parallel update.
+     * In the parallel mode each iteration computes all vertices from the positions of the
+     * previous iteration and writes them to a second buffer (Jacobi-style). Ranges of vertices
+     * are handled by several threads and the result does not depend on the number of threads.
+     */
+    void SetParallel(bool on) { parallel = on; }
+    bool IsParallel() const { return parallel; }
+
+protected:
+    /** A range of vertices, or of entries in a list of vertex indices, handled by one thread. */
+    struct Chunk
+    {
+        unsigned long begin, end;
+    };
+    /** Input and output of one parallel smoothing step. */
+    struct Step
+    {
+        const MeshCompactPointToPoints* vv;
+        const MeshCompactPointToFacets* vf;
+        const std::vector<unsigned long>* indices; ///< the points to smooth, all points if null
+        const std::vector<Base::Vector3f>* source;
+        std::vector<Base::Vector3f>* target;
+        double stepsize;
+    };
+    void SplitChunks(unsigned long count, std::vector<Chunk>&) const;
+
 protected:
     MeshKernel& kernel;
 
     float tolerance;
     Component   component;
     Continuity  continuity;
+    bool        parallel;
 };
 
 class MeshExport PlaneFitSmoothing : public AbstractSmoothing
@@ -71,6 +99,10 @@ public:
     virtual ~PlaneFitSmoothing();
     void Smooth(unsigned int);
     void SmoothPoints(unsigned int, const std::vector<unsigned long>&);
+
+protected:
+    void SmoothParallel(unsigned int, const std::vector<unsigned long>*);
+    void PlaneFitChunk(const Step&, Chunk&) const;
 };
 
 class MeshExport LaplaceSmoothing : public AbstractSmoothing
@@ -83,11 +115,19 @@ public:
     void SetLambda(double l) { lambda = l;}
 
 protected:
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double);
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double,
+    void Umbrella(const MeshCompactPointToPoints&,
+                  const MeshCompactPointToFacets&, double);
+    void Umbrella(const MeshCompactPointToPoints&,
+                  const MeshCompactPointToFacets&, double,
                   const std::vector<unsigned long>&);
+    /** Applies the umbrella operator once for each step size of \a steps to all points or to
+     * the points of \a indices. The points are double-buffered and only written back to the
+     * kernel after the last step.
+     */
+    void UmbrellaParallel(const MeshCompactPointToPoints&,
+                          const MeshCompactPointToFacets&, const std::vector<double>& steps,
+                          const std::vector<unsigned long>* indices);
+    void UmbrellaChunk(const Step&, Chunk&) const;
 
 protected:
     double lambda;
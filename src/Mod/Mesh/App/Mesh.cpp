@@ -289,7 +289,8 @@ void MeshObject::Save (Base::Writer &writer) const
 
 void MeshObject::SaveDocFile (Base::Writer &writer) const
 {
-    _kernel.Write(writer.Stream());
+    // see PropertyMeshKernel::Save()
+    _kernel.Write(writer.Stream(), !writer.getMode("CompactMesh"));
 }
 
 void MeshObject::Restore(Base::XMLReader &reader)
@@ -313,9 +314,9 @@ void MeshObject::save(const char* file, MeshCore::MeshIO::Format f,
     aWriter.SaveAny(file, f);
 }
 
-void MeshObject::save(std::ostream& out) const
+void MeshObject::save(std::ostream& out, bool neighbours) const
 {
-    _kernel.Write(out);
+    _kernel.Write(out, neighbours);
 }
 
 bool MeshObject::load(const char* file, MeshCore::Material* mat)
@@ -804,9 +805,9 @@ void MeshObject::setPoint(unsigned long index, const Base::Vector3d& p)
     _kernel.SetPoint(index,transformToInside(p));
 }
 
-void MeshObject::smooth(int iterations, float d_max)
+void MeshObject::smooth(int iterations, float d_max, bool parallel)
 {
-    _kernel.Smooth(iterations, d_max);
+    _kernel.Smooth(iterations, d_max, parallel);
 }
 
 Base::Vector3d MeshObject::getPointNormal(unsigned long index) const
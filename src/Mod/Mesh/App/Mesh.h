@@ -151,7 +151,8 @@ public:
     void save(const char* file,MeshCore::MeshIO::Format f=MeshCore::MeshIO::Undefined,
         const MeshCore::Material* mat = 0,
         const char* objectname = 0) const;
-    void save(std::ostream&) const;
+    /// Writes the kernel in the binary format, optionally without the facet neighbours
+    void save(std::ostream&, bool neighbours = true) const;
     bool load(const char* file, MeshCore::Material* mat = 0);
     void load(std::istream&);
     //@}
@@ -202,7 +203,7 @@ public:
     void transformToEigenSystem();
     void movePoint(unsigned long, const Base::Vector3d& v);
     void setPoint(unsigned long, const Base::Vector3d& v);
-    void smooth(int iterations, float d_max);
+    void smooth(int iterations, float d_max, bool parallel = false);
     Base::Vector3d getPointNormal(unsigned long) const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
                        float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
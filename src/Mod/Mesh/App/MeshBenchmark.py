@@ -0,0 +1,131 @@
+#   (c) FreeCAD developers 2026      LGPL
+
+# Standalone benchmark of the mesh module, it is not part of the test suite.
+# Run it with: FreeCADCmd MeshBenchmark.py [sphere sampling]
+
+import FreeCAD, os, sys, time, tempfile, Mesh
+
+
+def benchmarkFileFormats(mesh):
+	# write and read the mesh in every format and report size and throughput
+	formats = [("AST","stl"), ("STL","stl"), ("OBJ","obj"), ("OFF","off"), ("APLY","ply"), ("PLY","ply")]
+	for format, ext in formats:
+		name = os.path.join(tempfile.gettempdir(), "benchmark_%s.%s" % (format, ext))
+		start = time.time()
+		mesh.write(name, format)
+		written = time.time()
+		other = Mesh.Mesh()
+		other.read(name)
+		read = time.time()
+		size = os.path.getsize(name) / (1024.0 * 1024.0)
+		os.remove(name)
+		FreeCAD.Console.PrintMessage("%-5s %8.2f MB  write %7.3f s (%7.1f MB/s)  read %7.3f s (%7.1f MB/s)\n"
+			% (format, size, written-start, size/max(written-start,1e-6), read-written, size/max(read-written,1e-6)))
+
+
+def createRays(mesh, count):
+	# rays just above facets spread over the mesh pointing to them
+	points = []
+	dirs = []
+	facets = mesh.Facets
+	for i in range(count):
+		f = facets[i * 7919 % len(facets)]
+		center = FreeCAD.Vector()
+		for p in f.Points:
+			center = center.add(FreeCAD.Vector(p[0],p[1],p[2]))
+		center.multiply(1.0/3.0)
+		points.append(center.add(f.Normal))
+		dirs.append(f.Normal.negative())
+	return points, dirs
+
+
+def benchmarkRays(mesh, rays):
+	points, dirs = rays
+	count = len(points)
+	start = time.time()
+	for p, d in zip(points, dirs):
+		mesh.nearestFacetOnRay(tuple(p), tuple(d))
+	brute = time.time() - start
+	start = time.time()
+	hits = mesh.nearestFacetsOnRays(points, dirs)
+	bvh = time.time() - start
+	start = time.time()
+	other = mesh.nearestFacetsOnRays(points, dirs, "Grid")
+	grid = time.time() - start
+	# both structures must find the same facets, apart from rays hitting an edge
+	diff = len([1 for a, b in zip(hits, other) if a != b])
+	FreeCAD.Console.PrintMessage("%d rays: brute force %.3f s, bounding volume hierarchy %.3f s, facet grid %.3f s (%d different hits)\n"
+		% (count, brute, bvh, grid, diff))
+
+
+def peakMemory(func):
+	# peak resident memory in MB that func needs on top of the current process,
+	# measured in a forked child so that the freed memory doesn't falsify it
+	if not hasattr(os, "fork") or not os.path.exists("/proc/self/statm"):
+		return None
+	with open("/proc/self/statm") as f:
+		base = int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE") / 1024.0
+	pid = os.fork()
+	if pid == 0:
+		func()
+		os._exit(0)
+	usage = os.wait4(pid, 0)[2]
+	return max(usage.ru_maxrss - base, 0.0) / 1024.0
+
+
+def benchmarkGridLayouts(mesh, rays):
+	# compare the set per grid cell with the compact layout (CSR) of the facet grid
+	points, dirs = rays
+	hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Mesh")
+	compact = hGrp.GetBool("CompactGrid", True)
+	try:
+		for layout in (False, True):
+			hGrp.SetBool("CompactGrid", layout)
+			# a single ray mainly measures the creation of the grid
+			start = time.time()
+			mesh.nearestFacetsOnRays(points[:1], dirs[:1], "Grid")
+			build = time.time() - start
+			start = time.time()
+			mesh.nearestFacetsOnRays(points, dirs, "Grid")
+			query = max(time.time() - start - build, 0.0)
+			memory = peakMemory(lambda: mesh.nearestFacetsOnRays(points[:1], dirs[:1], "Grid"))
+			if memory is None:
+				memory = "n/a"
+			else:
+				memory = "%.1f MB" % memory
+			FreeCAD.Console.PrintMessage("%-7s grid: build %.3f s, memory %s, %d rays %.3f s\n"
+				% (layout and "compact" or "set", build, memory, len(points), query))
+	finally:
+		hGrp.SetBool("CompactGrid", compact)
+
+
+def benchmarkCrossSections(mesh, count):
+	# the facets cut by the planes are searched with the facet grid
+	planes = []
+	for i in range(count):
+		z = -9.0 + 18.0 * i / count
+		planes.append((FreeCAD.Vector(0,0,z), FreeCAD.Vector(0,0,1)))
+	start = time.time()
+	mesh.crossSections(planes)
+	FreeCAD.Console.PrintMessage("%d cross sections: %.3f s\n" % (count, time.time() - start))
+
+
+def benchmarkSmoothing(mesh):
+	for parallel in (False, True):
+		other = mesh.copy()
+		start = time.time()
+		other.smooth(5, 1.0, parallel)
+		FreeCAD.Console.PrintMessage("5 smoothing steps (parallel: %s): %.3f s\n" % (parallel, time.time() - start))
+
+
+sampling = 500
+if len(sys.argv) > 1 and sys.argv[-1].isdigit():
+	sampling = int(sys.argv[-1])
+mesh = Mesh.createSphere(10.0, sampling)
+FreeCAD.Console.PrintMessage("Sphere with %d points and %d facets\n" % (mesh.CountPoints, mesh.CountFacets))
+benchmarkFileFormats(mesh)
+rays = createRays(mesh, 1000)
+benchmarkRays(mesh, rays)
+benchmarkGridLayouts(mesh, rays)
+benchmarkCrossSections(mesh, 100)
+benchmarkSmoothing(mesh)
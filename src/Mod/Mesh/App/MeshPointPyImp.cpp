@@ -30,6 +30,7 @@
 #include "MeshPoint.h"
 #include "MeshPointPy.h"
 #include "MeshPointPy.cpp"
+#include "Core/Algorithm.h"
 
 #include <Base/VectorPy.h>
 
@@ -128,6 +129,21 @@ Py::Object MeshPointPy::getVector(void) const
     return Py::Object(vec,true);
 }
 
+Py::Tuple MeshPointPy::getNeighbourIndices(void) const
+{
+    MeshPointPy::PointerType ptr = getMeshPointPtr();
+    if (!ptr->isBound())
+        return Py::Tuple();
+
+    MeshCore::MeshCompactPointToPoints pt2pt(ptr->Mesh->getKernel());
+    MeshCore::MeshIndexRange range = pt2pt[ptr->Index];
+    Py::Tuple idxTuple(range.size());
+    int i = 0;
+    for (MeshCore::MeshIndexRange::const_iterator it = range.begin(); it != range.end(); ++it)
+        idxTuple.setItem(i++, Py::Int((long)*it));
+    return idxTuple;
+}
+
 Py::Float MeshPointPy::getx(void) const
 {
     MeshPointPy::PointerType ptr = reinterpret_cast<MeshPointPy::PointerType>(_pcTwinPointer);
@@ -32,10 +32,12 @@
 #include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/VectorPy.h>
+#include <App/Application.h>
 
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
 #include "Core/Iterator.h"
+#include "Core/Evaluation.h"
 
 #include "MeshProperties.h"
 #include "Mesh.h"
@@ -427,7 +429,7 @@ void PropertyCurvatureList::Paste(const App::Property &from)
 // ----------------------------------------------------------------------------
 
 PropertyMeshKernel::PropertyMeshKernel()
-  : _meshObject(new MeshObject()), meshPyObject(0)
+  : _meshObject(new MeshObject()), meshPyObject(0), decodedKernel(0)
 {
     // Note: Normally this property is a member of a document object, i.e. the setValue()
     // method gets called in the constructor of a sublcass of DocumentObject, e.g. Mesh::Feature.
@@ -443,6 +445,7 @@ PropertyMeshKernel::~PropertyMeshKernel()
         meshPyObject->parentProperty = 0;
         Py_DECREF(meshPyObject);
     }
+    delete decodedKernel;
 }
 
 void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
@@ -588,6 +591,13 @@ void PropertyMeshKernel::Save (Base::Writer &writer) const
         saver.SaveXML(writer);
     }
     else {
+        // Without the neighbour indices the file gets smaller and they are rebuilt
+        // on loading. But older versions cannot load such projects.
+        // SaveDocFile() may run on a worker thread and must not access the
+        // parameters, hence the preference is passed on as mode
+        if (!App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Mesh")->GetBool("SaveNeighbours", true))
+            writer.setMode("CompactMesh");
         writer.Stream() << writer.ind() << "<Mesh file=\"" << 
         writer.addFile("MeshKernel.bms", this) << "\"/>" << std::endl;
     }
@@ -621,7 +631,7 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
 
 void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 {
-    _meshObject->save(writer.Stream());
+    _meshObject->save(writer.Stream(), !writer.getMode("CompactMesh"));
 }
 
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
@@ -631,6 +641,39 @@ void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
     hasSetValue();
 }
 
+bool PropertyMeshKernel::isSaveThreadSafe(const Base::Writer &) const
+{
+    return true;
+}
+
+bool PropertyMeshKernel::isRestoreThreadSafe() const
+{
+    return true;
+}
+
+void PropertyMeshKernel::decodeDocFile(Base::Reader &reader)
+{
+    // This runs in a worker thread, so unlike MeshObject::load() a broken
+    // neighbourhood is fixed silently
+    delete decodedKernel;
+    decodedKernel = new MeshCore::MeshKernel();
+    decodedKernel->Read(reader);
+    MeshCore::MeshEvalNeighbourhood nb(*decodedKernel);
+    if (!nb.Evaluate())
+        decodedKernel->RebuildNeighbours();
+}
+
+void PropertyMeshKernel::applyDocFile()
+{
+    if (!decodedKernel)
+        return;
+    aboutToSetValue();
+    _meshObject->swap(*decodedKernel);
+    hasSetValue();
+    delete decodedKernel;
+    decodedKernel = 0;
+}
+
 App::Property *PropertyMeshKernel::Copy(void) const
 {
     // Note: Copy the content, do NOT reference the same mesh object
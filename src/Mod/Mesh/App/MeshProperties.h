@@ -241,6 +241,11 @@ public:
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
 
+    bool isRestoreThreadSafe() const;
+    void decodeDocFile(Base::Reader &reader);
+    void applyDocFile();
+    bool isSaveThreadSafe(const Base::Writer &writer) const;
+
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     //@}
@@ -248,6 +253,7 @@ public:
 private:
     Base::Reference<MeshObject> _meshObject;
     MeshPy* meshPyObject;
+    MeshCore::MeshKernel* decodedKernel;
 };
 
 } // namespace Mesh
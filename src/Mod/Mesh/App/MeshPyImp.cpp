@@ -43,6 +43,7 @@
 #include "Core/MeshKernel.h"
 #include "Core/Segmentation.h"
 #include "Core/Curvature.h"
+#include "Core/BVH.h"
 
 using namespace Mesh;
 
@@ -1376,12 +1377,13 @@ PyObject*  MeshPy::smooth(PyObject *args)
 {
     int iter=1;
     float d_max=FLOAT_MAX;
-    if (!PyArg_ParseTuple(args, "|if", &iter,&d_max))
+    PyObject *parallel=Py_False;
+    if (!PyArg_ParseTuple(args, "|ifO!", &iter,&d_max,&PyBool_Type,&parallel))
         return NULL;
 
     PY_TRY {
         MeshPropertyLock lock(this->parentProperty);
-        getMeshObjectPtr()->smooth(iter, d_max);
+        getMeshObjectPtr()->smooth(iter, d_max, PyObject_IsTrue(parallel) ? true : false);
     } PY_CATCH;
 
     Py_Return; 
@@ -1450,6 +1452,64 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
     }
 }
 
+PyObject* MeshPy::nearestFacetsOnRays(PyObject *args)
+{
+    PyObject* pnts;
+    PyObject* dirs;
+    const char* type = "BVH";
+    if (!PyArg_ParseTuple(args, "OO|s", &pnts, &dirs, &type))
+        return NULL;
+
+    try {
+        Py::Sequence pnt_s(pnts);
+        Py::Sequence dir_s(dirs);
+        if (pnt_s.size() != dir_s.size())
+            throw Py::ValueError("Number of points and directions must be equal");
+
+        std::vector<Base::Vector3f> points, directions;
+        points.reserve(pnt_s.size());
+        directions.reserve(dir_s.size());
+        for (Py::Sequence::iterator it = pnt_s.begin(); it != pnt_s.end(); ++it) {
+            Base::Vector3d pnt = Py::Vector(*it).toVector();
+            points.push_back(Base::convertTo<Base::Vector3f>(pnt));
+        }
+        for (Py::Sequence::iterator it = dir_s.begin(); it != dir_s.end(); ++it) {
+            Base::Vector3d dir = Py::Vector(*it).toVector();
+            directions.push_back(Base::convertTo<Base::Vector3f>(dir));
+        }
+
+        std::vector<unsigned long> facets;
+        std::vector<Base::Vector3f> results;
+        if (strcmp(type, "BVH") == 0) {
+            MeshCore::MeshFacetBVH bvh(getMeshObjectPtr()->getKernel());
+            bvh.NearestFacetsOnRays(points, directions, facets, results);
+        }
+        else if (strcmp(type, "Grid") == 0) {
+            const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+            MeshCore::MeshAlgorithm alg(kernel);
+            MeshCore::MeshFacetGrid grid(kernel);
+            facets.resize(points.size(), ULONG_MAX);
+            Base::Vector3f res;
+            for (std::size_t i = 0; i < points.size(); i++) {
+                unsigned long index;
+                if (alg.NearestFacetOnRay(points[i], directions[i], grid, res, index))
+                    facets[i] = index;
+            }
+        }
+        else {
+            throw Py::ValueError("Unknown search structure, use 'BVH' or 'Grid'");
+        }
+
+        Py::List list;
+        for (std::vector<unsigned long>::iterator it = facets.begin(); it != facets.end(); ++it)
+            list.append(Py::Int(*it == ULONG_MAX ? -1 : (long)*it));
+        return Py::new_reference_to(list);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject*  MeshPy::getPlanarSegments(PyObject *args)
 {
     float dev;
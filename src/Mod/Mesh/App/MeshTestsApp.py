@@ -71,6 +71,224 @@ class MeshGeoTestCases(unittest.TestCase):
 		res=f1.intersect(f2)
 		self.failUnless(len(res) == 0)
 
+	def testGridCrossSection(self):
+		# the facets cut by a plane are searched with the facet grid, all
+		# points of the section of a sphere must lie on the plane and sphere
+		mesh = Mesh.createSphere(10.0, 50)
+		sections = mesh.crossSections([(FreeCAD.Vector(0,0,0.3),FreeCAD.Vector(0,0,1))], 1e-4, True)
+		self.failUnless(len(sections) == 1)
+		self.failUnless(len(sections[0]) > 0)
+		for polyline in sections[0]:
+			for p in polyline:
+				self.failUnless(abs(p.z-0.3) < 1e-4)
+				self.failUnless(p.Length < 10.0+1e-4)
+				self.failUnless(p.Length > 9.9)
+
+	def testNearestFacetsOnRays(self):
+		# the bounding volume hierarchy must find the same facets as the brute force search
+		mesh = Mesh.createSphere(10.0, 20)
+		points = []
+		dirs = []
+		for f in mesh.Facets:
+			center = FreeCAD.Vector()
+			for p in f.Points:
+				center = center.add(FreeCAD.Vector(p[0],p[1],p[2]))
+			center.multiply(1.0/3.0)
+			points.append(center.add(f.Normal))
+			dirs.append(f.Normal.negative())
+		# a ray that misses the mesh
+		points.append(FreeCAD.Vector(100,0,0))
+		dirs.append(FreeCAD.Vector(1,0,0))
+		res = mesh.nearestFacetsOnRays(points, dirs)
+		self.failUnless(len(res) == len(points))
+		self.failUnless(res[-1] == -1)
+		for i in range(mesh.CountFacets):
+			# a ray just above a facet of a convex mesh hits this facet first
+			self.failUnless(res[i] == i)
+			brute = mesh.nearestFacetOnRay(tuple(points[i]), tuple(dirs[i]))
+			for index in brute.keys():
+				self.failUnless(index == res[i])
+
+	def testPointNeighbours(self):
+		# the planar mesh of 3x3 squares, each split into two triangles along the diagonal
+		planarMesh = []
+		for x in range(3):
+			for y in range(3):
+				planarMesh.append([0.0 + x, 0.0 + y, 0.0])
+				planarMesh.append([1.0 + x, 1.0 + y, 0.0])
+				planarMesh.append([0.0 + x, 1.0 + y, 0.0])
+				planarMesh.append([0.0 + x, 0.0 + y, 0.0])
+				planarMesh.append([1.0 + x, 0.0 + y, 0.0])
+				planarMesh.append([1.0 + x, 1.0 + y, 0.0])
+		mesh = Mesh.Mesh(planarMesh)
+		self.failUnless(mesh.CountPoints == 16)
+		index = {}
+		for p in mesh.Points:
+			index[(p.x, p.y)] = p.Index
+		# a corner with one diagonal, an inner point on two diagonals and one on none
+		expected = {(0.0,0.0): [(1.0,0.0),(0.0,1.0),(1.0,1.0)],
+		            (1.0,1.0): [(0.0,0.0),(1.0,0.0),(2.0,1.0),(2.0,2.0),(1.0,2.0),(0.0,1.0)],
+		            (3.0,0.0): [(2.0,0.0),(3.0,1.0)]}
+		for key, value in expected.items():
+			neighbours = sorted([index[v] for v in value])
+			self.failUnless(list(mesh.Points[index[key]].NeighbourIndices) == neighbours)
+		# all points of a closed mesh against the edges of its facets
+		mesh = Mesh.createSphere(10.0, 20)
+		edges = {}
+		for f in mesh.Facets:
+			i = f.PointIndices
+			for j in range(3):
+				edges.setdefault(i[j], set()).update([i[j-1], i[j-2]])
+		for p in mesh.Points:
+			self.failUnless(list(p.NeighbourIndices) == sorted(edges[p.Index]))
+
+	def testParallelSmoothing(self):
+		# The double-buffered smoothing computes all points from the previous
+		# iteration. It differs only slightly from the serial in-place smoothing
+		# and must not depend on the number of threads. The sphere has enough
+		# points to be split into several chunks.
+		mesh = Mesh.createSphere(10.0, 200)
+		serial = mesh.copy()
+		serial.smooth(5, 1.0, False)
+		parallel = mesh.copy()
+		parallel.smooth(5, 1.0, True)
+		points = [p.Vector for p in parallel.Points]
+		for p, q in zip(serial.Points, points):
+			self.failUnless(q.Length < 10.0 + 1e-5)
+			self.failUnless(p.Vector.sub(q).Length < 0.05)
+
+		try:
+			from PySide import QtCore
+		except ImportError:
+			return
+		pool = QtCore.QThreadPool.globalInstance()
+		count = pool.maxThreadCount()
+		for threads in (1, 2, 8):
+			pool.setMaxThreadCount(threads)
+			try:
+				other = mesh.copy()
+				other.smooth(5, 1.0, True)
+			finally:
+				pool.setMaxThreadCount(count)
+			self.failUnless([p.Vector for p in other.Points] == points)
+
+	def testSelfIntersection(self):
+		# a sphere has no self-intersections, two overlapping spheres have
+		mesh = Mesh.createSphere(10.0, 50)
+		self.failUnless(not mesh.hasSelfIntersections())
+		other = Mesh.createSphere(10.0, 50)
+		other.translate(5.0, 0.0, 0.0)
+		mesh.addMesh(other)
+		self.failUnless(mesh.hasSelfIntersections())
+
+	def testFileFormats(self):
+		# writing and reading every format must give back the same facets
+		mesh = Mesh.createSphere(10.0, 20)
+		formats = [("AST","stl"), ("STL","stl"), ("OBJ","obj"), ("OFF","off"), ("APLY","ply"), ("PLY","ply")]
+		for format, ext in formats:
+			name = os.path.join(tempfile.gettempdir(), "mesh_%s.%s" % (format, ext))
+			mesh.write(name, format)
+			other = Mesh.Mesh()
+			other.read(name)
+			os.remove(name)
+			self.failUnless(other.CountPoints == mesh.CountPoints)
+			self.failUnless(other.CountFacets == mesh.CountFacets)
+			for f, g in zip(mesh.Facets, other.Facets):
+				for p, q in zip(f.Points, g.Points):
+					d = FreeCAD.Vector(p[0],p[1],p[2]).sub(FreeCAD.Vector(q[0],q[1],q[2]))
+					self.failUnless(d.Length < 1e-4)
+
+	def testCompactProjectFormat(self):
+		# without the stored neighbours they must be rebuilt on loading, also for open edges
+		mesh = Mesh.createSphere(10.0, 20)
+		mesh.removeFacets([0, 5])
+		param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Mesh")
+		saveNeighbours = param.GetBool("SaveNeighbours", True)
+		name = os.path.join(tempfile.gettempdir(), "MeshCompact.FCStd")
+		try:
+			param.SetBool("SaveNeighbours", False)
+			doc = FreeCAD.newDocument("MeshCompact")
+			doc.addObject("Mesh::Feature", "Mesh").Mesh = mesh
+			doc.saveAs(name)
+			FreeCAD.closeDocument("MeshCompact")
+		finally:
+			param.SetBool("SaveNeighbours", saveNeighbours)
+
+		# the version of the compact format follows the magic number
+		import zipfile, struct
+		archive = zipfile.ZipFile(name)
+		data = [archive.read(n) for n in archive.namelist() if n.endswith(".bms")]
+		archive.close()
+		self.failUnless(len(data) == 1)
+		self.failUnless(struct.unpack("=II", data[0][0:8]) == (0xA0B0C0D0, 0x010001))
+
+		doc = FreeCAD.open(name)
+		other = doc.Mesh.Mesh
+		FreeCAD.closeDocument(doc.Name)
+		os.remove(name)
+		self.failUnless(other.CountPoints == mesh.CountPoints)
+		self.failUnless(other.CountFacets == mesh.CountFacets)
+		for f, g in zip(mesh.Facets, other.Facets):
+			self.failUnless(f.PointIndices == g.PointIndices)
+			self.failUnless(f.NeighbourIndices == g.NeighbourIndices)
+
+	def testWeldPoints(self):
+		# points closer than the tolerance of 1e-6 in each coordinate are welded
+		import struct
+		def single(v):
+			return tuple([struct.unpack("f", struct.pack("f", c))[0] for c in v])
+		def jitter(x, y, k):
+			d = ((x * 7 + y * 3 + k) % 5 - 2) * 2e-7
+			return (x / 8.0 + d, y / 8.0 - d, d)
+
+		soup = []
+		for x in range(8):
+			for y in range(8):
+				k = len(soup)
+				soup.append([jitter(x,y,k), jitter(x+1,y,k+1), jitter(x+1,y+1,k+2)])
+				soup.append([jitter(x,y,k+3), jitter(x+1,y+1,k+4), jitter(x,y+1,k+5)])
+		# the third point is close to the second but not to the first, which is kept
+		soup.append([(2.0,0.0,0.0), (3.0,0.0,0.0), (2.0,1.0,0.0)])
+		soup.append([(2.0+0.7e-6,0.0,0.0), (3.0,0.0,0.0), (2.0,1.0,1.0)])
+		soup.append([(2.0+1.4e-6,0.0,0.0), (3.0,1.0,0.0), (2.0,1.0,1.0)])
+		# a degenerated facet, only one of its points is used elsewhere
+		soup.append([(5.0,5.0,5.0), (5.0,5.0,5.0+0.5e-6), (6.0,5.0,5.0)])
+		soup.append([(6.0,5.0,5.0), (7.0,5.0,5.0), (6.0,6.0,5.0)])
+
+		# the rules of MeshBuilder: a point is welded to the first kept point nearby,
+		# the points are numbered in the order of their first occurrence and points
+		# of degenerated facets only are removed
+		kept = []
+		facets = []
+		for triangle in soup:
+			facet = []
+			for v in triangle:
+				p = single(v)
+				index = -1
+				for i, q in enumerate(kept):
+					if abs(p[0]-q[0]) < 1e-6 and abs(p[1]-q[1]) < 1e-6 and abs(p[2]-q[2]) < 1e-6:
+						index = i
+						break
+				if index < 0:
+					index = len(kept)
+					kept.append(p)
+				facet.append(index)
+			if len(set(facet)) == 3:
+				facets.append(facet)
+		used = sorted(set([i for f in facets for i in f]))
+		number = dict([(i, n) for n, i in enumerate(used)])
+
+		mesh = Mesh.Mesh([v for triangle in soup for v in triangle])
+		points, indices = mesh.Topology
+		self.failUnless(mesh.CountPoints == 81 + 6 + 3)
+		self.failUnless(len(points) == len(used))
+		self.failUnless(len(indices) == len(facets))
+		for n, i in enumerate(used):
+			self.failUnless(points[n].sub(FreeCAD.Vector(kept[i][0],kept[i][1],kept[i][2])).Length < 1e-9)
+		for f, g in zip(facets, indices):
+			self.failUnless(tuple([number[i] for i in f]) == tuple(g))
+		self.failIf(mesh.hasNonManifolds())
+
 class PivyTestCases(unittest.TestCase):
 	def setUp(self):
 		# set up a planar face with 2 triangles
@@ -16,6 +16,7 @@
 # include <IGESControl_Controller.hxx>
 # include <STEPControl_Controller.hxx>
 # include <OSD.hxx>
+# include <Standard.hxx>
 # include <sstream>
 #endif
 
@@ -117,6 +118,11 @@ void PartExport initPart()
     OSD::SetSignal(Standard_False);
 //#endif
 
+    // Shapes are built on several threads, e.g. by the parallel recompute of a
+    // document. This is set once for the whole session because switching it off
+    // again while another thread is inside OCC isn't safe.
+    Standard::SetReentrant(Standard_True);
+
     PyObject* partModule = Py_InitModule3("Part", Part_methods, module_part_doc);   /* mod name, table ptr */
     Base::Console().Log("Loading Part module... done\n");
     PyObject* OCCError = 0;
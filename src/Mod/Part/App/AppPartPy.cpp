@@ -118,6 +118,7 @@
 #include "FeaturePartImportStep.h"
 #include "FeaturePartImportIges.h"
 #include "FeaturePartImportBrep.h"
+#include "PartFeature.h"
 #include "ImportIges.h"
 #include "ImportStep.h"
 #include "edgecluster.h"
@@ -1683,6 +1684,30 @@ static PyObject * cast_to_shape(PyObject *self, PyObject *args)
     return 0;
 }
 
+static PyObject * checkIntersection(PyObject *self, PyObject *args)
+{
+    PyObject *first, *second;
+    PyObject *quick = Py_False, *touch = Py_False;
+    if (!PyArg_ParseTuple(args, "O!O!|O!O!", &(Part::TopoShapePy::Type), &first,
+                                             &(Part::TopoShapePy::Type), &second,
+                                             &(PyBool_Type), &quick,
+                                             &(PyBool_Type), &touch))
+        return 0;
+
+    try {
+        const TopoDS_Shape& s1 = static_cast<TopoShapePy*>(first)->getTopoShapePtr()->_Shape;
+        const TopoDS_Shape& s2 = static_cast<TopoShapePy*>(second)->getTopoShapePtr()->_Shape;
+        bool ok = Part::checkIntersection(s1, s2, PyObject_IsTrue(quick) ? true : false,
+                                          PyObject_IsTrue(touch) ? true : false);
+        return Py::new_reference_to(Py::Boolean(ok));
+    }
+    catch (Standard_Failure) {
+        Handle_Standard_Failure e = Standard_Failure::Caught();
+        PyErr_SetString(PartExceptionOCCError, e->GetMessageString());
+        return 0;
+    }
+}
+
 /* registration table  */
 struct PyMethodDef Part_methods[] = {
     {"open"       ,open      ,METH_VARARGS,
@@ -1799,6 +1824,11 @@ struct PyMethodDef Part_methods[] = {
     {"cast_to_shape" ,cast_to_shape,METH_VARARGS,
      "cast_to_shape(shape) -- Cast to the actual shape type"},
 
+    {"checkIntersection" ,checkIntersection,METH_VARARGS,
+     "checkIntersection(shape,shape,[quick=False,touch_is_intersection=False]) -- Check if two shapes interfere.\n"
+     "With quick only the bounding boxes are compared. With touch_is_intersection shapes\n"
+     "touching each other interfere, otherwise they must have common material."},
+
     {"getSortedClusters" ,getSortedClusters,METH_VARARGS,
     "getSortedClusters(list of edges) -- Helper method to sort and cluster a variety of edges"},
 
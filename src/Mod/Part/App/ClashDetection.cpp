@@ -0,0 +1,368 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <map>
+# include <vector>
+# include <Bnd_Box.hxx>
+# include <BRepAlgoAPI_Common.hxx>
+# include <BRepAlgoAPI_Fuse.hxx>
+# include <BRepBndLib.hxx>
+# include <BRepClass3d_SolidClassifier.hxx>
+# include <BRepExtrema_DistShapeShape.hxx>
+# include <BRep_Tool.hxx>
+# include <Precision.hxx>
+# include <Standard_Failure.hxx>
+# include <TopExp_Explorer.hxx>
+# include <TopTools_DataMapOfShapeInteger.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopoDS_Solid.hxx>
+# include <TopoDS_Vertex.hxx>
+#endif
+
+#include <QtConcurrentMap>
+
+#include "ClashDetection.h"
+
+using namespace Part;
+
+namespace Part {
+
+/** The data of a shape needed for the clash tests. */
+struct ClashShapeData
+{
+    Bnd_Box box;
+    std::vector<TopoDS_Face> faces;
+    std::vector<Bnd_Box> faceBoxes;
+    std::vector<TopoDS_Solid> solids;
+    std::vector<gp_Pnt> points; /**< A vertex of each solid. */
+};
+
+/** A pair of shapes whose bounding boxes overlap. */
+struct ClashPair
+{
+    TopoDS_Shape first, second;
+    const ClashShapeData* firstData;
+    const ClashShapeData* secondData;
+    std::pair<int, int> key;
+    bool touch_is_intersection;
+    bool needsBoolean;
+    bool result;
+};
+
+class ClashDetection::Private
+{
+public:
+    ~Private()
+    {
+        for (std::vector<ClashShapeData*>::iterator it = data.begin(); it != data.end(); ++it)
+            delete *it;
+    }
+
+    int index(const TopoDS_Shape& shape)
+    {
+        if (shapes.IsBound(shape))
+            return shapes.Find(shape);
+
+        ClashShapeData* sd = new ClashShapeData();
+        BRepBndLib::Add(shape, sd->box);
+        sd->box.SetGap(0);
+        for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next()) {
+            Bnd_Box box;
+            BRepBndLib::Add(xp.Current(), box);
+            box.Enlarge(Precision::Confusion());
+            sd->faces.push_back(TopoDS::Face(xp.Current()));
+            sd->faceBoxes.push_back(box);
+        }
+        for (TopExp_Explorer xp(shape, TopAbs_SOLID); xp.More(); xp.Next()) {
+            TopExp_Explorer xv(xp.Current(), TopAbs_VERTEX);
+            if (!xv.More())
+                continue;
+            sd->solids.push_back(TopoDS::Solid(xp.Current()));
+            sd->points.push_back(BRep_Tool::Pnt(TopoDS::Vertex(xv.Current())));
+        }
+
+        int i = (int)data.size();
+        data.push_back(sd);
+        shapes.Bind(shape, i);
+        return i;
+    }
+
+    /** Returns the pair of \a first and \a second, or false if their bounding boxes
+     * don't overlap.
+     */
+    bool makePair(const TopoDS_Shape& first, const TopoDS_Shape& second,
+                  bool touch_is_intersection, ClashPair& pair)
+    {
+        int i = index(first);
+        int j = index(second);
+        // Note: This test fails if the objects are touching one another at zero distance
+        if (data[i]->box.IsOut(data[j]->box))
+            return false;
+
+        pair.first = first;
+        pair.second = second;
+        pair.firstData = data[i];
+        pair.secondData = data[j];
+        pair.key = std::make_pair(std::min<int>(i, j), std::max<int>(i, j));
+        pair.touch_is_intersection = touch_is_intersection;
+        pair.needsBoolean = false;
+        pair.result = false;
+        return true;
+    }
+
+    /** Sets the results of \a pairs. The read-only tests of the pairs not yet cached
+     * run in parallel, the boolean operations one after another because they modify
+     * the sub-shapes that the shapes share.
+     */
+    void check(std::vector<ClashPair>& pairs)
+    {
+        std::vector<ClashPair> todo;
+        std::vector<std::size_t> todoIndex;
+        for (std::size_t i = 0; i < pairs.size(); i++) {
+            std::map<std::pair<int, int>, bool>& cache = results[pairs[i].touch_is_intersection ? 1 : 0];
+            std::map<std::pair<int, int>, bool>::iterator it = cache.find(pairs[i].key);
+            if (it != cache.end()) {
+                pairs[i].result = it->second;
+            }
+            else {
+                todo.push_back(pairs[i]);
+                todoIndex.push_back(i);
+            }
+        }
+
+        if (todo.size() > 1) {
+            // the Part module has switched OCC to reentrant mode
+            QtConcurrent::blockingMap(todo, &Private::testPair);
+        }
+        else if (todo.size() == 1) {
+            testPair(todo.front());
+        }
+
+        for (std::vector<ClashPair>::iterator it = todo.begin(); it != todo.end(); ++it) {
+            if (it->needsBoolean)
+                booleanPair(*it);
+        }
+
+        for (std::size_t i = 0; i < todo.size(); i++) {
+            results[todo[i].touch_is_intersection ? 1 : 0][todo[i].key] = todo[i].result;
+            pairs[todoIndex[i]].result = todo[i].result;
+        }
+    }
+
+    /** Decides the pair by measuring and classifying, or sets needsBoolean if a
+     * boolean operation is needed. Runs on a worker thread.
+     */
+    static void testPair(ClashPair& pair)
+    {
+        const ClashShapeData& sd1 = *pair.firstData;
+        const ClashShapeData& sd2 = *pair.secondData;
+        try {
+            if (!touching(sd1, sd2)) {
+                // the shapes are apart or one is inside the other
+                pair.result = inside(sd1, sd2) || inside(sd2, sd1);
+            }
+            else {
+                // the faces may touch only at an edge or a vertex
+                pair.needsBoolean = true;
+            }
+        }
+        catch (Standard_Failure&) {
+            // leave the decision to the boolean operation
+            pair.needsBoolean = true;
+        }
+    }
+
+    static void booleanPair(ClashPair& pair)
+    {
+        if (pair.touch_is_intersection) {
+            // If both shapes fuse to a single solid, then they intersect
+            BRepAlgoAPI_Fuse mkFuse(pair.first, pair.second);
+            if (!mkFuse.IsDone() || mkFuse.Shape().IsNull()) {
+                pair.result = false;
+            }
+            else {
+                // Did we get one or two solids?
+                TopExp_Explorer xp;
+                xp.Init(mkFuse.Shape(),TopAbs_SOLID);
+                if (xp.More()) {
+                    xp.Next();
+                    pair.result = (xp.More() == Standard_False);
+                }
+                else {
+                    pair.result = false;
+                }
+            }
+        }
+        else {
+            // If both shapes have common material, then they intersect
+            BRepAlgoAPI_Common mkCommon(pair.first, pair.second);
+            if (!mkCommon.IsDone() || mkCommon.Shape().IsNull()) {
+                pair.result = false;
+            }
+            else {
+                // Did we get a solid?
+                TopExp_Explorer xp;
+                xp.Init(mkCommon.Shape(),TopAbs_SOLID);
+                pair.result = (xp.More() == Standard_True);
+            }
+        }
+    }
+
+    /** Returns true if a face of \a first touches or crosses a face of \a second. */
+    static bool touching(const ClashShapeData& first, const ClashShapeData& second)
+    {
+        for (std::size_t i = 0; i < first.faces.size(); i++) {
+            if (first.faceBoxes[i].IsOut(second.box))
+                continue;
+            for (std::size_t j = 0; j < second.faces.size(); j++) {
+                if (first.faceBoxes[i].IsOut(second.faceBoxes[j]))
+                    continue;
+                BRepExtrema_DistShapeShape dist(first.faces[i], second.faces[j]);
+                // if the distance is unknown assume that the faces touch
+                if (!dist.IsDone() || dist.Value() <= Precision::Confusion())
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    /** Returns true if a solid of \a inner lies in a solid of \a outer. The faces of both
+     * shapes must not touch, so that a solid lies either completely inside or outside.
+     */
+    static bool inside(const ClashShapeData& outer, const ClashShapeData& inner)
+    {
+        for (std::vector<TopoDS_Solid>::const_iterator it = outer.solids.begin(); it != outer.solids.end(); ++it) {
+            for (std::vector<gp_Pnt>::const_iterator jt = inner.points.begin(); jt != inner.points.end(); ++jt) {
+                BRepClass3d_SolidClassifier classifier(*it, *jt, Precision::Confusion());
+                if (classifier.State() == TopAbs_IN)
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    TopTools_DataMapOfShapeInteger shapes;
+    std::vector<ClashShapeData*> data;
+    std::map<std::pair<int, int>, bool> results[2];
+};
+
+}
+
+ClashDetection::ClashDetection() : d(new Private())
+{
+}
+
+ClashDetection::~ClashDetection()
+{
+    delete d;
+}
+
+void ClashDetection::clear()
+{
+    delete d;
+    d = new Private();
+}
+
+bool ClashDetection::intersect(const TopoDS_Shape& first, const TopoDS_Shape& second,
+                               bool quick, bool touch_is_intersection)
+{
+    std::vector<ClashPair> pairs(1);
+    if (!d->makePair(first, second, touch_is_intersection, pairs.front()))
+        return false; // no intersection
+    if (quick)
+        return true; // assumed intersection
+
+    d->check(pairs);
+    return pairs.front().result;
+}
+
+std::vector<bool> ClashDetection::intersect(const TopoDS_Shape& first, const std::vector<TopoDS_Shape>& shapes,
+                                            bool touch_is_intersection)
+{
+    std::vector<bool> result(shapes.size(), false);
+    std::vector<ClashPair> pairs;
+    std::vector<std::size_t> pairIndex;
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+        ClashPair pair;
+        if (d->makePair(first, shapes[i], touch_is_intersection, pair)) {
+            pairs.push_back(pair);
+            pairIndex.push_back(i);
+        }
+    }
+
+    d->check(pairs);
+    for (std::size_t i = 0; i < pairs.size(); i++)
+        result[pairIndex[i]] = pairs[i].result;
+    return result;
+}
+
+std::vector<std::pair<int, int> > ClashDetection::intersect(const std::vector<TopoDS_Shape>& shapes,
+                                                            bool touch_is_intersection)
+{
+    // sweep and prune: sort the boxes by their lower x value, then a box can only
+    // overlap the following boxes that start before it ends
+    std::vector<std::pair<double, int> > order;
+    std::vector<double> upper(shapes.size());
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+        const Bnd_Box& box = d->data[d->index(shapes[i])]->box;
+        if (box.IsVoid())
+            continue;
+        double xmin, ymin, zmin, xmax, ymax, zmax;
+        box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+        order.push_back(std::make_pair(xmin, (int)i));
+        upper[i] = xmax;
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<ClashPair> pairs;
+    std::vector<std::pair<int, int> > pairIndex;
+    for (std::size_t i = 0; i < order.size(); i++) {
+        int s1 = order[i].second;
+        for (std::size_t j = i + 1; j < order.size() && order[j].first <= upper[s1]; j++) {
+            int s2 = order[j].second;
+            int a = std::min<int>(s1, s2);
+            int b = std::max<int>(s1, s2);
+            ClashPair pair;
+            if (d->makePair(shapes[a], shapes[b], touch_is_intersection, pair)) {
+                pairs.push_back(pair);
+                pairIndex.push_back(std::make_pair(a, b));
+            }
+        }
+    }
+
+    d->check(pairs);
+    std::vector<std::pair<int, int> > result;
+    for (std::size_t i = 0; i < pairs.size(); i++) {
+        if (pairs[i].result)
+            result.push_back(pairIndex[i]);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_CLASHDETECTION_H
+#define PART_CLASHDETECTION_H
+
+#include <utility>
+#include <vector>
+
+class TopoDS_Shape;
+
+namespace Part {
+
+/**
+ * The ClashDetection class checks pairs of shapes for interference without
+ * computing a boolean operation whenever possible.
+ *
+ * Only faces whose bounding boxes overlap are measured against each other. If
+ * no faces of the two shapes touch, the shapes can only interfere if a solid of
+ * one shape lies inside the other one, which is decided by classifying a single
+ * vertex. Only for shapes touching each other a boolean operation is computed:
+ * a fuse if touching is regarded as interference, because touching only at an
+ * edge or a vertex doesn't count, otherwise a common.
+ *
+ * The face boxes of every shape and the result of every pair are cached, so that
+ * checking one shape against many others, like the support against the copies of
+ * a pattern, analyses it only once. Shapes are identified by their TShape and
+ * location, so a modified shape must be checked with a new instance.
+ *
+ * The methods checking several shapes at once only test shapes whose bounding
+ * boxes overlap and run the distance and classification tests in parallel. The
+ * boolean operations modify the sub-shapes the shapes share and run serially.
+ */
+class PartExport ClashDetection
+{
+public:
+    ClashDetection();
+    ~ClashDetection();
+
+    /** Returns true if the shapes interfere. The flags \a quick and
+     * \a touch_is_intersection have the same meaning as for checkIntersection().
+     */
+    bool intersect(const TopoDS_Shape& first, const TopoDS_Shape& second,
+                   bool quick, bool touch_is_intersection);
+    /// Checks each shape of \a shapes against \a first and returns a flag per shape.
+    std::vector<bool> intersect(const TopoDS_Shape& first, const std::vector<TopoDS_Shape>& shapes,
+                                bool touch_is_intersection);
+    /** Returns the sorted pairs of indices of \a shapes that interfere, the lower index first.
+     * The pairs with overlapping bounding boxes are found by sweep and prune.
+     */
+    std::vector<std::pair<int, int> > intersect(const std::vector<TopoDS_Shape>& shapes,
+                                                bool touch_is_intersection);
+    /// Removes all cached data.
+    void clear();
+
+private:
+    ClashDetection(const ClashDetection&);
+    ClashDetection& operator=(const ClashDetection&);
+
+    class Private;
+    Private* d;
+};
+
+} // namespace Part
+
+#endif // PART_CLASHDETECTION_H
@@ -32,6 +32,7 @@
 
 #include "FeaturePartCommon.h"
 #include "modelRefine.h"
+#include "MultiBoolean.h"
 #include <App/Application.h>
 #include <Base/Parameter.h>
 #include <Base/Exception.h>
@@ -86,33 +87,15 @@ App::DocumentObjectExecReturn *MultiCommon::execute(void)
 
     if (s.size() >= 2) {
         try {
-            std::vector<ShapeHistory> history;
-            TopoDS_Shape resShape = s.front();
-            for (std::vector<TopoDS_Shape>::iterator it = s.begin()+1; it != s.end(); ++it) {
-                // Let's call algorithm computing a fuse operation:
-                BRepAlgoAPI_Common mkCommon(resShape, *it);
-                // Let's check if the fusion has been successful
-                if (!mkCommon.IsDone()) 
-                    throw Base::Exception("Intersection failed");
-                resShape = mkCommon.Shape();
-
-                ShapeHistory hist1 = buildHistory(mkCommon, TopAbs_FACE, resShape, mkCommon.Shape1());
-                ShapeHistory hist2 = buildHistory(mkCommon, TopAbs_FACE, resShape, mkCommon.Shape2());
-                if (history.empty()) {
-                    history.push_back(hist1);
-                    history.push_back(hist2);
-                }
-                else {
-                    for (std::vector<ShapeHistory>::iterator jt = history.begin(); jt != history.end(); ++jt)
-                        *jt = joinHistory(*jt, hist1);
-                    history.push_back(hist2);
-                }
-            }
+            Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
+                .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/Part/Boolean");
+            // combine the shapes as a balanced tree on several threads or from left to right
+            MultiBoolean mkBool(MultiBoolean::Common, hGrp->GetBool("BalancedMultiOperand", true));
+            TopoDS_Shape resShape = mkBool.perform(s);
+            std::vector<ShapeHistory> history = mkBool.getHistory();
             if (resShape.IsNull())
                 throw Base::Exception("Resulting shape is invalid");
 
-            Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
-                .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/Part/Boolean");
             if (hGrp->GetBool("CheckModel", false)) {
                  BRepCheck_Analyzer aChecker(resShape);
                  if (! aChecker.IsValid() ) {
@@ -31,6 +31,7 @@
 
 #include "FeaturePartFuse.h"
 #include "modelRefine.h"
+#include "MultiBoolean.h"
 #include <App/Application.h>
 #include <Base/Parameter.h>
 #include <Base/Exception.h>
@@ -85,38 +86,15 @@ App::DocumentObjectExecReturn *MultiFuse::execute(void)
 
     if (s.size() >= 2) {
         try {
-            std::vector<ShapeHistory> history;
-            TopoDS_Shape resShape = s.front();
-            if (resShape.IsNull())
-                throw Base::Exception("Input shape is null");
-            for (std::vector<TopoDS_Shape>::iterator it = s.begin()+1; it != s.end(); ++it) {
-                if (it->IsNull())
-                    throw Base::Exception("Input shape is null");
-
-                // Let's call algorithm computing a fuse operation:
-                BRepAlgoAPI_Fuse mkFuse(resShape, *it);
-                // Let's check if the fusion has been successful
-                if (!mkFuse.IsDone()) 
-                    throw Base::Exception("Fusion failed");
-                resShape = mkFuse.Shape();
-
-                ShapeHistory hist1 = buildHistory(mkFuse, TopAbs_FACE, resShape, mkFuse.Shape1());
-                ShapeHistory hist2 = buildHistory(mkFuse, TopAbs_FACE, resShape, mkFuse.Shape2());
-                if (history.empty()) {
-                    history.push_back(hist1);
-                    history.push_back(hist2);
-                }
-                else {
-                    for (std::vector<ShapeHistory>::iterator jt = history.begin(); jt != history.end(); ++jt)
-                        *jt = joinHistory(*jt, hist1);
-                    history.push_back(hist2);
-                }
-            }
+            Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
+                .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/Part/Boolean");
+            // combine the shapes as a balanced tree on several threads or from left to right
+            MultiBoolean mkBool(MultiBoolean::Fuse, hGrp->GetBool("BalancedMultiOperand", true));
+            TopoDS_Shape resShape = mkBool.perform(s);
+            std::vector<ShapeHistory> history = mkBool.getHistory();
             if (resShape.IsNull())
                 throw Base::Exception("Resulting shape is null");
 
-            Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
-                .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/Part/Boolean");
             if (hGrp->GetBool("CheckModel", false)) {
                 BRepCheck_Analyzer aChecker(resShape);
                 if (! aChecker.IsValid() ) {
@@ -0,0 +1,201 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <memory>
+# include <string>
+# include <BRepAlgoAPI_Common.hxx>
+# include <BRepAlgoAPI_Fuse.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
+# include <Standard_Failure.hxx>
+# include <TopExp.hxx>
+# include <TopLoc_Location.hxx>
+# include <TopTools_DataMapOfShapeInteger.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+#endif
+
+#include <QtConcurrentMap>
+
+#include "MultiBoolean.h"
+#include "PartFeature.h"
+#include <Base/Console.h>
+#include <Base/Exception.h>
+#include <Base/TimeInfo.h>
+
+using namespace Part;
+
+namespace {
+
+struct MultiBooleanNode
+{
+    TopoDS_Shape shape;
+    // The face histories of all input shapes of this subtree,
+    // empty for an input shape itself
+    std::vector<ShapeHistory> history;
+};
+
+struct MultiBooleanTask
+{
+    MultiBoolean::Operation operation;
+    const MultiBooleanNode* left;
+    const MultiBooleanNode* right;
+    MultiBooleanNode result;
+    std::string error;
+};
+
+void appendHistory(std::vector<ShapeHistory>& dest, const std::vector<ShapeHistory>& src,
+                   const ShapeHistory& hist)
+{
+    if (src.empty()) {
+        dest.push_back(hist);
+    }
+    else {
+        for (std::vector<ShapeHistory>::const_iterator it = src.begin(); it != src.end(); ++it)
+            dest.push_back(Feature::joinHistory(*it, hist));
+    }
+}
+
+// Runs on a worker thread, therefore errors are passed back as message
+void combine(MultiBooleanTask& task)
+{
+    try {
+        std::auto_ptr<BRepAlgoAPI_BooleanOperation> mkBool;
+        if (task.operation == MultiBoolean::Fuse)
+            mkBool.reset(new BRepAlgoAPI_Fuse(task.left->shape, task.right->shape));
+        else
+            mkBool.reset(new BRepAlgoAPI_Common(task.left->shape, task.right->shape));
+        if (!mkBool->IsDone()) {
+            task.error = task.operation == MultiBoolean::Fuse
+                ? "Fusion failed" : "Intersection failed";
+            return;
+        }
+
+        TopoDS_Shape resShape = mkBool->Shape();
+        ShapeHistory hist1 = Feature::buildHistory(*mkBool.get(), TopAbs_FACE, resShape, mkBool->Shape1());
+        ShapeHistory hist2 = Feature::buildHistory(*mkBool.get(), TopAbs_FACE, resShape, mkBool->Shape2());
+
+        task.result.shape = resShape;
+        appendHistory(task.result.history, task.left->history, hist1);
+        appendHistory(task.result.history, task.right->history, hist2);
+    }
+    catch (Standard_Failure& e) {
+        task.error = e.GetMessageString();
+    }
+}
+
+/** Replaces the shapes sharing a sub-shape with a shape before them by a copy.
+ * Boolean operations modify the sub-shapes of their arguments, so no two operations
+ * running at the same time may get shapes sharing a sub-shape, e.g. placed copies
+ * of the same shape. The copies keep the order of the sub-shapes, so the indices of
+ * the face histories are the same.
+ */
+void copySharedShapes(std::vector<MultiBooleanNode>& nodes)
+{
+    TopTools_DataMapOfShapeInteger owner;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        TopTools_IndexedMapOfShape subShapes;
+        TopExp::MapShapes(nodes[i].shape, subShapes);
+        bool shared = false;
+        for (int j = 1; j <= subShapes.Extent(); j++) {
+            // the same sub-shape at another location is shared as well
+            TopoDS_Shape key = subShapes(j).Located(TopLoc_Location());
+            if (!owner.IsBound(key))
+                owner.Bind(key, (int)i);
+            else if (owner.Find(key) != (int)i)
+                shared = true;
+        }
+        if (shared) {
+            BRepBuilderAPI_Copy copy(nodes[i].shape);
+            nodes[i].shape = copy.Shape();
+        }
+    }
+}
+
+}
+
+MultiBoolean::MultiBoolean(Operation op, bool balanced)
+  : operation(op), balanced(balanced)
+{
+}
+
+TopoDS_Shape MultiBoolean::perform(const std::vector<TopoDS_Shape>& shapes)
+{
+    history.clear();
+    levelTimes.clear();
+
+    std::vector<MultiBooleanNode> nodes(shapes.size());
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+        if (shapes[i].IsNull())
+            throw Base::Exception("Input shape is null");
+        nodes[i].shape = shapes[i];
+    }
+    if (nodes.empty())
+        return TopoDS_Shape();
+
+    // the boolean operations of a level run on several threads
+    if (balanced && nodes.size() > 2)
+        copySharedShapes(nodes);
+
+    while (nodes.size() > 1) {
+        Base::TimeInfo start;
+
+        // In balanced mode all pairs of neighbours are combined, an odd node is
+        // passed on to the next level. Otherwise only the first two nodes are.
+        std::size_t count = balanced ? nodes.size() / 2 : 1;
+        std::vector<MultiBooleanTask> tasks(count);
+        for (std::size_t i = 0; i < count; i++) {
+            tasks[i].operation = operation;
+            tasks[i].left = &nodes[2*i];
+            tasks[i].right = &nodes[2*i+1];
+        }
+
+        if (count > 1) {
+            // the Part module has switched OCC to reentrant mode
+            QtConcurrent::blockingMap(tasks, combine);
+        }
+        else {
+            combine(tasks.front());
+        }
+
+        std::vector<MultiBooleanNode> next;
+        next.reserve(nodes.size() - count);
+        for (std::vector<MultiBooleanTask>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+            if (!it->error.empty())
+                throw Base::Exception(it->error);
+            next.push_back(it->result);
+        }
+        next.insert(next.end(), nodes.begin() + 2 * count, nodes.end());
+        nodes.swap(next);
+
+        float time = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+        levelTimes.push_back(time);
+        if (balanced) {
+            Base::Console().Log("Boolean level %d: %d operations in %.3f s\n",
+                (int)levelTimes.size(), (int)count, time);
+        }
+    }
+
+    history = nodes.front().history;
+    return nodes.front().shape;
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef PART_MULTIBOOLEAN_H
+#define PART_MULTIBOOLEAN_H
+
+#include <vector>
+#include <TopoDS_Shape.hxx>
+#include "PropertyTopoShape.h"
+
+namespace Part {
+
+/**
+ * The MultiBoolean class fuses or intersects any number of shapes.
+ *
+ * In balanced mode the shapes are combined pairwise as a balanced binary tree.
+ * All operations of one level of the tree are independent and run in parallel,
+ * and every operation only works on the results of two subtrees instead of an
+ * ever-growing result. Input shapes sharing sub-shapes with another input are
+ * copied first. Otherwise the shapes are combined from left to right.
+ *
+ * The face history of every input shape is joined once per level of the tree.
+ */
+class PartExport MultiBoolean
+{
+public:
+    enum Operation {
+        Fuse,
+        Common
+    };
+
+    MultiBoolean(Operation op, bool balanced = true);
+
+    /** Combines the shapes and returns the result. Throws a Base::Exception if
+     * a shape is null or an operation fails.
+     */
+    TopoDS_Shape perform(const std::vector<TopoDS_Shape>& shapes);
+    /// The face history of every input shape of the last call of perform()
+    const std::vector<ShapeHistory>& getHistory() const
+    { return history; }
+    /// The time in seconds spent on every level of the tree
+    const std::vector<float>& getLevelTimes() const
+    { return levelTimes; }
+
+private:
+    Operation operation;
+    bool balanced;
+    std::vector<ShapeHistory> history;
+    std::vector<float> levelTimes;
+};
+
+} // namespace Part
+
+#endif // PART_MULTIBOOLEAN_H
@@ -55,6 +55,7 @@
 
 #include "PartFeature.h"
 #include "PartFeaturePy.h"
+#include "ClashDetection.h"
 
 using namespace Part;
 
@@ -340,48 +341,6 @@ std::vector<Part::cutFaces> Part::findAllFacesCutBy(
 
 const bool Part::checkIntersection(const TopoDS_Shape& first, const TopoDS_Shape& second,
                                    const bool quick, const bool touch_is_intersection) {
-    Bnd_Box first_bb, second_bb;
-    BRepBndLib::Add(first, first_bb);
-    first_bb.SetGap(0);
-    BRepBndLib::Add(second, second_bb);
-    second_bb.SetGap(0);
-
-    // Note: This test fails if the objects are touching one another at zero distance
-    if (first_bb.IsOut(second_bb))
-        return false; // no intersection
-    if (quick)
-        return true; // assumed intersection
-
-    // Try harder
-    if (touch_is_intersection) {
-        // If both shapes fuse to a single solid, then they intersect
-        BRepAlgoAPI_Fuse mkFuse(first, second);
-        if (!mkFuse.IsDone())
-            return false;
-        if (mkFuse.Shape().IsNull())
-            return false;
-
-        // Did we get one or two solids?
-        TopExp_Explorer xp;
-        xp.Init(mkFuse.Shape(),TopAbs_SOLID);
-        if (xp.More()) {
-            // At least one solid
-            xp.Next();
-            return (xp.More() == Standard_False);
-        } else {
-            return false;
-        }
-    } else {
-        // If both shapes have common material, then they intersect
-        BRepAlgoAPI_Common mkCommon(first, second);
-        if (!mkCommon.IsDone())
-            return false;
-        if (mkCommon.Shape().IsNull())
-            return false;
-
-        // Did we get a solid?
-        TopExp_Explorer xp;
-        xp.Init(mkCommon.Shape(),TopAbs_SOLID);
-        return (xp.More() == Standard_True);
-    }
+    ClashDetection clash;
+    return clash.intersect(first, second, quick, touch_is_intersection);
 }
@@ -74,19 +74,21 @@ public:
      */
     const TopoDS_Shape findOriginOf(const TopoDS_Shape& reference);
 
-protected:
-    void onChanged(const App::Property* prop);
-    TopLoc_Location getLocation() const;
     /**
      * Build a history of changes
      * MakeShape: The operation that created the changes, e.g. BRepAlgoAPI_Common
      * type: The type of object we are interested in, e.g. TopAbs_FACE
      * newS: The new shape that was created by the operation
      * oldS: The original shape prior to the operation
+     * The history doesn't depend on the feature, so it can be built on a worker thread.
      */
-    ShapeHistory buildHistory(BRepBuilderAPI_MakeShape&, TopAbs_ShapeEnum type,
+    static ShapeHistory buildHistory(BRepBuilderAPI_MakeShape&, TopAbs_ShapeEnum type,
         const TopoDS_Shape& newS, const TopoDS_Shape& oldS);
-    ShapeHistory joinHistory(const ShapeHistory&, const ShapeHistory&);
+    static ShapeHistory joinHistory(const ShapeHistory&, const ShapeHistory&);
+
+protected:
+    void onChanged(const App::Property* prop);
+    TopLoc_Location getLocation() const;
 };
 
 class FilletBase : public Part::Feature
@@ -135,7 +137,7 @@ std::vector<cutFaces> findAllFacesCutBy(const TopoDS_Shape& shape,
   * Check for intersection between the two shapes. Only solids are guaranteed to work properly
   * There are two modes:
   * 1. Bounding box check only - quick but inaccurate
-  * 2. Bounding box check plus (if necessary) boolean operation - costly but accurate
+  * 2. Bounding box check plus (if necessary) face distances and boolean operation - accurate
   * Return true if the shapes intersect, false if they don't
   * The flag touch_is_intersection decides whether shapes touching at distance zero are regarded
   * as intersecting or not
@@ -144,6 +146,7 @@ std::vector<cutFaces> findAllFacesCutBy(const TopoDS_Shape& shape,
   * 2. If set to false, a true check result means that a boolean common operation will return a
   *    valid solid
   * If there is any error in the boolean operations, the check always returns false
+  * To check one shape against many others use ClashDetection directly, which caches its analysis
   */
 PartExport
 const bool checkIntersection(const TopoDS_Shape& first, const TopoDS_Shape& second,
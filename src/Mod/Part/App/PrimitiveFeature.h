@@ -43,6 +43,8 @@ public:
     /// recalculate the feature
     App::DocumentObjectExecReturn *execute(void) = 0;
     short mustExecute() const;
+    /// the primitives only build their shape from their own properties
+    bool isRecomputeThreadSafe(void) const {return true;}
     //@}
 
 protected:
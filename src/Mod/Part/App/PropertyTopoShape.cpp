@@ -38,6 +38,10 @@
 # include <TopoDS.hxx>
 # include <TopoDS_Iterator.hxx>
 # include <TopExp.hxx>
+# include <TopExp_Explorer.hxx>
+# include <TopLoc_Location.hxx>
+# include <BRep_Tool.hxx>
+# include <Poly_Triangulation.hxx>
 # include <Standard_Failure.hxx>
 # include <gp_GTrsf.hxx>
 # include <gp_Trsf.hxx>
@@ -51,6 +55,7 @@
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/Stream.h>
+#include <App/Application.h>
 #include <App/DocumentObject.h>
 
 #include "PropertyTopoShape.h"
@@ -232,8 +237,15 @@ void PropertyPartShape::Save (Base::Writer &writer) const
 {
     if(!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
+        //The file extension tells RestoreDocFile() which format is used
+        const char* name = writer.getMode("BinaryBrep") ? "PartShape.bin" : "PartShape.brp";
+        // SaveDocFile() may run on a worker thread and must not access the
+        // parameters, hence the preference is passed on as mode
+        if (App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", false))
+            writer.setMode("DirectBrep");
         writer.Stream() << writer.ind() << "<Part file=\"" 
-                        << writer.addFile("PartShape.brp", this)
+                        << writer.addFile(name, this)
                         << "\"/>" << std::endl;
     }
 }
@@ -249,6 +261,16 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
     }
 }
 
+static bool hasTriangulation(const TopoDS_Shape& shape)
+{
+    TopLoc_Location loc;
+    for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next()) {
+        if (!BRep_Tool::Triangulation(TopoDS::Face(xp.Current()), loc).IsNull())
+            return true;
+    }
+    return false;
+}
+
 void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 {
     // If the shape is empty we simply store nothing. The file size will be 0 which
@@ -256,11 +278,85 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     if (_Shape._Shape.IsNull())
         return;
     // NOTE: Cleaning the triangulation may cause problems on some algorithms like BOP
-    // Before writing to the project we clean all triangulation data to save memory
-    BRepBuilderAPI_Copy copy(_Shape._Shape);
-    const TopoDS_Shape& myShape = copy.Shape();
-    BRepTools::Clean(myShape); // remove triangulation
+    // Before writing to the project we clean all triangulation data to save memory.
+    // The shape must only be copied if there is a triangulation at all.
+    TopoDS_Shape myShape = _Shape._Shape;
+    if (hasTriangulation(myShape)) {
+        BRepBuilderAPI_Copy copy(myShape);
+        myShape = copy.Shape();
+        BRepTools::Clean(myShape); // remove triangulation
+    }
+
+    // the binary format is always written directly into the zip stream
+    if (writer.getMode("BinaryBrep")) {
+        saveToBinary(myShape, writer);
+        return;
+    }
+
+    // write directly into the zip stream or use a temporary file
+    if (writer.getMode("DirectBrep"))
+        saveToStream(myShape, writer);
+    else
+        saveToFile(myShape, writer);
+}
+
+bool PropertyPartShape::isSaveThreadSafe(const Base::Writer &writer) const
+{
+    // the temporary file used by saveToFile() is the same for all shapes
+    return writer.getMode("BinaryBrep") || writer.getMode("DirectBrep");
+}
+
+void PropertyPartShape::saveToStream(const TopoDS_Shape& myShape, Base::Writer &writer) const
+{
+    // The writer uses a fixed notation with a low precision for floating point
+    // numbers which is not suitable for the geometry. So, let OCC choose the format.
+    std::ostream& out = writer.Stream();
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize prec = out.precision();
+    out.unsetf(std::ios::floatfield);
+
+    try {
+        BRepTools::Write(myShape, out);
+    }
+    catch (Standard_Failure) {
+        Handle_Standard_Failure e = Standard_Failure::Caught();
+        App::PropertyContainer* father = this->getContainer();
+        if (father && father->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+            App::DocumentObject* obj = static_cast<App::DocumentObject*>(father);
+            Base::Console().Error("Shape of '%s' cannot be written to BRep stream: %s\n",
+                obj->Label.getValue(), e->GetMessageString());
+        }
+        else {
+            Base::Console().Error("Cannot write BRep stream: %s\n", e->GetMessageString());
+        }
+    }
+
+    out.flags(flags);
+    out.precision(prec);
+}
 
+void PropertyPartShape::saveToBinary(const TopoDS_Shape& myShape, Base::Writer &writer) const
+{
+    try {
+        TopoShape shape(myShape);
+        shape.exportBinary(writer.Stream());
+    }
+    catch (Standard_Failure) {
+        Handle_Standard_Failure e = Standard_Failure::Caught();
+        App::PropertyContainer* father = this->getContainer();
+        if (father && father->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+            App::DocumentObject* obj = static_cast<App::DocumentObject*>(father);
+            Base::Console().Error("Shape of '%s' cannot be written in binary format: %s\n",
+                obj->Label.getValue(), e->GetMessageString());
+        }
+        else {
+            Base::Console().Error("Cannot write shape in binary format: %s\n", e->GetMessageString());
+        }
+    }
+}
+
+void PropertyPartShape::saveToFile(const TopoDS_Shape& myShape, Base::Writer &writer) const
+{
     // create a temporary file and copy the content to the zip stream
     // once the tmp. filename is known use always the same because otherwise
     // we may run into some problems on the Linux platform
@@ -305,6 +401,118 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 }
 
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
+{
+    // files written with the BinaryBrep mode have the extension 'bin'
+    Base::FileInfo fi(reader.getFileName());
+    if (fi.hasExtension("bin")) {
+        loadFromBinary(reader);
+        return;
+    }
+
+    bool direct = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", false);
+    if (direct)
+        loadFromStream(reader);
+    else
+        loadFromFile(reader);
+}
+
+bool PropertyPartShape::isRestoreThreadSafe() const
+{
+    return true;
+}
+
+void PropertyPartShape::decodeDocFile(Base::Reader &reader)
+{
+    // This runs in a worker thread with the data already in memory, hence
+    // read directly from the stream and don't use the progress indicator.
+    _DecodedShape.Nullify();
+    if (reader.peek() == std::char_traits<char>::eof())
+        return;
+
+    Base::FileInfo fi(reader.getFileName());
+    if (fi.hasExtension("bin")) {
+        TopoShape shape;
+        shape.importBinary(reader);
+        _DecodedShape = shape._Shape;
+    }
+    else {
+        BRep_Builder builder;
+        reader.imbue(std::locale::classic());
+        try {
+            BRepTools::Read(_DecodedShape, reader, builder);
+        }
+        // Standard_Failure::Caught() is shared by all threads
+        catch (Standard_Failure& e) {
+            throw Base::Exception(e.GetMessageString());
+        }
+    }
+}
+
+void PropertyPartShape::applyDocFile()
+{
+    TopoDS_Shape shape = _DecodedShape;
+    _DecodedShape.Nullify();
+    setValue(shape);
+}
+
+void PropertyPartShape::loadFromStream(Base::Reader &reader)
+{
+    // If the file is empty the stored shape was already empty.
+    TopoDS_Shape shape;
+    if (reader.peek() != std::char_traits<char>::eof()) {
+        BRep_Builder builder;
+        reader.imbue(std::locale::classic());
+        try {
+            BRepTools::Read(shape, reader, builder);
+        }
+        catch (Standard_Failure) {
+            Handle_Standard_Failure e = Standard_Failure::Caught();
+            shape.Nullify();
+            Base::Console().Error("Reading BRep stream failed: %s\n", e->GetMessageString());
+        }
+
+        if (shape.IsNull()) {
+            App::PropertyContainer* father = this->getContainer();
+            if (father && father->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+                App::DocumentObject* obj = static_cast<App::DocumentObject*>(father);
+                Base::Console().Error("BRep stream with shape of '%s' seems to be empty\n",
+                    obj->Label.getValue());
+            }
+            else {
+                Base::Console().Warning("Loaded BRep stream seems to be empty\n");
+            }
+        }
+    }
+
+    setValue(shape);
+}
+
+void PropertyPartShape::loadFromBinary(Base::Reader &reader)
+{
+    // If the file is empty the stored shape was already empty.
+    TopoShape shape;
+    if (reader.peek() != std::char_traits<char>::eof()) {
+        try {
+            shape.importBinary(reader);
+        }
+        catch (const Base::Exception& e) {
+            App::PropertyContainer* father = this->getContainer();
+            if (father && father->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+                App::DocumentObject* obj = static_cast<App::DocumentObject*>(father);
+                Base::Console().Error("Binary shape of '%s' cannot be read: %s\n",
+                    obj->Label.getValue(), e.what());
+            }
+            else {
+                Base::Console().Error("Reading binary shape failed: %s\n", e.what());
+            }
+        }
+    }
+
+    setValue(shape);
+}
+
+void PropertyPartShape::loadFromFile(Base::Reader &reader)
 {
     BRep_Builder builder;
 
@@ -378,7 +586,20 @@ void PropertyShapeHistory::setValues(const std::vector<ShapeHistory>& values)
 
 PyObject *PropertyShapeHistory::getPyObject(void)
 {
-    return Py::new_reference_to(Py::None());
+    // a dict per input shape that maps the index of a sub-shape to the indices
+    // of the sub-shapes of the result it became
+    Py::List list;
+    for (std::vector<ShapeHistory>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
+        Py::Dict dict;
+        for (ShapeHistory::MapList::const_iterator jt = it->shapeMap.begin(); jt != it->shapeMap.end(); ++jt) {
+            Py::List indices;
+            for (ShapeHistory::List::const_iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt)
+                indices.append(Py::Int(*kt));
+            dict.setItem(Py::Int(jt->first), indices);
+        }
+        list.append(dict);
+    }
+    return Py::new_reference_to(list);
 }
 
 void PropertyShapeHistory::setPyObject(PyObject *value)
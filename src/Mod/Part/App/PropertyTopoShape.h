@@ -89,13 +89,27 @@ public:
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
 
+    bool isRestoreThreadSafe() const;
+    void decodeDocFile(Base::Reader &reader);
+    void applyDocFile();
+    bool isSaveThreadSafe(const Base::Writer &writer) const;
+
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     unsigned int getMemSize (void) const;
     //@}
 
+private:
+    void saveToStream(const TopoDS_Shape&, Base::Writer &writer) const;
+    void saveToFile(const TopoDS_Shape&, Base::Writer &writer) const;
+    void saveToBinary(const TopoDS_Shape&, Base::Writer &writer) const;
+    void loadFromStream(Base::Reader &reader);
+    void loadFromBinary(Base::Reader &reader);
+    void loadFromFile(Base::Reader &reader);
+
 private:
     TopoShape _Shape;
+    TopoDS_Shape _DecodedShape;
 };
 
 struct PartExport ShapeHistory {
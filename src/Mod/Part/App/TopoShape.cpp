@@ -74,6 +74,7 @@
 # include <BRepTools.hxx>
 # include <BRepTools_ReShape.hxx>
 # include <BRepTools_ShapeSet.hxx>
+# include <BinTools_ShapeSet.hxx>
 # include <BRepFill_CompatibleWires.hxx>
 # include <GCE2d_MakeSegment.hxx>
 # include <Geom2d_Line.hxx>
@@ -665,6 +666,24 @@ void TopoShape::importBrep(std::istream& str)
     }
 }
 
+void TopoShape::importBinary(std::istream& str)
+{
+    try {
+        BinTools_ShapeSet theShapeSet;
+        theShapeSet.Read(str);
+        TopoDS_Shape aShape;
+        theShapeSet.Read(aShape, str, theShapeSet.NbShapes());
+        this->_Shape = aShape;
+    }
+    // may run in a worker thread, see PropertyPartShape::decodeDocFile()
+    catch (Standard_Failure& e) {
+        throw Base::Exception(e.GetMessageString());
+    }
+    catch (const std::exception& e) {
+        throw Base::Exception(e.what());
+    }
+}
+
 void TopoShape::write(const char *FileName) const
 {
     Base::FileInfo File(FileName);
@@ -748,6 +767,16 @@ void TopoShape::exportBrep(std::ostream& out) const
     BRepTools::Write(this->_Shape, out);
 }
 
+void TopoShape::exportBinary(std::ostream& out) const
+{
+    // Like the BRep format the binary format stores shared sub-shapes,
+    // geometries and locations only once
+    BinTools_ShapeSet theShapeSet;
+    theShapeSet.Add(this->_Shape);
+    theShapeSet.Write(out);
+    theShapeSet.Write(this->_Shape, out);
+}
+
 void TopoShape::dump(std::ostream& out) const
 {
     BRepTools::Dump(this->_Shape, out);
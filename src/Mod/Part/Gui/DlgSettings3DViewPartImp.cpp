@@ -72,6 +72,7 @@ void DlgSettings3DViewPart::saveSettings()
     ui->maxDeviation->onSave();
     ui->prefCheckBox8->onSave();
     ui->prefCheckBox3->onSave();
+    ui->checkSaveTessellation->onSave();
 
     // search for Part view providers and apply the new settings
     std::vector<App::Document*> docs = App::GetApplication().getDocuments();
@@ -89,6 +90,7 @@ void DlgSettings3DViewPart::loadSettings()
     ui->maxDeviation->onRestore();
     ui->prefCheckBox8->onRestore();
     ui->prefCheckBox3->onRestore();
+    ui->checkSaveTessellation->onRestore();
 }
 
 /**
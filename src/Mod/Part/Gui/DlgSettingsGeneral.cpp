@@ -72,6 +72,7 @@ void DlgSettingsGeneral::saveSettings()
     ui->checkBooleanCheck->onSave();
     ui->checkBooleanRefine->onSave();
     ui->checkSketchBaseRefine->onSave();
+    ui->checkBooleanBalanced->onSave();
     ui->checkObjectNaming->onSave();
 }
 
@@ -84,6 +85,7 @@ void DlgSettingsGeneral::loadSettings()
     ui->checkBooleanCheck->onRestore();
     ui->checkBooleanRefine->onRestore();
     ui->checkSketchBaseRefine->onRestore();
+    ui->checkBooleanBalanced->onRestore();
     ui->checkObjectNaming->onRestore();
 }
 
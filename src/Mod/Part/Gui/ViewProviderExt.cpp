@@ -24,7 +24,12 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <list>
+# include <map>
 # include <sstream>
+# include <vector>
 # include <Bnd_Box.hxx>
 # include <Poly_Polygon3D.hxx>
 # include <BRepBndLib.hxx>
@@ -41,6 +46,7 @@
 # include <Geom_BSplineCurve.hxx>
 # include <Geom_BezierSurface.hxx>
 # include <Geom_BSplineSurface.hxx>
+# include <Geom_Surface.hxx>
 # include <GeomAPI_ProjectPointOnSurf.hxx>
 # include <GeomLProp_SLProps.hxx>
 # include <gp_Trsf.hxx>
@@ -62,6 +68,8 @@
 # include <Poly_PolygonOnTriangulation.hxx>
 # include <TColStd_Array1OfInteger.hxx>
 # include <TopTools_ListOfShape.hxx>
+# include <TopLoc_Location.hxx>
+# include <TopoDS_TShape.hxx>
 # include <Inventor/SoPickedPoint.h>
 # include <Inventor/details/SoFaceDetail.h>
 # include <Inventor/details/SoLineDetail.h>
@@ -89,11 +97,16 @@
 # include <QMenu>
 #endif
 
+#include <QtConcurrentMap>
+
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include <Base/Console.h>
 #include <Base/Parameter.h>
 #include <Base/Exception.h>
+#include <Base/Reader.h>
+#include <Base/Stream.h>
 #include <Base/TimeInfo.h>
+#include <Base/Writer.h>
 
 #include <App/Application.h>
 #include <App/Document.h>
@@ -118,6 +131,11 @@ using namespace PartGui;
 
 PROPERTY_SOURCE(PartGui::ViewProviderPartExt, Gui::ViewProviderGeometryObject)
 
+namespace {
+// Releases the faces a view provider has registered in the tessellation cache
+void releaseTessellation(const ViewProviderPartExt* owner);
+}
+
 
 //**************************************************************************
 // Construction/Destruction
@@ -130,6 +148,7 @@ const char* ViewProviderPartExt::DrawStyleEnums[]= {"Solid","Dashed","Dotted","D
 ViewProviderPartExt::ViewProviderPartExt() 
 {
     VisualTouched = true;
+    isRestoring = false;
 
     ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/View");
     unsigned long lcol = hGrp->GetUnsigned("DefaultShapeLineColor",421075455UL); // dark grey (25,25,25)
@@ -218,6 +237,7 @@ ViewProviderPartExt::~ViewProviderPartExt()
     normb->unref();
     lineset->unref();
     nodeset->unref();
+    releaseTessellation(this);
 }
 
 void ViewProviderPartExt::onChanged(const App::Property* prop)
@@ -328,7 +348,7 @@ void ViewProviderPartExt::onChanged(const App::Property* prop)
     }
     else {
         // if the object was invisible and has been changed, recreate the visual
-        if (prop == &Visibility && Visibility.getValue() && VisualTouched) 
+        if (prop == &Visibility && Visibility.getValue() && VisualTouched && !isRestoring)
             updateVisual(dynamic_cast<Part::Feature*>(pcObject)->Shape.getValue());
 
         ViewProviderGeometryObject::onChanged(prop);
@@ -535,6 +555,8 @@ bool ViewProviderPartExt::loadParameter()
     float deviation = hGrp->GetFloat("MeshDeviation",0.2);
     bool novertexnormals = hGrp->GetBool("NoPerVertexNormals",false);
     bool qualitynormals = hGrp->GetBool("QualityNormals",false);
+    // doesn't change the representation, so no update is needed
+    this->parallelTessellation = hGrp->GetBool("ParallelTessellation",true);
 
     if (Deviation.getValue() != deviation) {
         Deviation.setValue(deviation);
@@ -566,8 +588,9 @@ void ViewProviderPartExt::updateData(const App::Property* prop)
         // get the shape to show
         const TopoDS_Shape &cShape = static_cast<const Part::PropertyPartShape*>(prop)->getValue();
 
-        // calculate the visual only if visible
-        if (Visibility.getValue())
+        // calculate the visual only if visible, while restoring the document
+        // the display mesh might not be read yet
+        if (Visibility.getValue() && !isRestoring)
             updateVisual(cShape);
         else
             VisualTouched = true;
@@ -619,6 +642,411 @@ void ViewProviderPartExt::unsetEdit(int ModNum)
     }
 }
 
+namespace {
+
+// The triangulation of a face and the polygons of its edges
+struct FaceTessellation
+{
+    Handle(Poly_Triangulation) mesh;
+    // location of the triangulation relative to the face
+    TopLoc_Location location;
+    // node indexes of the polygons of the face edges in the order of TopExp_Explorer,
+    // an empty list if an edge has no polygon on the triangulation
+    std::vector< std::vector<int> > edgeNodes;
+};
+
+/**
+ * Keeps the triangulations of faces keyed by the TShape of the face and the
+ * deflection, so that unchanged faces are not meshed again after a recompute
+ * or undo. The cache holds a handle to every TShape, so that its address cannot
+ * be reused by another shape. Only the latest triangulation of a face is kept,
+ * so changing the deviation doesn't accumulate entries of faces still shown.
+ *
+ * Every view provider registers the faces it shows. The triangulations of faces
+ * that no view provider shows any more, e.g. because the shape was replaced or
+ * the document was closed, are only kept up to the size set by the parameter
+ * TessellationCacheSize (in MB), the least recently released ones are dropped first.
+ *
+ * A face can be changed in place, e.g. by Shape.fix(). Therefore a triangulation
+ * is only used while the face still has the surface and edges it was meshed with.
+ */
+class TessellationCache
+{
+public:
+    static TessellationCache& instance()
+    {
+        static TessellationCache cache;
+        return cache;
+    }
+    bool find(const TopoDS_Face& face, double deflection, FaceTessellation& tess) const
+    {
+        const TopoDS_TShape* key = face.TShape().operator->();
+        std::pair<Map::const_iterator, Map::const_iterator> range = entries.equal_range(key);
+        for (Map::const_iterator it = range.first; it != range.second; ++it) {
+            if (sameDeflection(it->second.deflection, deflection)) {
+                if (!sameGeometry(it->second, face))
+                    return false;
+                tess = it->second.tess;
+                return true;
+            }
+        }
+        return false;
+    }
+    void insert(const TopoDS_Face& face, double deflection, const FaceTessellation& tess)
+    {
+        const TopoDS_TShape* key = face.TShape().operator->();
+        std::map<const TopoDS_TShape*, Record>::iterator rec = records.find(key);
+        if (rec == records.end()) {
+            // not shown by any view provider
+            rec = records.insert(std::make_pair(key, Record())).first;
+            unused.push_front(key);
+            rec->second.unused = unused.begin();
+        }
+
+        // the entries of the face with another deflection are outdated, e.g. after
+        // the deviation has been changed, and are dropped together with the old one
+        std::pair<Map::iterator, Map::iterator> range = entries.equal_range(key);
+        for (Map::iterator jt = range.first; jt != range.second;) {
+            addSize(rec->second, -(long)jt->second.size);
+            entries.erase(jt++);
+        }
+        Map::iterator it = entries.insert(std::make_pair(key, Entry()));
+
+        TopLoc_Location loc;
+        it->second.tshape = face.TShape();
+        it->second.surface = BRep_Tool::Surface(face, loc);
+        getEdges(face, it->second.edges);
+        it->second.deflection = deflection;
+        it->second.tess = tess;
+        it->second.size = memorySize(tess);
+        addSize(rec->second, (long)it->second.size);
+        trim();
+    }
+    /// Sets the faces shown by \a owner, the faces it showed before are released
+    void setFaces(const void* owner, const std::vector<TopoDS_Face>& faces)
+    {
+        std::vector<const TopoDS_TShape*> keys;
+        keys.reserve(faces.size());
+        for (std::vector<TopoDS_Face>::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            keys.push_back(it->TShape().operator->());
+            acquire(keys.back());
+        }
+        // the faces that are still shown have been acquired again before
+        release(owner);
+        if (!keys.empty())
+            owners[owner].swap(keys);
+    }
+    /// Releases all faces shown by \a owner
+    void release(const void* owner)
+    {
+        std::map<const void*, std::vector<const TopoDS_TShape*> >::iterator it = owners.find(owner);
+        if (it == owners.end())
+            return;
+        for (std::vector<const TopoDS_TShape*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+            release(*jt);
+        owners.erase(it);
+        trim();
+    }
+
+private:
+    TessellationCache() : unusedSize(0)
+    {
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part");
+        maxUnusedSize = (std::size_t)hGrp->GetInt("TessellationCacheSize", 64) * 1024 * 1024;
+    }
+
+    // The deflection depends on the bounding box of the shape, which may differ
+    // in the last digits after the shape has been written to and read from a file
+    static bool sameDeflection(double d1, double d2)
+    {
+        return fabs(d1 - d2) <= 1e-9 * std::max(fabs(d1), fabs(d2));
+    }
+
+    struct Entry {
+        Handle(TopoDS_TShape) tshape;
+        Handle(Geom_Surface) surface;
+        std::vector<TopoDS_Shape> edges;
+        double deflection;
+        FaceTessellation tess;
+        std::size_t size;
+    };
+    // The views providers showing a face and the memory used by all its entries
+    struct Record {
+        Record() : users(0), size(0) {}
+        int users;
+        std::size_t size;
+        // position in the list of unused faces if there are no users
+        std::list<const TopoDS_TShape*>::iterator unused;
+    };
+
+    // The edges of the face independent of its location and orientation
+    static void getEdges(const TopoDS_Face& face, std::vector<TopoDS_Shape>& edges)
+    {
+        edges.clear();
+        TopoDS_Shape base = face.Located(TopLoc_Location()).Oriented(TopAbs_FORWARD);
+        TopExp_Explorer xp;
+        for (xp.Init(base,TopAbs_EDGE);xp.More();xp.Next())
+            edges.push_back(xp.Current());
+    }
+    static bool sameGeometry(const Entry& entry, const TopoDS_Face& face)
+    {
+        TopLoc_Location loc;
+        if (BRep_Tool::Surface(face, loc).operator->() != entry.surface.operator->())
+            return false;
+        std::vector<TopoDS_Shape> edges;
+        getEdges(face, edges);
+        if (edges.size() != entry.edges.size())
+            return false;
+        for (std::size_t i=0; i<edges.size(); i++) {
+            if (!edges[i].IsEqual(entry.edges[i]))
+                return false;
+        }
+        return true;
+    }
+    static std::size_t memorySize(const FaceTessellation& tess)
+    {
+        std::size_t size = sizeof(Entry);
+        if (!tess.mesh.IsNull()) {
+            size += tess.mesh->NbNodes() * sizeof(gp_Pnt);
+            size += tess.mesh->NbTriangles() * sizeof(Poly_Triangle);
+        }
+        for (std::vector< std::vector<int> >::const_iterator it = tess.edgeNodes.begin(); it != tess.edgeNodes.end(); ++it)
+            size += it->size() * sizeof(int);
+        return size;
+    }
+
+    void addSize(Record& rec, long size)
+    {
+        rec.size += size;
+        if (rec.users == 0)
+            unusedSize += size;
+    }
+    void acquire(const TopoDS_TShape* key)
+    {
+        Record& rec = records[key];
+        if (rec.users++ == 0 && rec.size > 0) {
+            unused.erase(rec.unused);
+            unusedSize -= rec.size;
+        }
+    }
+    void release(const TopoDS_TShape* key)
+    {
+        std::map<const TopoDS_TShape*, Record>::iterator it = records.find(key);
+        if (--it->second.users > 0)
+            return;
+        if (it->second.size == 0) {
+            // nothing cached for this face
+            records.erase(it);
+        }
+        else {
+            unused.push_front(key);
+            it->second.unused = unused.begin();
+            unusedSize += it->second.size;
+        }
+    }
+    // drops the least recently released faces until the unused ones fit into the limit
+    void trim()
+    {
+        while (unusedSize > maxUnusedSize && !unused.empty()) {
+            const TopoDS_TShape* key = unused.back();
+            unused.pop_back();
+            std::map<const TopoDS_TShape*, Record>::iterator it = records.find(key);
+            unusedSize -= it->second.size;
+            records.erase(it);
+            entries.erase(key);
+        }
+    }
+
+    typedef std::multimap<const TopoDS_TShape*, Entry> Map;
+    Map entries;
+    std::map<const TopoDS_TShape*, Record> records;
+    std::map<const void*, std::vector<const TopoDS_TShape*> > owners;
+    // the faces without users, the most recently released first
+    std::list<const TopoDS_TShape*> unused;
+    std::size_t unusedSize;
+    std::size_t maxUnusedSize;
+};
+
+void releaseTessellation(const ViewProviderPartExt* owner)
+{
+    TessellationCache::instance().release(owner);
+}
+
+// The deflection for the given deviation. The bounding box is computed from the
+// geometry only, so that the deflection doesn't depend on an existing triangulation.
+double getDeflection(const TopoDS_Shape& shape, double deviation)
+{
+    Bnd_Box bounds;
+    BRepBndLib::Add(shape, bounds, Standard_False);
+    bounds.SetGap(0.0);
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    return ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 * deviation;
+}
+
+// Gets the cached triangulations of all faces of the shape
+bool findTessellation(const TopoDS_Shape& shape, double deflection, std::vector<FaceTessellation>& faces)
+{
+    TessellationCache& cache = TessellationCache::instance();
+    TopExp_Explorer Ex;
+    for (Ex.Init(shape,TopAbs_FACE);Ex.More();Ex.Next()) {
+        faces.push_back(FaceTessellation());
+        if (!cache.find(TopoDS::Face(Ex.Current()), deflection, faces.back()))
+            return false;
+    }
+    return true;
+}
+
+// Writes the triangulation of a face in a compact form. The location of the triangulation
+// is applied to the nodes.
+void writeTessellation(Base::OutputStream& str, const FaceTessellation& tess)
+{
+    const TColgp_Array1OfPnt& Nodes = tess.mesh->Nodes();
+    const Poly_Array1OfTriangle& Triangles = tess.mesh->Triangles();
+    uint32_t nbNodes = (uint32_t)tess.mesh->NbNodes();
+    uint32_t nbTriangles = (uint32_t)tess.mesh->NbTriangles();
+    str << nbNodes << nbTriangles;
+
+    gp_Trsf transf = tess.location.Transformation();
+    for (uint32_t i=1; i<=nbNodes; i++) {
+        gp_Pnt p = Nodes((Standard_Integer)i).Transformed(transf);
+        str << (float)p.X() << (float)p.Y() << (float)p.Z();
+    }
+    for (uint32_t i=1; i<=nbTriangles; i++) {
+        Standard_Integer N1,N2,N3;
+        Triangles((Standard_Integer)i).Get(N1,N2,N3);
+        str << (uint32_t)N1 << (uint32_t)N2 << (uint32_t)N3;
+    }
+
+    str << (uint32_t)tess.edgeNodes.size();
+    for (std::vector< std::vector<int> >::const_iterator it = tess.edgeNodes.begin(); it != tess.edgeNodes.end(); ++it) {
+        str << (uint32_t)it->size();
+        for (std::vector<int>::const_iterator jt = it->begin(); jt != it->end(); ++jt)
+            str << (uint32_t)*jt;
+    }
+}
+
+// Reads the triangulation of a face, returns false if the data is inconsistent
+bool readTessellation(Base::InputStream& str, FaceTessellation& tess)
+{
+    uint32_t nbNodes = 0, nbTriangles = 0;
+    str >> nbNodes >> nbTriangles;
+    if (nbNodes == 0 || nbTriangles == 0)
+        return false;
+
+    Handle(Poly_Triangulation) mesh = new Poly_Triangulation((Standard_Integer)nbNodes,
+        (Standard_Integer)nbTriangles, Standard_False);
+    TColgp_Array1OfPnt& Nodes = mesh->ChangeNodes();
+    for (uint32_t i=1; i<=nbNodes; i++) {
+        float x, y, z;
+        str >> x >> y >> z;
+        Nodes((Standard_Integer)i).SetCoord(x, y, z);
+    }
+    Poly_Array1OfTriangle& Triangles = mesh->ChangeTriangles();
+    for (uint32_t i=1; i<=nbTriangles; i++) {
+        uint32_t N1, N2, N3;
+        str >> N1 >> N2 >> N3;
+        if (N1 < 1 || N1 > nbNodes || N2 < 1 || N2 > nbNodes || N3 < 1 || N3 > nbNodes)
+            return false;
+        Triangles((Standard_Integer)i).Set((Standard_Integer)N1,(Standard_Integer)N2,(Standard_Integer)N3);
+    }
+
+    uint32_t nbEdges = 0;
+    str >> nbEdges;
+    tess.edgeNodes.resize(nbEdges);
+    for (uint32_t i=0; i<nbEdges; i++) {
+        uint32_t count = 0;
+        str >> count;
+        for (uint32_t j=0; j<count; j++) {
+            uint32_t index;
+            str >> index;
+            if (index < 1 || index > nbNodes)
+                return false;
+            tess.edgeNodes[i].push_back((int)index);
+        }
+    }
+
+    tess.mesh = mesh;
+    tess.location = TopLoc_Location();
+    return true;
+}
+
+// Fills the nodes, normals and indexes of one face. The arrays point to the
+// range of the face so that the faces can be handled on several threads.
+struct FaceFillTask
+{
+    Handle(Poly_Triangulation) mesh;
+    gp_Trsf transform;
+    bool identity;
+    bool reversed;
+    int nodeOffset;
+    SbVec3f* verts;
+    SbVec3f* norms;
+    int32_t* index;
+};
+
+void fillFace(FaceFillTask& task)
+{
+    // getting size of node and triangle array of this face
+    int nbNodesInFace = task.mesh->NbNodes();
+    int nbTriInFace   = task.mesh->NbTriangles();
+    const Poly_Array1OfTriangle& Triangles = task.mesh->Triangles();
+    const TColgp_Array1OfPnt& Nodes = task.mesh->Nodes();
+
+    // transform the nodes to the place of the face. This also sets the nodes
+    // which are only referenced by the polygon of an edge but not by any triangle.
+    std::vector<gp_Pnt> points(nbNodesInFace);
+    for (int i=0;i<nbNodesInFace;i++) {
+        gp_Pnt p(Nodes(i+1));
+        if (!task.identity)
+            p.Transform(task.transform);
+        points[i] = p;
+        task.verts[i].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
+        task.norms[i].setValue(0.0f,0.0f,0.0f);
+    }
+
+    // cycling through the poly mesh
+    for (int g=1;g<=nbTriInFace;g++) {
+        // Get the triangle
+        Standard_Integer N1,N2,N3;
+        Triangles(g).Get(N1,N2,N3);
+
+        // change orientation of the triangle if the face is reversed
+        if (task.reversed) {
+            Standard_Integer tmp = N1;
+            N1 = N2;
+            N2 = tmp;
+        }
+
+        // calculating per vertex normals
+        // Calculate triangle normal
+        const gp_Pnt& V1 = points[N1-1];
+        const gp_Pnt& V2 = points[N2-1];
+        const gp_Pnt& V3 = points[N3-1];
+        gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
+        gp_Vec Normal = (v2-v1)^(v3-v1);
+
+        // add the triangle normal to the vertex normal for all points of this triangle
+        SbVec3f normal((float)Normal.X(),(float)Normal.Y(),(float)Normal.Z());
+        task.norms[N1-1] += normal;
+        task.norms[N2-1] += normal;
+        task.norms[N3-1] += normal;
+
+        // set the index vector with the 3 point indexes and the end delimiter
+        task.index[4*(g-1)]   = task.nodeOffset+N1-1;
+        task.index[4*(g-1)+1] = task.nodeOffset+N2-1;
+        task.index[4*(g-1)+2] = task.nodeOffset+N3-1;
+        task.index[4*(g-1)+3] = SO_END_FACE_INDEX;
+    }
+
+    // normalize all normals
+    for (int i=0;i<nbNodesInFace;i++)
+        task.norms[i].normalize();
+}
+
+}
+
 void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
 {
     // Clear selection
@@ -636,6 +1064,7 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
         lineset ->coordIndex .setNum(0);
         nodeset ->startIndex .setValue(0);
         VisualTouched = false;
+        releaseTessellation(this);
         return;
     }
 
@@ -646,50 +1075,99 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
 
     try {
         // calculating the deflection value
-        Bnd_Box bounds;
-        BRepBndLib::Add(cShape, bounds);
-        bounds.SetGap(0.0);
-        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
-        bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
-        Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
-            Deviation.getValue();
-
-        // create or use the mesh on the data structure
-#if OCC_VERSION_HEX >= 0x060600
-        BRepMesh_IncrementalMesh myMesh(cShape,deflection,Standard_False,0.5,Standard_True);
-#else
-        BRepMesh_IncrementalMesh myMesh(cShape,deflection);
-#endif
+        Standard_Real deflection = getDeflection(cShape, Deviation.getValue());
+
         // We must reset the location here because the transformation data
         // are set in the placement property
+        TopoDS_Shape meshShape = cShape;
         TopLoc_Location aLoc;
         cShape.Location(aLoc);
 
-        // count triangles and nodes in the mesh
+        // look up the faces in the tessellation cache and collect the edges of all faces
+        TessellationCache& cache = TessellationCache::instance();
+        std::vector<TopoDS_Face> faces;
+        std::vector<FaceTessellation> tessellations;
+        std::vector<bool> cached;
         TopExp_Explorer Ex;
         for (Ex.Init(cShape,TopAbs_FACE);Ex.More();Ex.Next()) {
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(Ex.Current()), aLoc);
-            // Note: we must also count empty faces
-            if (!mesh.IsNull()) {
-                numTriangles += mesh->NbTriangles();
-                numNodes     += mesh->NbNodes();
-                numNorms     += mesh->NbNodes();
-            }
+            const TopoDS_Face& face = TopoDS::Face(Ex.Current());
+            faces.push_back(face);
+            tessellations.push_back(FaceTessellation());
+            cached.push_back(cache.find(face, deflection, tessellations.back()));
 
             TopExp_Explorer xp;
-            for (xp.Init(Ex.Current(),TopAbs_EDGE);xp.More();xp.Next())
+            for (xp.Init(face,TopAbs_EDGE);xp.More();xp.Next())
                 faceEdges.insert(xp.Current().HashCode(INT_MAX));
-            numFaces++;
         }
+        numFaces = (int)faces.size();
+        cache.setFaces(this, faces);
 
         // get an indexed map of edges
         TopTools_IndexedMapOfShape edgeMap;
         TopExp::MapShapes(cShape, TopAbs_EDGE, edgeMap);
 
-         // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
+        // handling of the free edge that are not associated to a face
+        // Note: The assumption that if for an edge BRep_Tool::Polygon3D
+        // returns a valid object is wrong. This e.g. happens for ruled
+        // surfaces which gets created by two edges or wires.
+        // So, we have to store the hashes of the edges associated to a face.
+        // If the hash of a given edge is not in this list we know it's really
+        // a free edge.
+        bool freeEdges = false;
+        for (int i=1; i <= edgeMap.Extent(); i++) {
+            if (faceEdges.find(edgeMap(i).HashCode(INT_MAX)) == faceEdges.end())
+                freeEdges = true;
+        }
+
+        // create the mesh on the data structure only if it is not cached completely
+        if (freeEdges || std::find(cached.begin(), cached.end(), false) != cached.end()) {
+#if OCC_VERSION_HEX >= 0x060600
+            BRepMesh_IncrementalMesh myMesh(meshShape,deflection,Standard_False,0.5,
+                parallelTessellation ? Standard_True : Standard_False);
+#else
+            BRepMesh_IncrementalMesh myMesh(meshShape,deflection);
+#endif
+        }
+
+        // count triangles and nodes in the mesh
+        std::vector<int> faceNodeOffsets(numFaces), faceTriaOffsets(numFaces);
+        for (int i=0; i<numFaces; i++) {
+            FaceTessellation& tess = tessellations[i];
+            if (!cached[i]) {
+                TopLoc_Location aLoc;
+                tess.mesh = BRep_Tool::Triangulation(faces[i], aLoc);
+                if (!tess.mesh.IsNull()) {
+                    tess.location = aLoc.Predivided(faces[i].Location());
+                    TopExp_Explorer xp;
+                    for (xp.Init(faces[i],TopAbs_EDGE);xp.More();xp.Next()) {
+                        tess.edgeNodes.push_back(std::vector<int>());
+                        // this holds the indices of the edge's triangulation to the current polygon
+                        Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation
+                            (TopoDS::Edge(xp.Current()), tess.mesh, aLoc);
+                        if (aPoly.IsNull())
+                            continue; // polygon does not exist
+                        const TColStd_Array1OfInteger& indices = aPoly->Nodes();
+                        for (Standard_Integer j=indices.Lower();j <= indices.Upper();j++)
+                            tess.edgeNodes.back().push_back(indices(j));
+                    }
+                    cache.insert(faces[i], deflection, tess);
+                }
+            }
+
+            // Note: we must also count empty faces
+            faceNodeOffsets[i] = numNodes;
+            faceTriaOffsets[i] = numTriangles;
+            if (!tess.mesh.IsNull()) {
+                numTriangles += tess.mesh->NbTriangles();
+                numNodes     += tess.mesh->NbNodes();
+                numNorms     += tess.mesh->NbNodes();
+            }
+        }
+        int faceNodeOffset = numNodes;
+
+        // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
         std::map<int, std::vector<int32_t> > lineSetMap;
         std::set<int>          edgeIdxSet;
-        std::vector<int32_t>   edgeVector;
 
         // count and index the edges
         for (int i=1; i <= edgeMap.Extent(); i++) {
@@ -699,13 +1177,6 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
             const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
             TopLoc_Location aLoc;
 
-            // handling of the free edge that are not associated to a face
-            // Note: The assumption that if for an edge BRep_Tool::Polygon3D
-            // returns a valid object is wrong. This e.g. happens for ruled
-            // surfaces which gets created by two edges or wires.
-            // So, we have to store the hashes of the edges associated to a face.
-            // If the hash of a given edge is not in this list we know it's really
-            // a free edge.
             int hash = aEdge.HashCode(INT_MAX);
             if (faceEdges.find(hash) == faceEdges.end()) {
                 Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
@@ -732,127 +1203,62 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
         int32_t* index = faceset ->coordIndex  .startEditing();
         int32_t* parts = faceset ->partIndex   .startEditing();
 
-        // preset the normal vector with null vector
-        for (int i=0;i < numNorms;i++)
-            norms[i]= SbVec3f(0.0,0.0,0.0);
-
-        int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
-        for (Ex.Init(cShape, TopAbs_FACE); Ex.More(); Ex.Next(),ii++) {
-            TopLoc_Location aLoc;
-            const TopoDS_Face &actFace = TopoDS::Face(Ex.Current());
-            // get the mesh of the shape
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) continue;
-
-            // getting the transformation of the shape/face
-            gp_Trsf myTransf;
-            Standard_Boolean identity = true;
-            if (!aLoc.IsIdentity()) {
-                identity = false;
-                myTransf = aLoc.Transformation();
-            }
-
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
-            int nbTriInFace   = mesh->NbTriangles();
-            // check orientation
-            TopAbs_Orientation orient = actFace.Orientation();
-
-
-            // cycling through the poly mesh
-            const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
-            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
-            for (int g=1;g<=nbTriInFace;g++) {
-                // Get the triangle
-                Standard_Integer N1,N2,N3;
-                Triangles(g).Get(N1,N2,N3);
-
-                // change orientation of the triangle if the face is reversed
-                if ( orient != TopAbs_FORWARD ) {
-                    Standard_Integer tmp = N1;
-                    N1 = N2;
-                    N2 = tmp;
-                }
-
-                // get the 3 points of this triangle
-                gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
-
-                // transform the vertices to the place of the face
-                if (!identity) {
-                    V1.Transform(myTransf);
-                    V2.Transform(myTransf);
-                    V3.Transform(myTransf);
-                }
-                
-                // calculating per vertex normals
-                // Calculate triangle normal
-                gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
-                gp_Vec Normal = (v2-v1)^(v3-v1); 
-
-                // add the triangle normal to the vertex normal for all points of this triangle
-                norms[faceNodeOffset+N1-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-                norms[faceNodeOffset+N2-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-                norms[faceNodeOffset+N3-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-
-                // set the vertices
-                verts[faceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
-                verts[faceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
-                verts[faceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
-
-                // set the index vector with the 3 point indexes and the end delimiter
-                index[faceTriaOffset*4+4*(g-1)]   = faceNodeOffset+N1-1;
-                index[faceTriaOffset*4+4*(g-1)+1] = faceNodeOffset+N2-1;
-                index[faceTriaOffset*4+4*(g-1)+2] = faceNodeOffset+N3-1;
-                index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
-            }
-
-            parts[ii] = nbTriInFace; // new part
-
-            // handling the edges lying on this face
+        // the edges lying on a face take their points from the first face with a polygon of the edge
+        for (int ii=0; ii<numFaces; ii++) {
+            const FaceTessellation& tess = tessellations[ii];
+            if (tess.mesh.IsNull()) continue;
+            int jj = 0;
             TopExp_Explorer Exp;
-            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
-                const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
+            for(Exp.Init(faces[ii],TopAbs_EDGE);Exp.More();Exp.Next(),jj++) {
                 // get the overall index of this edge
-                int edgeIndex = edgeMap.FindIndex(curEdge);
-                edgeVector.push_back((int32_t)edgeIndex-1);
+                int edgeIndex = edgeMap.FindIndex(Exp.Current());
                 // already processed this index ?
                 if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
-                    
-                    // this holds the indices of the edge's triangulation to the current polygon
-                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, aLoc);
-                    if (aPoly.IsNull())
+                    const std::vector<int>& nodes = tess.edgeNodes[jj];
+                    if (nodes.empty())
                         continue; // polygon does not exist
-                    
-                    // getting the indexes of the edge polygon
-                    const TColStd_Array1OfInteger& indices = aPoly->Nodes();
-                    for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
-                        int nodeIndex = indices(i);
-                        int index = faceNodeOffset+nodeIndex-1;
-                        lineSetMap[edgeIndex].push_back(index);
-
-                        // usually the coordinates for this edge are already set by the
-                        // triangles of the face this edge belongs to. However, there are
-                        // rare cases where some points are only referenced by the polygon
-                        // but not by any triangle. Thus, we must apply the coordinates to
-                        // make sure that everything is properly set.
-                        gp_Pnt p(Nodes(nodeIndex));
-                        if (!identity)
-                            p.Transform(myTransf);
-                        verts[index].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
-                    }
+                    for (std::vector<int>::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+                        lineSetMap[edgeIndex].push_back(faceNodeOffsets[ii]+*it-1);
 
                     // remove the handled edge index from the set
                     edgeIdxSet.erase(edgeIndex);
                 }
             }
+        }
+
+        // fill up the nodes, normals and indexes of every face in its own range of the arrays
+        std::vector<FaceFillTask> tasks;
+        tasks.reserve(numFaces);
+        for (int ii=0; ii<numFaces; ii++) {
+            const FaceTessellation& tess = tessellations[ii];
+            if (tess.mesh.IsNull()) {
+                parts[ii] = 0;
+                continue;
+            }
 
-            edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            faceNodeOffset += nbNodesInFace;
-            faceTriaOffset += nbTriInFace;
+            FaceFillTask task;
+            task.mesh = tess.mesh;
+            // getting the transformation of the shape/face
+            TopLoc_Location aLoc = faces[ii].Location() * tess.location;
+            task.identity = aLoc.IsIdentity();
+            if (!task.identity)
+                task.transform = aLoc.Transformation();
+            // check orientation
+            task.reversed = faces[ii].Orientation() != TopAbs_FORWARD;
+            task.verts = verts + faceNodeOffsets[ii];
+            task.norms = norms + faceNodeOffsets[ii];
+            task.index = index + faceTriaOffsets[ii]*4;
+            task.nodeOffset = faceNodeOffsets[ii];
+            tasks.push_back(task);
+
+            parts[ii] = tess.mesh->NbTriangles(); // new part
         }
 
+        if (parallelTessellation)
+            QtConcurrent::blockingMap(tasks, fillFace);
+        else
+            std::for_each(tasks.begin(), tasks.end(), fillFace);
+
         // handling of the free edges
         for (int i=1; i <= edgeMap.Extent(); i++) {
             const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
@@ -895,10 +1301,6 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
             verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
         }
 
-        // normalize all normals 
-        for (int i = 0; i< numNorms ;i++)
-            norms[i].normalize();
-        
         std::vector<int32_t> lineSetCoords;
         for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
             lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
@@ -932,3 +1334,106 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
 #   endif
     VisualTouched = false;
 }
+
+std::string ViewProviderPartExt::getTessellationFileName() const
+{
+    // the object name is unique in the document, so the file name needn't be saved
+    std::string name = pcObject->getNameInDocument();
+    name += "Tessellation.bin";
+    return name;
+}
+
+void ViewProviderPartExt::Save(Base::Writer &writer) const
+{
+    Gui::ViewProviderGeometryObject::Save(writer);
+
+    // the display mesh is saved only if it is complete and up-to-date
+    if (writer.isForceXML() || !pcObject || VisualTouched)
+        return;
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    if (!hGrp->GetBool("SaveTessellation", false))
+        return;
+
+    TopoDS_Shape cShape = static_cast<Part::Feature*>(pcObject)->Shape.getValue();
+    if (cShape.IsNull())
+        return;
+    std::vector<FaceTessellation> faces;
+    if (findTessellation(cShape, getDeflection(cShape, Deviation.getValue()), faces) && !faces.empty())
+        writer.addFile(getTessellationFileName().c_str(), this);
+}
+
+void ViewProviderPartExt::Restore(Base::XMLReader &reader)
+{
+    Gui::ViewProviderGeometryObject::Restore(reader);
+
+    // if the project file doesn't contain the display mesh it's simply not read
+    if (pcObject)
+        reader.addFile(getTessellationFileName().c_str(), this);
+}
+
+void ViewProviderPartExt::SaveDocFile (Base::Writer &writer) const
+{
+    TopoDS_Shape cShape = static_cast<Part::Feature*>(pcObject)->Shape.getValue();
+    double deflection = getDeflection(cShape, Deviation.getValue());
+    std::vector<FaceTessellation> faces;
+    if (!findTessellation(cShape, deflection, faces))
+        faces.clear();
+
+    Base::OutputStream str(writer.Stream());
+    str << (uint32_t)faces.size() << deflection;
+    for (std::vector<FaceTessellation>::const_iterator it = faces.begin(); it != faces.end(); ++it)
+        writeTessellation(str, *it);
+}
+
+void ViewProviderPartExt::RestoreDocFile(Base::Reader &reader)
+{
+    Base::InputStream str(reader);
+    uint32_t numFaces = 0;
+    double deflection = 0.0;
+    str >> numFaces >> deflection;
+
+    std::vector<FaceTessellation> tessellations(numFaces);
+    for (std::vector<FaceTessellation>::iterator it = tessellations.begin(); it != tessellations.end(); ++it) {
+        if (!readTessellation(str, *it))
+            return;
+    }
+
+    // The display mesh is only used if it still fits to the shape. Otherwise the
+    // shape is meshed again when it's shown.
+    TopoDS_Shape cShape = static_cast<Part::Feature*>(pcObject)->Shape.getValue();
+    std::vector<TopoDS_Face> faces;
+    TopExp_Explorer Ex;
+    for (Ex.Init(cShape,TopAbs_FACE);Ex.More();Ex.Next())
+        faces.push_back(TopoDS::Face(Ex.Current()));
+    if (faces.size() != tessellations.size())
+        return;
+    for (std::size_t i=0; i<faces.size(); i++) {
+        int numEdges = 0;
+        TopExp_Explorer xp;
+        for (xp.Init(faces[i],TopAbs_EDGE);xp.More();xp.Next())
+            numEdges++;
+        if (numEdges != (int)tessellations[i].edgeNodes.size())
+            return;
+    }
+
+    TessellationCache& cache = TessellationCache::instance();
+    cache.setFaces(this, faces);
+    for (std::size_t i=0; i<faces.size(); i++)
+        cache.insert(faces[i], deflection, tessellations[i]);
+}
+
+void ViewProviderPartExt::startRestoring()
+{
+    // the visual is computed when the display mesh has been read
+    isRestoring = true;
+    Gui::ViewProviderGeometryObject::startRestoring();
+}
+
+void ViewProviderPartExt::finishRestoring()
+{
+    isRestoring = false;
+    if (Visibility.getValue() && VisualTouched)
+        updateVisual(static_cast<Part::Feature*>(pcObject)->Shape.getValue());
+    Gui::ViewProviderGeometryObject::finishRestoring();
+}
@@ -90,6 +90,20 @@ public:
 
     virtual void updateData(const App::Property*);
 
+    /** @name Save/restore the display mesh */
+    //@{
+    void Save (Base::Writer &writer) const;
+    void Restore(Base::XMLReader &reader);
+    void SaveDocFile (Base::Writer &writer) const;
+    void RestoreDocFile(Base::Reader &reader);
+    //@}
+
+    /** @name Restoring view provider from document load */
+    //@{
+    virtual void startRestoring();
+    virtual void finishRestoring();
+    //@}
+
       /** @name Selection handling
       * This group of methodes do the selection handling.
       * Here you can define how the selection for your ViewProfider
@@ -119,6 +133,7 @@ protected:
     virtual void onChanged(const App::Property* prop);
     bool loadParameter();
     void updateVisual(const TopoDS_Shape &);
+    std::string getTessellationFileName() const;
 
     // nodes for the data representation
     SoMaterialBinding * pcShapeBind;
@@ -136,11 +151,13 @@ protected:
     SoBrepPointSet    * nodeset;
 
     bool VisualTouched;
+    bool isRestoring;
 
 private:
     // settings stuff
     bool noPerVertexNormals;
     bool qualityNormals;
+    bool parallelTessellation;
     static App::PropertyFloatConstraint::Constraints sizeRange;
     static App::PropertyFloatConstraint::Constraints tessRange;
     static const char* LightingEnums[];
@@ -19,7 +19,7 @@
 #   USA                                                                   *
 #**************************************************************************
 
-import FreeCAD, os, sys, unittest, Part
+import FreeCAD, os, sys, time, unittest, tempfile, Part
 App = FreeCAD
 
 #---------------------------------------------------------------------------
@@ -35,7 +35,252 @@ class PartTestCases(unittest.TestCase):
 		self.Box = App.ActiveDocument.addObject("Part::Box","Box")
 		self.Doc.recompute()
 		self.failUnless(len(self.Box.Shape.Faces)==6)
-		
+
+	def testBinaryBrep(self):
+		self.Box = self.Doc.addObject("Part::Box","Box")
+		self.Doc.recompute()
+		volume = self.Box.Shape.Volume
+		self.Doc.SaveModes = ["BinaryBrep"]
+		self.failUnless(self.Doc.SaveModes == ["BinaryBrep"])
+		name = os.path.join(tempfile.gettempdir(), "PartBinaryBrep.FCStd")
+		self.Doc.saveAs(name)
+		FreeCAD.closeDocument("PartTest")
+		# the document name is taken from the file name
+		doc = FreeCAD.openDocument(name)
+		shape = doc.getObject("Box").Shape
+		self.failUnless(len(shape.Faces)==6)
+		self.failUnless(abs(shape.Volume-volume) < 1e-7)
+		FreeCAD.closeDocument(doc.Name)
+		self.Doc = FreeCAD.newDocument("PartTest")
+
+	def testBinaryBrepSize(self):
+		# compare file size and save/load time of the ASCII and the binary BRep format
+		shapes = []
+		for i in range(20):
+			shapes.append(Part.makeSphere(5,FreeCAD.Vector(20*i,0,0)))
+			shapes.append(Part.makeCylinder(2,10,FreeCAD.Vector(20*i,20,0)))
+		feature = self.Doc.addObject("Part::Feature","Shapes")
+		feature.Shape = Part.makeCompound(shapes)
+		volume = feature.Shape.Volume
+		faces = len(feature.Shape.Faces)
+		files = {}
+		for mode in ["Ascii", "BinaryBrep"]:
+			self.Doc.SaveModes = [mode] if mode == "BinaryBrep" else []
+			name = os.path.join(tempfile.gettempdir(), "PartBrepSize%s.FCStd" % mode)
+			start = time.time()
+			self.Doc.saveAs(name)
+			files[mode] = (name, time.time() - start)
+		# a project file cannot be opened twice
+		FreeCAD.closeDocument("PartTest")
+		for mode, (name, saveTime) in files.items():
+			start = time.time()
+			doc = FreeCAD.openDocument(name)
+			loadTime = time.time() - start
+			shape = doc.getObject("Shapes").Shape
+			self.failUnless(len(shape.Faces) == faces)
+			self.failUnless(abs(shape.Volume-volume) < 1e-7)
+			FreeCAD.closeDocument(doc.Name)
+			FreeCAD.Console.PrintLog("%s: %d bytes, saved in %.3f s, loaded in %.3f s\n"
+				% (mode, os.path.getsize(name), saveTime, loadTime))
+			os.remove(name)
+		self.Doc = FreeCAD.newDocument("PartTest")
+
+	def testParallelRestore(self):
+		for i in range(5):
+			box = self.Doc.addObject("Part::Box","Box")
+			box.Length = i+1
+		self.Doc.recompute()
+		name = os.path.join(tempfile.gettempdir(), "PartParallelRestore.FCStd")
+		self.Doc.saveAs(name)
+		FreeCAD.closeDocument("PartTest")
+		grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+		grp.SetBool("ParallelRestore", True)
+		try:
+			doc = FreeCAD.openDocument(name)
+		finally:
+			grp.RemBool("ParallelRestore")
+		for obj in doc.Objects:
+			self.failUnless(abs(obj.Shape.Volume-obj.Length*100.0) < 1e-7)
+		FreeCAD.closeDocument(doc.Name)
+		self.Doc = FreeCAD.newDocument("PartTest")
+
+	def testParallelRecompute(self):
+		# the primitives are built on worker threads, the boolean in the main thread
+		boxes = []
+		for i in range(4):
+			box = self.Doc.addObject("Part::Box","Box")
+			box.Length = i+1
+			boxes.append(box)
+		cut = self.Doc.addObject("Part::Cut","Cut")
+		cut.Base = boxes[3]
+		cut.Tool = boxes[0]
+		self.Doc.RecomputeMode = 1
+		self.Doc.recompute()
+		self.Doc.RecomputeMode = 0
+		for box in boxes:
+			self.failUnless(abs(box.Shape.Volume-box.Length*100.0) < 1e-7)
+		self.failUnless(abs(cut.Shape.Volume-300.0) < 1e-7)
+
+	def testParallelSave(self):
+		for i in range(5):
+			box = self.Doc.addObject("Part::Box","Box")
+			box.Length = i+1
+		self.Doc.recompute()
+		self.Doc.SaveModes = ["DirectBrep"]
+		name = os.path.join(tempfile.gettempdir(), "PartParallelSave.FCStd")
+		grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+		grp.SetBool("ParallelSave", True)
+		grp.SetString("UncompressedFileTypes", "brp")
+		try:
+			self.Doc.saveAs(name)
+		finally:
+			grp.RemBool("ParallelSave")
+			grp.RemString("UncompressedFileTypes")
+		FreeCAD.closeDocument("PartTest")
+		doc = FreeCAD.openDocument(name)
+		for obj in doc.Objects:
+			self.failUnless(abs(obj.Shape.Volume-obj.Length*100.0) < 1e-7)
+		FreeCAD.closeDocument(doc.Name)
+		self.Doc = FreeCAD.newDocument("PartTest")
+
+	def testSaveTessellation(self):
+		if not FreeCAD.GuiUp:
+			return
+		import zipfile
+		for i in range(3):
+			box = self.Doc.addObject("Part::Box","Box")
+			box.Length = i+1
+		self.Doc.recompute()
+		for obj in self.Doc.Objects:
+			obj.ViewObject.ShapeColor = (1.0,0.0,0.0)
+		name = os.path.join(tempfile.gettempdir(), "PartSaveTessellation.FCStd")
+		part = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+		part.SetBool("SaveTessellation", True)
+		try:
+			self.Doc.saveAs(name)
+		finally:
+			part.RemBool("SaveTessellation")
+		FreeCAD.closeDocument("PartTest")
+		# the display meshes are registered while GuiDocument.xml is read
+		archive = zipfile.ZipFile(name)
+		files = archive.namelist()
+		archive.close()
+		self.failUnless("BoxTessellation.bin" in files)
+		self.failUnless(files.index("BoxTessellation.bin") > files.index("GuiDocument.xml"))
+
+		grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+		for parallel in (False, True):
+			grp.SetBool("ParallelRestore", parallel)
+			try:
+				doc = FreeCAD.openDocument(name)
+			finally:
+				grp.RemBool("ParallelRestore")
+			for obj in doc.Objects:
+				self.failUnless(abs(obj.Shape.Volume-obj.Length*100.0) < 1e-7)
+				self.failUnless(obj.ViewObject.ShapeColor[0:3] == (1.0,0.0,0.0))
+			FreeCAD.closeDocument(doc.Name)
+		os.remove(name)
+		self.Doc = FreeCAD.newDocument("PartTest")
+
+	def testSaveStoredGuiDocument(self):
+		# GuiDocument.xml adds the files of the colors and display meshes while it is written
+		if not FreeCAD.GuiUp:
+			return
+		import zipfile
+		box = self.Doc.addObject("Part::Box","Box")
+		self.Doc.recompute()
+		colors = [(0.1*i,0.0,1.0,0.0) for i in range(6)]
+		box.ViewObject.DiffuseColor = colors
+		name = os.path.join(tempfile.gettempdir(), "PartSaveStored.FCStd")
+		grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+		part = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+		for parallel in (False, True):
+			grp.SetBool("ParallelSave", parallel)
+			grp.SetString("UncompressedFileTypes", "xml")
+			part.SetBool("SaveTessellation", True)
+			try:
+				self.Doc.saveAs(name)
+			finally:
+				grp.RemBool("ParallelSave")
+				grp.RemString("UncompressedFileTypes")
+				part.RemBool("SaveTessellation")
+			archive = zipfile.ZipFile(name)
+			files = archive.namelist()
+			archive.close()
+			self.failUnless("DiffuseColor" in files)
+			self.failUnless("BoxTessellation.bin" in files)
+			FreeCAD.closeDocument(self.Doc.Name)
+			self.Doc = FreeCAD.openDocument(name)
+			box = self.Doc.Box
+			self.failUnless(len(box.ViewObject.DiffuseColor) == 6)
+			for c, d in zip(colors, box.ViewObject.DiffuseColor):
+				self.failUnless(abs(c[0]-d[0]) < 0.01)
+		FreeCAD.closeDocument(self.Doc.Name)
+		os.remove(name)
+		self.Doc = FreeCAD.newDocument("PartTest")
+
+	def multiBoolean(self, type, balanced):
+		# placed copies of one box share their sub-shapes
+		box = Part.makeBox(10,10,10)
+		shapes = []
+		for i in range(4):
+			feature = self.Doc.addObject("Part::Feature","Box")
+			feature.Shape = box
+			feature.Placement.Base = FreeCAD.Vector(2*i,0,0)
+			shapes.append(feature)
+		multi = self.Doc.addObject(type,"Multi")
+		multi.Shapes = shapes
+		grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part/Boolean")
+		grp.SetBool("BalancedMultiOperand", balanced)
+		try:
+			self.Doc.recompute()
+		finally:
+			grp.RemBool("BalancedMultiOperand")
+		history = multi.History
+		result = (multi.Shape.Volume, len(multi.Shape.Faces), len(history), [len(i) for i in history])
+		for obj in self.Doc.Objects:
+			self.Doc.removeObject(obj.Name)
+		return result
+
+	def testMultiFuse(self):
+		balanced = self.multiBoolean("Part::MultiFuse", True)
+		serial = self.multiBoolean("Part::MultiFuse", False)
+		self.failUnless(abs(balanced[0]-1600.0) < 1e-7)
+		self.failUnless(abs(serial[0]-1600.0) < 1e-7)
+		self.failUnless(balanced[1:] == serial[1:])
+		self.failUnless(balanced[2] == 4)
+
+	def testMultiCommon(self):
+		balanced = self.multiBoolean("Part::MultiCommon", True)
+		serial = self.multiBoolean("Part::MultiCommon", False)
+		self.failUnless(abs(balanced[0]-400.0) < 1e-7)
+		self.failUnless(abs(serial[0]-400.0) < 1e-7)
+		self.failUnless(balanced[1:] == serial[1:])
+		self.failUnless(balanced[2] == 4)
+
+	def testCheckIntersection(self):
+		box = Part.makeBox(10,10,10)
+		apart = Part.makeBox(10,10,10,FreeCAD.Vector(20,0,0))
+		touching = Part.makeBox(10,10,10,FreeCAD.Vector(10,0,0))
+		overlapping = Part.makeBox(10,10,10,FreeCAD.Vector(5,5,5))
+		contained = Part.makeBox(2,2,2,FreeCAD.Vector(4,4,4))
+		for touch in (False, True):
+			self.failUnless(not Part.checkIntersection(box,apart,False,touch))
+			self.failUnless(Part.checkIntersection(box,overlapping,False,touch))
+			self.failUnless(Part.checkIntersection(box,contained,False,touch))
+			self.failUnless(Part.checkIntersection(contained,box,False,touch))
+		self.failUnless(Part.checkIntersection(box,touching,False,True))
+		self.failUnless(not Part.checkIntersection(box,touching,False,False))
+		# touching only at an edge or a vertex doesn't fuse the shapes to one solid
+		edge = Part.makeBox(10,10,10,FreeCAD.Vector(10,10,0))
+		vertex = Part.makeBox(10,10,10,FreeCAD.Vector(10,10,10))
+		for touch in (False, True):
+			self.failUnless(not Part.checkIntersection(box,edge,False,touch))
+			self.failUnless(not Part.checkIntersection(box,vertex,False,touch))
+		# the bounding boxes of touching shapes overlap
+		self.failUnless(Part.checkIntersection(box,touching,True,False))
+		self.failUnless(not Part.checkIntersection(box,apart,True,False))
+
 	def tearDown(self):
 		#closing doc
 		FreeCAD.closeDocument("PartTest")
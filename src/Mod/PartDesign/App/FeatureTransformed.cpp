@@ -46,8 +46,10 @@
 #include <Base/Console.h>
 #include <Base/Exception.h>
 #include <Base/Parameter.h>
+#include <Base/TimeInfo.h>
 #include <App/Application.h>
 #include <Mod/Part/App/modelRefine.h>
+#include <Mod/Part/App/ClashDetection.h>
 
 using namespace PartDesign;
 
@@ -55,7 +57,7 @@ namespace PartDesign {
 
 PROPERTY_SOURCE(PartDesign::Transformed, PartDesign::Feature)
 
-Transformed::Transformed() : rejected(0)
+Transformed::Transformed() : rejected(0), overlapTime(0.0f), booleanTime(0.0f)
 {
     ADD_PROPERTY(Originals,(0));
     Originals.setSize(0);
@@ -113,6 +115,8 @@ short Transformed::mustExecute() const
 App::DocumentObjectExecReturn *Transformed::execute(void)
 {
     rejected.clear();
+    overlapTime = 0.0f;
+    booleanTime = 0.0f;
 
     std::vector<App::DocumentObject*> originals = Originals.getValues();
     if (originals.empty()) // typically InsideMultiTransform
@@ -149,6 +153,10 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
     std::set<std::vector<gp_Trsf>::const_iterator> nointersect_trsfms;
     std::set<std::vector<gp_Trsf>::const_iterator> overlapping_trsfms;
 
+    // The support and the original are checked against many transformed shapes,
+    // the clash detection analyses each of them only once
+    Part::ClashDetection clash;
+
     // NOTE: It would be possible to build a compound from all original addShapes/subShapes and then
     // transform the compounds as a whole. But we choose to apply the transformations to each
     // Original separately. This way it is easier to discover what feature causes a fuse/cut
@@ -180,6 +188,9 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
         std::vector<std::vector<gp_Trsf>::const_iterator> v_transformations;
         std::vector<TopoDS_Shape> v_transformedShapes;
 
+        std::vector<std::vector<gp_Trsf>::const_iterator> all_transformations;
+        std::vector<TopoDS_Shape> all_transformedShapes;
+
         std::vector<gp_Trsf>::const_iterator t = transformations.begin();
         t++; // Skip first transformation, which is always the identity transformation
         for (; t != transformations.end(); t++) {
@@ -194,28 +205,38 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
             if (!mkTrf.IsDone())
                 return new App::DocumentObjectExecReturn("Transformation failed", (*o));
 
-            // Check for intersection with support
-            if (!Part::checkIntersection(support, mkTrf.Shape(), false, true)) {
+            all_transformations.push_back(t);
+            all_transformedShapes.push_back(mkTrf.Shape());
+        }
+
+        Base::TimeInfo overlapStart;
+
+        // Check for intersection with support
+        std::vector<bool> intersects = clash.intersect(support, all_transformedShapes, true);
+        for (std::size_t i = 0; i < all_transformedShapes.size(); i++) {
+            if (!intersects[i]) {
 #ifdef FC_DEBUG // do not write this in release mode because a message appears already in the task view
                 Base::Console().Warning("Transformed shape does not intersect support %s: Removed\n", (*o)->getNameInDocument());
 #endif
-                nointersect_trsfms.insert(t);
+                nointersect_trsfms.insert(all_transformations[i]);
             } else {
-                v_transformations.push_back(t);
-                v_transformedShapes.push_back(mkTrf.Shape());
+                v_transformations.push_back(all_transformations[i]);
+                v_transformedShapes.push_back(all_transformedShapes[i]);
                 // Note: Transformations that do not intersect the support are ignored in the overlap tests
             }
         }
 
-        if (v_transformedShapes.empty())
+        if (v_transformedShapes.empty()) {
+            overlapTime += Base::TimeInfo::diffTimeF(overlapStart, Base::TimeInfo());
             break; // Skip the overlap check and go on to next original
+        }
 
         // Check for overlapping of the original and the transformed shapes, and remove the overlapping transformations
         if (this->getTypeId() != PartDesign::MultiTransform::getClassTypeId()) {
             // If there is only one transformed feature, we allow an overlap (though it might seem
             // illogical to the user why we allow overlapping shapes in this case!)
             if (v_transformedShapes.size() > 1)
-                if (Part::checkIntersection(shape, v_transformedShapes.front(), false, false)) {
+                if (clash.intersect(shape, v_transformedShapes.front(), false, false)) {
                     // For single transformations, if one overlaps, all overlap, as long as we have uniform increments
                     overlapping_trsfms.insert(v_transformations.begin(),v_transformations.end());
                     v_transformedShapes.clear();
@@ -223,47 +244,28 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
         } else {
             // For MultiTransform, just checking the first transformed shape is not sufficient - any two
             // features might overlap, even if the original and the first shape don't overlap!
-
-            std::set<std::vector<TopoDS_Shape>::iterator> rejected_iterators;
-
-            std::vector<TopoDS_Shape>::iterator s1 = v_transformedShapes.begin();
-            std::vector<TopoDS_Shape>::iterator s2 = s1;
-            s2++;
-            std::vector<std::vector<gp_Trsf>::const_iterator>::const_iterator t1 = v_transformations.begin();
-            std::vector<std::vector<gp_Trsf>::const_iterator>::const_iterator t2 = t1;
-            t2++;
-            for (; s2 != v_transformedShapes.end();) {
-                // Check intersection with the original
-                if (Part::checkIntersection(shape, *s1, false, false)) {
-                    rejected_iterators.insert(s1);
-                    overlapping_trsfms.insert(*t1);
-                }
-                // Check intersection with other transformations
-                for (; s2 != v_transformedShapes.end(); s2++, t2++)
-                    if (Part::checkIntersection(*s1, *s2, false, false)) {
-                        rejected_iterators.insert(s1);
-                        rejected_iterators.insert(s2);
-                        overlapping_trsfms.insert(*t1);
-                        overlapping_trsfms.insert(*t2);
-                    }
-                s1++;
-                s2 = s1;
-                s2++;
-                t1++;
-                t2 = t1;
-                t2++;
-            }
-            // Check intersection of last transformation with the original
-            if (Part::checkIntersection(shape, *s1, false, false)) {
-                rejected_iterators.insert(s1);
-                overlapping_trsfms.insert(*t1);
+            // The original is added as last shape, only pairs of shapes with overlapping bounding
+            // boxes are tested
+            std::vector<TopoDS_Shape> shapes(v_transformedShapes);
+            shapes.push_back(shape);
+            std::vector<std::pair<int, int> > clashes = clash.intersect(shapes, false);
+
+            std::set<int> rejected_indices;
+            for (std::vector<std::pair<int, int> >::const_iterator it = clashes.begin(); it != clashes.end(); ++it) {
+                // The original has the highest index and thus can only be the second of a pair
+                rejected_indices.insert(it->first);
+                if (it->second < (int)v_transformedShapes.size())
+                    rejected_indices.insert(it->second);
             }
 
-            for (std::set<std::vector<TopoDS_Shape>::iterator>::reverse_iterator it = rejected_iterators.rbegin();
-                 it != rejected_iterators.rend(); it++)
-                v_transformedShapes.erase(*it);
+            for (std::set<int>::reverse_iterator it = rejected_indices.rbegin(); it != rejected_indices.rend(); it++) {
+                overlapping_trsfms.insert(v_transformations[*it]);
+                v_transformedShapes.erase(v_transformedShapes.begin() + *it);
+            }
         }
 
+        overlapTime += Base::TimeInfo::diffTimeF(overlapStart, Base::TimeInfo());
+
         if (v_transformedShapes.empty())
             break; // Skip the boolean operation and go on to next original
 
@@ -275,6 +277,7 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
             builder.Add(transformedShapes, *s);
 
         // Fuse/Cut the compounded transformed shapes with the support
+        Base::TimeInfo booleanStart;
         TopoDS_Shape result;
 
         if (fuse) {
@@ -294,6 +297,7 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
             result = mkCut.Shape();
             result = refineShapeIfActive(result);
         }
+        booleanTime += Base::TimeInfo::diffTimeF(booleanStart, Base::TimeInfo());
 
         support = result; // Use result of this operation for fuse/cut of next original
     }
@@ -78,12 +78,18 @@ public:
       * because they did not ovelap with the support
       */
     const std::list<gp_Trsf> getRejectedTransformations(void) { return rejected; }
+    /// returns the time in seconds the last execute spent checking for overlaps
+    float getOverlapTime(void) const { return overlapTime; }
+    /// returns the time in seconds the last execute spent in the fuse/cut with the support
+    float getBooleanTime(void) const { return booleanTime; }
 
 protected:
     virtual void positionBySupport(void);
     TopoDS_Shape refineShapeIfActive(const TopoDS_Shape&) const;
 
     std::list<gp_Trsf> rejected;
+    float overlapTime;
+    float booleanTime;
 };
 
 } //namespace PartDesign
@@ -213,6 +213,10 @@ void ViewProviderTransformed::recomputeFeature(void)
         msg = msg.arg(QString::fromLatin1("<font color='green'>%1<br/></font>"));
         msg = msg.arg(QObject::tr("Transformation succeeded"));
     }
+    msg += QString::fromLatin1("<font color='grey'>%1<br/></font>")
+        .arg(QObject::tr("Overlap check: %1 s, boolean operation: %2 s")
+            .arg(pcTransformed->getOverlapTime(), 0, 'f', 2)
+            .arg(pcTransformed->getBooleanTime(), 0, 'f', 2));
     signalDiagnosis(msg);
 
     TopoDS_Shape shape;
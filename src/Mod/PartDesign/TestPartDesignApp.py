@@ -19,7 +19,7 @@
 #   USA                                                                   *
 #**************************************************************************
 
-import FreeCAD, os, sys, unittest, Sketcher, PartDesign, TestSketcherApp
+import FreeCAD, os, sys, unittest, Part, Sketcher, PartDesign, TestSketcherApp
 App = FreeCAD
 
 #---------------------------------------------------------------------------
@@ -44,3 +44,75 @@ class PartDesignPadTestCases(unittest.TestCase):
 		#closing doc
 		FreeCAD.closeDocument("PartDesignTest")
 		#print ("omit clos document for debuging")
+
+
+def CreateRectangle(SketchFeature, x1, y1, x2, y2):
+	SketchFeature.addGeometry(Part.Line(App.Vector(x1,y1,0),App.Vector(x2,y1,0)))
+	SketchFeature.addGeometry(Part.Line(App.Vector(x2,y1,0),App.Vector(x2,y2,0)))
+	SketchFeature.addGeometry(Part.Line(App.Vector(x2,y2,0),App.Vector(x1,y2,0)))
+	SketchFeature.addGeometry(Part.Line(App.Vector(x1,y2,0),App.Vector(x1,y1,0)))
+	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',0,2,1,1))
+	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',1,2,2,1))
+	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',2,2,3,1))
+	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',3,2,0,1))
+
+
+class PartDesignPatternTestCases(unittest.TestCase):
+	def setUp(self):
+		# a plate of 100x40x5 with a block of 10x10x5 on top of it in one corner
+		self.Doc = FreeCAD.newDocument("PartDesignTest")
+		self.PlateSketch = self.Doc.addObject('Sketcher::SketchObject','SketchPlate')
+		CreateRectangle(self.PlateSketch, 0, 0, 100, 40)
+		self.Plate = self.Doc.addObject("PartDesign::Pad","Plate")
+		self.Plate.Sketch = self.PlateSketch
+		self.Plate.Length = 5
+		self.Doc.recompute()
+		top = [i for i, f in enumerate(self.Plate.Shape.Faces) if f.BoundBox.ZMin > 4.99][0]
+		self.BlockSketch = self.Doc.addObject('Sketcher::SketchObject','SketchBlock')
+		self.BlockSketch.Support = (self.Plate, ["Face%d" % (top+1)])
+		CreateRectangle(self.BlockSketch, 0, 0, 10, 10)
+		self.Block = self.Doc.addObject("PartDesign::Pad","Block")
+		self.Block.Sketch = self.BlockSketch
+		self.Block.Length = 5
+		self.Doc.recompute()
+		self.failUnless(abs(self.Block.Shape.Volume - 20500) < 0.001)
+
+	def checkPattern(self, pattern, length, blocks):
+		# with a length of 40, 20 and 10 the instances along the x axis are separate,
+		# touch each other or overlap. Only overlapping instances are rejected.
+		for l in (40, 20, 10):
+			length.Length = l
+			self.Doc.recompute()
+			if l > 10:
+				self.failUnless("Invalid" not in pattern.State)
+				self.failUnless(len(pattern.Shape.Solids) == 1)
+				self.failUnless(pattern.Shape.isValid())
+				self.failUnless(abs(pattern.Shape.Volume - (20000 + blocks * 500)) < 0.001)
+			else:
+				self.failUnless("Invalid" in pattern.State)
+				self.failUnless(abs(pattern.Shape.Volume - 20500) < 0.001)
+
+	def testLinearPattern(self):
+		self.Pattern = self.Doc.addObject("PartDesign::LinearPattern","LinearPattern")
+		self.Pattern.Originals = [self.Block]
+		self.Pattern.Direction = (self.BlockSketch, ["H_Axis"])
+		self.Pattern.Occurrences = 3
+		self.checkPattern(self.Pattern, self.Pattern, 3)
+
+	def testMultiTransform(self):
+		# the instances of different rows are checked pairwise
+		self.Rows = self.Doc.addObject("PartDesign::LinearPattern","Rows")
+		self.Rows.Direction = (self.BlockSketch, ["H_Axis"])
+		self.Rows.Occurrences = 3
+		self.Columns = self.Doc.addObject("PartDesign::LinearPattern","Columns")
+		self.Columns.Direction = (self.BlockSketch, ["V_Axis"])
+		self.Columns.Length = 20
+		self.Columns.Occurrences = 2
+		self.Pattern = self.Doc.addObject("PartDesign::MultiTransform","MultiTransform")
+		self.Pattern.Originals = [self.Block]
+		self.Pattern.Transformations = [self.Rows, self.Columns]
+		self.checkPattern(self.Pattern, self.Rows, 6)
+
+	def tearDown(self):
+		#closing doc
+		FreeCAD.closeDocument("PartDesignTest")
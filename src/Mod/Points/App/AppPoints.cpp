@@ -61,6 +61,7 @@ void PointsExport initPoints()
 
     // add data types
     Points::Feature               ::init();
+    Points::Scan                  ::init();
     Points::FeaturePython         ::init();
     Points::Export                ::init();
     Points::ImportAscii           ::init();
@@ -28,19 +28,14 @@
 #include <Base/Console.h>
 #include <Base/Interpreter.h>
 #include <Base/FileInfo.h>
+#include <CXX/Objects.hxx>
 
 #include <App/Application.h>
 #include <App/Document.h>
 #include <App/DocumentObject.h>
+#include <App/DocumentObjectPy.h>
 #include <App/Property.h>
 
-// PCL test
-#ifdef HAVE_PCL_IO
-#  include <iostream>
-#  include <pcl/io/ply_io.h>
-#  include <pcl/point_types.h>
-#endif
-
 #include "Points.h"
 #include "PointsPy.h"
 #include "PointsAlgos.h"
@@ -49,6 +44,39 @@
 using namespace Points;
 
 /* module functions */
+
+/** Reads the points of \a file into a new feature of \a pcDoc. A Points::Scan
+ * feature is created if the file provides intensities or normals.
+ */
+static void importPoints(App::Document* pcDoc, const Base::FileInfo& file)
+{
+    Points::PointKernel pkTemp;
+    std::vector<float> intensity;
+    std::vector<Base::Vector3f> normals;
+    if (file.hasExtension("ply"))
+        PointsAlgos::LoadPly(pkTemp, file.filePath().c_str(), &intensity, &normals);
+    else if (file.hasExtension("fcpc"))
+        PointsAlgos::LoadChunked(pkTemp, file.filePath().c_str(), &intensity, &normals);
+    else
+        pkTemp.load(file.filePath().c_str());
+
+    if (intensity.empty() && normals.empty()) {
+        Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
+        pcFeature->Points.setValue( pkTemp );
+    }
+    else {
+        Points::Scan *pcFeature = (Points::Scan *)pcDoc->addObject("Points::Scan", file.fileNamePure().c_str());
+        pcFeature->Points.setValue( pkTemp );
+        pcFeature->Intensity.setValues( intensity );
+        pcFeature->Normal.setValues( normals );
+    }
+}
+
+static bool isPointsFile(const Base::FileInfo& file)
+{
+    return file.hasExtension("asc") || file.hasExtension("ply") || file.hasExtension("fcpc");
+}
+
 static PyObject *
 open(PyObject *self, PyObject *args)
 {
@@ -66,31 +94,11 @@ open(PyObject *self, PyObject *args)
         if (file.extension() == "")
             Py_Error(Base::BaseExceptionFreeCADError,"no file ending");
 
-        if (file.hasExtension("asc")) {
+        if (isPointsFile(file)) {
             // create new document and add Import feature
             App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-            pkTemp.load(EncodedName.c_str());
-            pcFeature->Points.setValue( pkTemp );
-
+            importPoints(pcDoc, file);
         }
-#ifdef HAVE_PCL_IO
-        else if (file.hasExtension("ply")) {
-            // create new document import
-            App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-
-            // pcl test
-            pcl::PointCloud<pcl::PointXYZRGB> cloud_in;
-            pcl::io::loadPLYFile<pcl::PointXYZRGB>(EncodedName.c_str(),cloud_in); 
-
-            for (pcl::PointCloud<pcl::PointXYZRGB>::const_iterator it = cloud_in.begin();it!=cloud_in.end();++it)
-                pkTemp.push_back(Base::Vector3d(it->x,it->y,it->z));
-            pcFeature->Points.setValue( pkTemp );
-        }
-#endif
         else {
             Py_Error(Base::BaseExceptionFreeCADError,"unknown file ending");
         }
@@ -117,40 +125,52 @@ insert(PyObject *self, PyObject *args)
         if (file.extension() == "")
             Py_Error(Base::BaseExceptionFreeCADError,"no file ending");
 
-        if (file.hasExtension("asc")) {
+        if (isPointsFile(file)) {
             // add Import feature
             App::Document *pcDoc = App::GetApplication().getDocument(DocName);
             if (!pcDoc) {
                 pcDoc = App::GetApplication().newDocument(DocName);
             }
 
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-            pkTemp.load(EncodedName.c_str());
-            pcFeature->Points.setValue( pkTemp );
+            importPoints(pcDoc, file);
         }
-#ifdef HAVE_PCL_IO
-        else if (file.hasExtension("ply")) {
-            App::Document *pcDoc = App::GetApplication().getDocument(DocName);
-            if (!pcDoc) {
-                pcDoc = App::GetApplication().newDocument(DocName);
-            }
+        else {
+            Py_Error(Base::BaseExceptionFreeCADError,"unknown file ending");
+        }
+    } PY_CATCH;
 
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
+    Py_Return;
+}
 
-            // pcl test
-            pcl::PointCloud<pcl::PointXYZRGB> cloud_in;
-            pcl::io::loadPLYFile<pcl::PointXYZRGB>(EncodedName.c_str(),cloud_in); 
+static PyObject *
+exporter(PyObject *self, PyObject *args)
+{
+    PyObject* object;
+    char* Name;
+    if (!PyArg_ParseTuple(args, "Oet",&object,"utf-8",&Name))
+        return NULL;
+    std::string EncodedName = std::string(Name);
+    PyMem_Free(Name);
 
-            for (pcl::PointCloud<pcl::PointXYZRGB>::const_iterator it = cloud_in.begin();it!=cloud_in.end();++it)
-                pkTemp.push_back(Base::Vector3d(it->x,it->y,it->z));
-            pcFeature->Points.setValue( pkTemp );
-        }
-#endif
-        else {
-            Py_Error(Base::BaseExceptionFreeCADError,"unknown file ending");
+    PY_TRY {
+        std::vector<App::DocumentObject*> features;
+        Py::Sequence list(object);
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            PyObject* item = (*it).ptr();
+            if (PyObject_TypeCheck(item, &(App::DocumentObjectPy::Type))) {
+                App::DocumentObject* obj = static_cast<App::DocumentObjectPy*>(item)->getDocumentObjectPtr();
+                if (obj->getTypeId().isDerivedFrom(Points::Feature::getClassTypeId()))
+                    features.push_back(obj);
+                else
+                    Base::Console().Message("'%s' is not a point cloud, export will be ignored.\n", obj->Label.getValue());
+            }
         }
+
+        Points::PointKernel kernel;
+        std::vector<float> intensity;
+        std::vector<Base::Vector3f> normals;
+        Points::Export::mergeFeatures(features, kernel, intensity, normals);
+        PointsAlgos::Save(kernel, EncodedName.c_str(), &intensity, &normals);
     } PY_CATCH;
 
     Py_Return;
@@ -182,6 +202,7 @@ show(PyObject *self, PyObject *args)
 struct PyMethodDef Points_Import_methods[] = {
     {"open",  open,   1},       /* method name, C func ptr, always-tuple */
     {"insert",insert, 1},
+    {"export",exporter, 1},
     {"show",show, 1},
     {NULL, NULL}                /* end of table marker */
 };
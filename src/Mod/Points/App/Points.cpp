@@ -111,9 +111,11 @@ void PointKernel::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)size();
     str << uCt;
-    // store the data without transforming it
-    for (std::vector<value_type>::const_iterator it = _Points.begin(); it != _Points.end(); ++it) {
-        str << it->x << it->y << it->z;
+    // store the data without transforming it, as one block in the same
+    // byte order the stream uses for single values
+    if (uCt > 0) {
+        writer.Stream().write(reinterpret_cast<const char*>(&_Points[0]),
+                              uCt * sizeof(value_type));
     }
 }
 
@@ -140,10 +142,8 @@ void PointKernel::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt = 0;
     str >> uCt;
     _Points.resize(uCt);
-    for (unsigned long i=0; i < uCt; i++) {
-        float x, y, z;
-        str >> x >> y >> z;
-        _Points[i].Set(x,y,z);
+    if (uCt > 0) {
+        reader.read(reinterpret_cast<char*>(&_Points[0]), uCt * sizeof(value_type));
     }
 }
 
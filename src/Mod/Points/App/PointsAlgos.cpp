@@ -26,9 +26,19 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <algorithm>
+# include <cctype>
+# include <cmath>
+# include <cstring>
 # include <sstream>
 #endif
 
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include "PointsAlgos.h"
 #include "Points.h"
@@ -38,12 +48,13 @@
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
-
-#include <boost/regex.hpp>
+#include <Base/Swap.h>
+#include <Base/Tools.h>
 
 using namespace Points;
 
-void PointsAlgos::Load(PointKernel &points, const char *FileName)
+void PointsAlgos::Load(PointKernel &points, const char *FileName, unsigned long step, double voxel,
+                       const Base::BoundBox3d* region)
 {
     Base::FileInfo File(FileName);
 
@@ -51,63 +62,855 @@ void PointsAlgos::Load(PointKernel &points, const char *FileName)
     if (!File.isReadable())
         throw Base::FileException("File to load not existing or not readable", FileName);
 
-    if (File.extension() == "asc" ||File.extension() == "ASC")
-        LoadAscii(points,FileName);
+    if (File.hasExtension("asc"))
+        LoadAscii(points,FileName,step,voxel);
+    else if (File.hasExtension("ply"))
+        LoadPly(points,FileName);
+    else if (File.hasExtension("fcpc"))
+        LoadChunked(points,FileName,0,0,region);
     else
         throw Base::Exception("Unknown ending");
 }
 
-void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
+namespace Points {
+
+/** A range of complete lines of the file and the points read from them. */
+struct AsciiChunk
 {
-    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
-    //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
+    const char* begin;
+    const char* end;
+    std::vector<Base::Vector3d> points;
+};
 
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
-    Base::FileInfo fi(FileName);
+/** The index of the cube a point lies in. */
+struct Voxel
+{
+    boost::int64_t x, y, z;
+    bool operator == (const Voxel& v) const
+    { return x == v.x && y == v.y && z == v.z; }
+};
 
-    Base::ifstream tmp_str(fi, std::ios::in);
+inline std::size_t hash_value(const Voxel& v)
+{
+    std::size_t seed = 0;
+    boost::hash_combine(seed, v.x);
+    boost::hash_combine(seed, v.y);
+    boost::hash_combine(seed, v.z);
+    return seed;
+}
 
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
+}
 
-    // resize the PointKernel
-    points.resize(LineCnt);
+/** Reads the points of all lines with exactly three numbers, other lines are skipped. */
+static void parseAsciiChunk(AsciiChunk& chunk)
+{
+    const char* p = chunk.begin;
+    while (p != chunk.end) {
+        const char* eol = std::find(p, chunk.end, '\n');
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
+        double c[3];
+        int i = 0;
+        while (i < 3) {
+            const char* q = p;
+            while (p != eol && Base::Tools::isBlank(*p))
+                ++p;
+            // the numbers must be separated by white spaces
+            if ((i > 0 && p == q) || !Base::Tools::scanNumber(p, eol, c[i]))
+                break;
+            i++;
+        }
+        while (p != eol && Base::Tools::isBlank(*p))
+            ++p;
+        if (i == 3 && p == eol)
+            chunk.points.push_back(Base::Vector3d(c[0], c[1], c[2]));
 
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
+        p = (eol == chunk.end) ? eol : eol + 1;
+    }
+}
+
+void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName, unsigned long step, double voxel)
+{
+    Base::FileInfo fi(FileName);
+    QFile file(QString::fromUtf8(fi.filePath().c_str()));
+    if (!file.open(QIODevice::ReadOnly))
+        throw Base::FileException("File to load not existing or not readable", FileName);
+
+    // the file is handled in windows to limit the address space and the memory
+    // used for the points of a window
+    const qint64 window = 64 * 1024 * 1024;
+    const qint64 size = file.size();
+    Base::SequencerLauncher seq("Loading points...", (size_t)((size + window - 1) / window));
+
+    // the points are stored in the inner coordinate system of the kernel
+    Base::Matrix4D mat = points.getTransform();
+    bool transform = (mat != Base::Matrix4D());
+    mat.inverse();
+
+    std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+    kernel.clear();
+    step = std::max<unsigned long>(step, 1);
+    unsigned long count = 0;
+    boost::unordered_set<Voxel> voxels;
+    std::vector<char> buffer;
 
     try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
+        qint64 offset = 0;
+        while (offset < size) {
+            qint64 length = std::min<qint64>(window, size - offset);
+            uchar* mapped = file.map(offset, length);
+            const char* data = reinterpret_cast<const char*>(mapped);
+            if (!mapped) {
+                // mapping may fail, e.g. for a too small address space
+                buffer.resize((std::size_t)length);
+                if (!file.seek(offset) || file.read(&buffer[0], length) != length)
+                    throw Base::Exception("Reading in points failed.");
+                data = &buffer[0];
+            }
+
+            // only handle complete lines, unless the window ends with the file
+            const char* end = data + length;
+            if (offset + length < size) {
+                const char* last = end;
+                while (last != data && *(last - 1) != '\n')
+                    --last;
+                if (last != data)
+                    end = last;
+            }
+
+            // split the window into chunks of complete lines
+            std::vector<AsciiChunk> chunks;
+            std::size_t chunkSize = std::max<std::size_t>(1024 * 1024,
+                (end - data) / (4 * std::max<int>(QThread::idealThreadCount(), 1)) + 1);
+            for (const char* begin = data; begin != end;) {
+                const char* stop = begin + std::min<std::size_t>(chunkSize, end - begin);
+                stop = std::find(stop, end, '\n');
+                if (stop != end)
+                    ++stop;
+                AsciiChunk chunk;
+                chunk.begin = begin;
+                chunk.end = stop;
+                chunks.push_back(chunk);
+                begin = stop;
             }
+
+            if (chunks.size() > 1)
+                QtConcurrent::blockingMap(chunks, parseAsciiChunk);
+            else if (chunks.size() == 1)
+                parseAsciiChunk(chunks.front());
+
+            // append in file order, so that the subsampling doesn't depend on the threads
+            for (std::vector<AsciiChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+                for (std::vector<Base::Vector3d>::iterator jt = it->points.begin(); jt != it->points.end(); ++jt) {
+                    if (count++ % step != 0)
+                        continue;
+                    if (voxel > 0.0) {
+                        Voxel v;
+                        v.x = (boost::int64_t)std::floor(jt->x / voxel);
+                        v.y = (boost::int64_t)std::floor(jt->y / voxel);
+                        v.z = (boost::int64_t)std::floor(jt->z / voxel);
+                        if (!voxels.insert(v).second)
+                            continue;
+                    }
+                    Base::Vector3d pt = transform ? mat * (*jt) : *jt;
+                    kernel.push_back(Base::Vector3f((float)pt.x,(float)pt.y,(float)pt.z));
+                }
+            }
+
+            // reserve the memory for the estimated number of points after the first window
+            if (offset == 0 && voxel <= 0.0 && end != data) {
+                double ratio = (double)size / (double)(end - data);
+                kernel.reserve((std::size_t)(kernel.size() * ratio * 1.05));
+            }
+
+            if (mapped)
+                file.unmap(mapped);
+            offset += end - data;
+            seq.next();
         }
     }
+    catch (const Base::Exception&) {
+        points.clear();
+        throw;
+    }
     catch (...) {
         points.clear();
         throw Base::Exception("Reading in points failed.");
     }
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+    // free the memory of a much too high estimation
+    if (kernel.capacity() > 2 * kernel.size())
+        std::vector<Base::Vector3f>(kernel).swap(kernel);
+}
+
+// ----------------------------------------------------------------------------
+
+namespace Points {
+
+/** A property of an element of a PLY file. */
+struct PlyProperty
+{
+    std::string name;
+    int type;       /**< index into plyTypeSize */
+    int countType;  /**< type of the list size or -1 for a scalar property */
+};
+
+/** An element of a PLY file with its properties. */
+struct PlyElement
+{
+    std::string name;
+    std::size_t count;
+    std::vector<PlyProperty> properties;
+};
+
+/**
+ * Reads the rows of the elements of a PLY file. Binary data is read through
+ * an own buffer of large blocks instead of value by value from the stream.
+ */
+class PlyReader
+{
+public:
+    PlyReader(std::istream& in, bool ascii, bool swap)
+        : _in(in), _ascii(ascii), _swap(swap), _pos(0), _len(0)
+    {
+    }
+
+    /** Reads the next row of \a element. Lists are skipped, their value is set to zero. */
+    bool readRow(const PlyElement& element, std::vector<double>& values);
+
+private:
+    bool readAsciiRow(const PlyElement& element, std::vector<double>& values);
+    const char* take(std::size_t size);
+    double value(const char* data, int type) const;
+
+private:
+    std::istream& _in;
+    bool _ascii, _swap;
+    std::vector<char> _buffer;
+    std::size_t _pos, _len;
+    std::string _line;
+};
+
+}
+
+static const std::size_t plyTypeSize[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+/** Returns the index of the PLY type \a name into plyTypeSize or -1. */
+static int plyType(const std::string& name)
+{
+    static const char* names[] = {
+        "char", "int8", "uchar", "uint8", "short", "int16", "ushort", "uint16",
+        "int", "int32", "uint", "uint32", "float", "float32", "double", "float64"
+    };
+    for (int i = 0; i < 16; i++) {
+        if (name == names[i])
+            return i / 2;
+    }
+    return -1;
+}
+
+template <class T>
+static inline double plyCast(const char* data)
+{
+    T v;
+    std::memcpy(&v, data, sizeof(T));
+    return (double)v;
+}
+
+double PlyReader::value(const char* data, int type) const
+{
+    char buf[8];
+    std::size_t size = plyTypeSize[type];
+    if (_swap)
+        std::reverse_copy(data, data + size, buf);
+    else
+        std::copy(data, data + size, buf);
+
+    switch (type) {
+    case 0: return plyCast<boost::int8_t>(buf);
+    case 1: return plyCast<boost::uint8_t>(buf);
+    case 2: return plyCast<boost::int16_t>(buf);
+    case 3: return plyCast<boost::uint16_t>(buf);
+    case 4: return plyCast<boost::int32_t>(buf);
+    case 5: return plyCast<boost::uint32_t>(buf);
+    case 6: return plyCast<float>(buf);
+    default: return plyCast<double>(buf);
+    }
+}
+
+const char* PlyReader::take(std::size_t size)
+{
+    if (_len - _pos < size) {
+        // move the rest to the front and refill the buffer
+        std::size_t rest = _len - _pos;
+        std::size_t block = std::max<std::size_t>(1024 * 1024, size);
+        if (_buffer.size() < rest + block)
+            _buffer.resize(rest + block);
+        if (rest > 0)
+            std::memmove(&_buffer[0], &_buffer[_pos], rest);
+        _in.read(&_buffer[rest], (std::streamsize)block);
+        _len = rest + (std::size_t)_in.gcount();
+        _pos = 0;
+        if (_len < size)
+            return 0;
+    }
+
+    const char* data = &_buffer[_pos];
+    _pos += size;
+    return data;
+}
+
+bool PlyReader::readAsciiRow(const PlyElement& element, std::vector<double>& values)
+{
+    // skip empty lines
+    do {
+        if (!std::getline(_in, _line))
+            return false;
+    }
+    while (_line.find_first_not_of(" \t\r") == std::string::npos);
+
+    const char* p = _line.c_str();
+    const char* end = p + _line.size();
+    for (std::size_t i = 0; i < element.properties.size(); i++) {
+        const PlyProperty& prop = element.properties[i];
+        int count = prop.countType >= 0 ? -1 : 0;
+        do {
+            double v;
+            while (p != end && Base::Tools::isBlank(*p))
+                ++p;
+            if (!Base::Tools::scanNumber(p, end, v))
+                return false;
+            if (count < 0)
+                count = (int)v;
+            else if (prop.countType < 0)
+                values[i] = v;
+        }
+        while (count-- > 0);
+        if (prop.countType >= 0)
+            values[i] = 0.0;
+    }
+
+    return true;
+}
+
+bool PlyReader::readRow(const PlyElement& element, std::vector<double>& values)
+{
+    values.resize(element.properties.size());
+    if (_ascii)
+        return readAsciiRow(element, values);
+
+    for (std::size_t i = 0; i < element.properties.size(); i++) {
+        const PlyProperty& prop = element.properties[i];
+        if (prop.countType >= 0) {
+            const char* data = take(plyTypeSize[prop.countType]);
+            if (!data)
+                return false;
+            std::size_t count = (std::size_t)value(data, prop.countType);
+            if (count > 0 && !take(count * plyTypeSize[prop.type]))
+                return false;
+            values[i] = 0.0;
+        }
+        else {
+            const char* data = take(plyTypeSize[prop.type]);
+            if (!data)
+                return false;
+            values[i] = value(data, prop.type);
+        }
+    }
+
+    return true;
+}
+
+/** Returns the matrix without its translation to transform directions. */
+static Base::Matrix4D rotationOf(const Base::Matrix4D& mat)
+{
+    Base::Matrix4D rot(mat);
+    rot[0][3] = rot[1][3] = rot[2][3] = 0.0;
+    return rot;
+}
+
+/** Writes \a count floats in little endian byte order. */
+static void writeFloats(std::ostream& out, const float* data, std::size_t count)
+{
+    if (count == 0)
+        return;
+    if (Base::SwapOrder() == LOW_ENDIAN) {
+        out.write(reinterpret_cast<const char*>(data), (std::streamsize)(count * sizeof(float)));
+    }
+    else {
+        std::vector<float> swapped(data, data + count);
+        for (std::vector<float>::iterator it = swapped.begin(); it != swapped.end(); ++it)
+            Base::SwapEndian(*it);
+        out.write(reinterpret_cast<const char*>(&swapped[0]), (std::streamsize)(count * sizeof(float)));
+    }
+}
+
+/** Reads \a count floats in little endian byte order. */
+static bool readFloats(std::istream& in, float* data, std::size_t count)
+{
+    if (count == 0)
+        return true;
+    in.read(reinterpret_cast<char*>(data), (std::streamsize)(count * sizeof(float)));
+    if (in.gcount() != (std::streamsize)(count * sizeof(float)))
+        return false;
+    if (Base::SwapOrder() != LOW_ENDIAN) {
+        for (std::size_t i = 0; i < count; i++)
+            Base::SwapEndian(data[i]);
+    }
+    return true;
+}
+
+void PointsAlgos::LoadPly(PointKernel &points, const char *FileName,
+                          std::vector<float>* intensity, std::vector<Base::Vector3f>* normals)
+{
+    Base::FileInfo fi(FileName);
+    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+    if (!inp)
+        throw Base::FileException("File to load not existing or not readable", FileName);
+
+    std::string line;
+    if (!std::getline(inp, line) || line.compare(0, 3, "ply") != 0)
+        throw Base::FileException("Not a PLY file", FileName);
+
+    // read the header
+    enum {
+        unknown, ascii, binary_little_endian, binary_big_endian
+    } format = unknown;
+    std::vector<PlyElement> elements;
+    bool header = false;
+    while (std::getline(inp, line)) {
+        std::istringstream str(line);
+        std::string kw;
+        str >> kw;
+        if (kw == "format") {
+            std::string name;
+            str >> name;
+            if (name == "ascii")
+                format = ascii;
+            else if (name == "binary_little_endian")
+                format = binary_little_endian;
+            else if (name == "binary_big_endian")
+                format = binary_big_endian;
+            else
+                throw Base::FileException("Unsupported PLY format", FileName);
+        }
+        else if (kw == "element") {
+            PlyElement element;
+            str >> element.name >> element.count;
+            if (!str)
+                throw Base::FileException("Invalid PLY header", FileName);
+            elements.push_back(element);
+        }
+        else if (kw == "property") {
+            PlyProperty prop;
+            std::string type;
+            str >> type;
+            prop.countType = -1;
+            if (type == "list") {
+                std::string countType;
+                str >> countType >> type;
+                prop.countType = plyType(countType);
+                if (prop.countType < 0)
+                    throw Base::FileException("Invalid PLY header", FileName);
+            }
+            str >> prop.name;
+            prop.type = plyType(type);
+            if (!str || prop.type < 0 || elements.empty())
+                throw Base::FileException("Invalid PLY header", FileName);
+            elements.back().properties.push_back(prop);
+        }
+        else if (kw == "end_header") {
+            header = true;
+            break;
+        }
+        // comments and object information are ignored
+    }
+
+    if (!header || format == unknown)
+        throw Base::FileException("Invalid PLY header", FileName);
+
+    bool swap = (format == binary_little_endian && Base::SwapOrder() != LOW_ENDIAN) ||
+                (format == binary_big_endian && Base::SwapOrder() == LOW_ENDIAN);
+    PlyReader reader(inp, format == ascii, swap);
+    std::vector<double> values;
+
+    // skip the elements in front of the vertices
+    std::vector<PlyElement>::iterator vertex = elements.begin();
+    for (; vertex != elements.end() && vertex->name != "vertex"; ++vertex) {
+        for (std::size_t i = 0; i < vertex->count; i++) {
+            if (!reader.readRow(*vertex, values))
+                throw Base::FileException("Unexpected end of PLY file", FileName);
+        }
+    }
+    if (vertex == elements.end())
+        throw Base::FileException("PLY file has no vertices", FileName);
+
+    int ix = -1, iy = -1, iz = -1, inx = -1, iny = -1, inz = -1, ii = -1;
+    for (std::size_t i = 0; i < vertex->properties.size(); i++) {
+        const PlyProperty& prop = vertex->properties[i];
+        if (prop.countType >= 0)
+            continue;
+        std::string name = prop.name;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name == "x") ix = (int)i;
+        else if (name == "y") iy = (int)i;
+        else if (name == "z") iz = (int)i;
+        else if (name == "nx") inx = (int)i;
+        else if (name == "ny") iny = (int)i;
+        else if (name == "nz") inz = (int)i;
+        else if (name == "intensity" || name == "scalar_intensity") ii = (int)i;
+    }
+    if (ix < 0 || iy < 0 || iz < 0)
+        throw Base::FileException("PLY file has no vertex coordinates", FileName);
+
+    bool readNormals = normals && inx >= 0 && iny >= 0 && inz >= 0;
+    bool readIntensity = intensity && ii >= 0;
+    if (normals)
+        normals->clear();
+    if (intensity)
+        intensity->clear();
+
+    // the points are stored in the inner coordinate system of the kernel
+    Base::Matrix4D mat = points.getTransform();
+    bool transform = (mat != Base::Matrix4D());
+    mat.inverse();
+    Base::Matrix4D rot = rotationOf(mat);
+
+    std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+    kernel.clear();
+    kernel.reserve(vertex->count);
+    if (readNormals)
+        normals->reserve(vertex->count);
+    if (readIntensity)
+        intensity->reserve(vertex->count);
+
+    const std::size_t block = 65536;
+    Base::SequencerLauncher seq("Loading points...", vertex->count / block + 1);
+    for (std::size_t i = 0; i < vertex->count; i++) {
+        if (!reader.readRow(*vertex, values)) {
+            points.clear();
+            if (normals)
+                normals->clear();
+            if (intensity)
+                intensity->clear();
+            throw Base::FileException("Unexpected end of PLY file", FileName);
+        }
+
+        Base::Vector3d pt(values[ix], values[iy], values[iz]);
+        if (transform)
+            pt = mat * pt;
+        kernel.push_back(Base::Vector3f((float)pt.x, (float)pt.y, (float)pt.z));
+        if (readNormals) {
+            Base::Vector3d n(values[inx], values[iny], values[inz]);
+            if (transform)
+                n = rot * n;
+            normals->push_back(Base::Vector3f((float)n.x, (float)n.y, (float)n.z));
+        }
+        if (readIntensity)
+            intensity->push_back((float)values[ii]);
+        if ((i + 1) % block == 0)
+            seq.next();
+    }
+}
+
+void PointsAlgos::Save(const PointKernel& points, const char *FileName,
+                       const std::vector<float>* intensity, const std::vector<Base::Vector3f>* normals)
+{
+    Base::FileInfo File(FileName);
+    if (File.hasExtension("asc"))
+        SaveAscii(points, FileName);
+    else if (File.hasExtension("ply"))
+        SavePly(points, FileName, intensity, normals);
+    else if (File.hasExtension("fcpc"))
+        SaveChunked(points, FileName, intensity, normals);
+    else
+        throw Base::Exception("Unknown ending");
+}
+
+void PointsAlgos::SaveAscii(const PointKernel& points, const char *FileName)
+{
+    Base::FileInfo fi(FileName);
+    Base::ofstream out(fi, std::ios::out | std::ios::binary);
+    if (!out)
+        throw Base::FileException("Cannot open file for writing", FileName);
+
+    for (PointKernel::const_iterator it = points.begin(); it != points.end(); ++it)
+        out << it->x << " " << it->y << " " << it->z << std::endl;
+    if (!out)
+        throw Base::FileException("Writing points failed", FileName);
+}
+
+void PointsAlgos::SavePly(const PointKernel& points, const char *FileName,
+                          const std::vector<float>* intensity, const std::vector<Base::Vector3f>* normals)
+{
+    Base::FileInfo fi(FileName);
+    Base::ofstream out(fi, std::ios::out | std::ios::binary);
+    if (!out)
+        throw Base::FileException("Cannot open file for writing", FileName);
+
+    std::size_t count = points.size();
+    bool writeNormals = normals && normals->size() == count;
+    bool writeIntensity = intensity && intensity->size() == count;
+
+    out << "ply\n"
+        << "format binary_little_endian 1.0\n"
+        << "comment FreeCAD generated\n"
+        << "element vertex " << count << "\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n";
+    if (writeNormals) {
+        out << "property float nx\n"
+            << "property float ny\n"
+            << "property float nz\n";
+    }
+    if (writeIntensity)
+        out << "property float intensity\n";
+    out << "end_header\n";
+
+    // the points are written in the outer coordinate system
+    const Base::Matrix4D& mat = points.getTransform();
+    bool transform = (mat != Base::Matrix4D());
+    Base::Matrix4D rot = rotationOf(mat);
+    const std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+
+    const std::size_t block = 65536;
+    std::vector<float> data;
+    data.reserve(block * 7);
+    for (std::size_t i = 0; i < count; i++) {
+        Base::Vector3d pt(kernel[i].x, kernel[i].y, kernel[i].z);
+        if (transform)
+            pt = mat * pt;
+        data.push_back((float)pt.x);
+        data.push_back((float)pt.y);
+        data.push_back((float)pt.z);
+        if (writeNormals) {
+            const Base::Vector3f& n = (*normals)[i];
+            Base::Vector3d dir(n.x, n.y, n.z);
+            if (transform)
+                dir = rot * dir;
+            data.push_back((float)dir.x);
+            data.push_back((float)dir.y);
+            data.push_back((float)dir.z);
+        }
+        if (writeIntensity)
+            data.push_back((*intensity)[i]);
+        if ((i + 1) % block == 0) {
+            writeFloats(out, &data[0], data.size());
+            data.clear();
+        }
+    }
+    if (!data.empty())
+        writeFloats(out, &data[0], data.size());
+
+    if (!out)
+        throw Base::FileException("Writing points failed", FileName);
+}
+
+/* The native chunked format, all values are stored in little endian byte order:
+ *   char[8]      "FCPOINTS"
+ *   uint32       version (1)
+ *   uint32       flags (1: intensities, 2: normals)
+ *   uint64       number of points
+ *   uint32       number of chunks
+ * the table of chunks:
+ *   uint64       file offset of the chunk data
+ *   uint32       number of points of the chunk
+ *   float[6]     bounding box of the chunk (min x,y,z, max x,y,z)
+ * and the data of each chunk:
+ *   float[3*n]   coordinates
+ *   float[n]     intensities (optional)
+ *   float[3*n]   normals (optional)
+ */
+static const char chunkedMagic[8] = { 'F','C','P','O','I','N','T','S' };
+static const uint32_t chunkedVersion = 1;
+static const uint32_t chunkedIntensity = 1;
+static const uint32_t chunkedNormals = 2;
+static const std::size_t chunkedHeaderSize = 28;
+static const std::size_t chunkedEntrySize = 36;
+
+void PointsAlgos::SaveChunked(const PointKernel& points, const char *FileName,
+                              const std::vector<float>* intensity, const std::vector<Base::Vector3f>* normals,
+                              unsigned long chunkSize)
+{
+    Base::FileInfo fi(FileName);
+    Base::ofstream out(fi, std::ios::out | std::ios::binary);
+    if (!out)
+        throw Base::FileException("Cannot open file for writing", FileName);
+
+    std::size_t count = points.size();
+    bool writeNormals = normals && normals->size() == count;
+    bool writeIntensity = intensity && intensity->size() == count;
+    chunkSize = std::max<unsigned long>(chunkSize, 1);
+    uint32_t numChunks = (uint32_t)((count + chunkSize - 1) / chunkSize);
+    uint32_t flags = (writeIntensity ? chunkedIntensity : 0) | (writeNormals ? chunkedNormals : 0);
+
+    Base::OutputStream str(out);
+    str.setByteOrder(Base::Stream::LittleEndian);
+    out.write(chunkedMagic, sizeof(chunkedMagic));
+    str << chunkedVersion << flags << (uint64_t)count << numChunks;
+
+    // the table is written behind the data when the bounding boxes are known
+    std::vector<char> table(numChunks * chunkedEntrySize, 0);
+    if (!table.empty())
+        out.write(&table[0], (std::streamsize)table.size());
+
+    const Base::Matrix4D& mat = points.getTransform();
+    bool transform = (mat != Base::Matrix4D());
+    Base::Matrix4D rot = rotationOf(mat);
+    const std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> counts;
+    std::vector<Base::BoundBox3f> boxes;
+    std::vector<float> data;
+    uint64_t offset = chunkedHeaderSize + numChunks * chunkedEntrySize;
+    Base::SequencerLauncher seq("Saving points...", numChunks);
+    for (std::size_t begin = 0; begin < count; begin += chunkSize) {
+        std::size_t end = std::min<std::size_t>(begin + chunkSize, count);
+        Base::BoundBox3f box;
+        data.clear();
+        for (std::size_t i = begin; i < end; i++) {
+            Base::Vector3d pt(kernel[i].x, kernel[i].y, kernel[i].z);
+            if (transform)
+                pt = mat * pt;
+            Base::Vector3f p((float)pt.x, (float)pt.y, (float)pt.z);
+            box.Add(p);
+            data.push_back(p.x);
+            data.push_back(p.y);
+            data.push_back(p.z);
+        }
+        if (writeIntensity)
+            data.insert(data.end(), intensity->begin() + begin, intensity->begin() + end);
+        if (writeNormals) {
+            for (std::size_t i = begin; i < end; i++) {
+                const Base::Vector3f& n = (*normals)[i];
+                Base::Vector3d dir(n.x, n.y, n.z);
+                if (transform)
+                    dir = rot * dir;
+                data.push_back((float)dir.x);
+                data.push_back((float)dir.y);
+                data.push_back((float)dir.z);
+            }
+        }
+
+        writeFloats(out, &data[0], data.size());
+        offsets.push_back(offset);
+        counts.push_back((uint32_t)(end - begin));
+        boxes.push_back(box);
+        offset += data.size() * sizeof(float);
+        seq.next();
+    }
+
+    out.seekp(chunkedHeaderSize);
+    for (uint32_t i = 0; i < numChunks; i++) {
+        const Base::BoundBox3f& box = boxes[i];
+        str << offsets[i] << counts[i]
+            << box.MinX << box.MinY << box.MinZ
+            << box.MaxX << box.MaxY << box.MaxZ;
+    }
+
+    if (!out)
+        throw Base::FileException("Writing points failed", FileName);
+}
+
+void PointsAlgos::LoadChunked(PointKernel &points, const char *FileName,
+                              std::vector<float>* intensity, std::vector<Base::Vector3f>* normals,
+                              const Base::BoundBox3d* region)
+{
+    Base::FileInfo fi(FileName);
+    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+    if (!inp)
+        throw Base::FileException("File to load not existing or not readable", FileName);
+
+    char magic[8];
+    inp.read(magic, sizeof(magic));
+    if (inp.gcount() != sizeof(magic) || !std::equal(magic, magic + sizeof(magic), chunkedMagic))
+        throw Base::FileException("Not a chunked point cloud file", FileName);
+
+    Base::InputStream str(inp);
+    str.setByteOrder(Base::Stream::LittleEndian);
+    uint32_t version = 0, flags = 0, numChunks = 0;
+    uint64_t count = 0;
+    str >> version >> flags >> count >> numChunks;
+    if (!inp || version != chunkedVersion)
+        throw Base::FileException("Unsupported version of chunked point cloud file", FileName);
+
+    std::vector<uint64_t> offsets(numChunks);
+    std::vector<uint32_t> counts(numChunks);
+    std::vector<Base::BoundBox3d> boxes(numChunks);
+    for (uint32_t i = 0; i < numChunks; i++) {
+        float box[6];
+        str >> offsets[i] >> counts[i];
+        for (int j = 0; j < 6; j++)
+            str >> box[j];
+        boxes[i] = Base::BoundBox3d(box[0], box[1], box[2], box[3], box[4], box[5]);
+    }
+    if (!inp)
+        throw Base::FileException("Unexpected end of chunked point cloud file", FileName);
+
+    bool hasIntensity = (flags & chunkedIntensity) != 0;
+    bool hasNormals = (flags & chunkedNormals) != 0;
+    bool readIntensity = intensity && hasIntensity;
+    bool readNormals = normals && hasNormals;
+    if (intensity)
+        intensity->clear();
+    if (normals)
+        normals->clear();
+
+    // the points are stored in the inner coordinate system of the kernel
+    Base::Matrix4D mat = points.getTransform();
+    bool transform = (mat != Base::Matrix4D());
+    mat.inverse();
+    Base::Matrix4D rot = rotationOf(mat);
+
+    std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+    kernel.clear();
+    if (!region) {
+        kernel.reserve((std::size_t)count);
+        if (readIntensity)
+            intensity->reserve((std::size_t)count);
+        if (readNormals)
+            normals->reserve((std::size_t)count);
+    }
+
+    std::vector<float> data;
+    Base::SequencerLauncher seq("Loading points...", numChunks);
+    for (uint32_t i = 0; i < numChunks; i++) {
+        seq.next();
+        if (region && !(*region && boxes[i]))
+            continue;
+
+        std::size_t n = counts[i];
+        std::size_t size = n * (3 + (hasIntensity ? 1 : 0) + (hasNormals ? 3 : 0));
+        data.resize(size);
+        inp.seekg((std::streamoff)offsets[i]);
+        if (!inp || !readFloats(inp, data.empty() ? 0 : &data[0], size)) {
+            points.clear();
+            if (intensity)
+                intensity->clear();
+            if (normals)
+                normals->clear();
+            throw Base::FileException("Unexpected end of chunked point cloud file", FileName);
+        }
+
+        const float* coords = data.empty() ? 0 : &data[0];
+        const float* values = coords + 3 * n;
+        const float* dirs = values + (hasIntensity ? n : 0);
+        for (std::size_t j = 0; j < n; j++) {
+            Base::Vector3d pt(coords[3*j], coords[3*j+1], coords[3*j+2]);
+            if (region && !region->IsInBox(pt))
+                continue;
+            if (transform)
+                pt = mat * pt;
+            kernel.push_back(Base::Vector3f((float)pt.x, (float)pt.y, (float)pt.z));
+            if (readIntensity)
+                intensity->push_back(values[j]);
+            if (readNormals) {
+                Base::Vector3d dir(dirs[3*j], dirs[3*j+1], dirs[3*j+2]);
+                if (transform)
+                    dir = rot * dir;
+                normals->push_back(Base::Vector3f((float)dir.x, (float)dir.y, (float)dir.z));
+            }
+        }
+    }
 }
@@ -34,12 +34,51 @@ namespace Points
 class PointsExport PointsAlgos
 {
 public:
-  /** Load a point cloud
+  /** Load a point cloud. \a step and \a voxel are only used for ASCII files
+   * and \a region only for files of the native chunked format.
    */
-  static void Load(PointKernel&, const char *FileName);
-  /** Load a point cloud
+  static void Load(PointKernel&, const char *FileName, unsigned long step = 1, double voxel = 0.0,
+                   const Base::BoundBox3d* region = 0);
+  /** Load a point cloud from an ASCII file with three coordinates per line.
+   * The file is mapped into memory window by window and the lines of a window
+   * are parsed by several threads. Only every \a step-th point is kept and, if
+   * \a voxel is greater than zero, only the first point of each cube with this
+   * edge length.
    */
-  static void LoadAscii(PointKernel&, const char *FileName);
+  static void LoadAscii(PointKernel&, const char *FileName, unsigned long step = 1, double voxel = 0.0);
+  /** Load the vertices of an ASCII or binary PLY file. If given, \a intensity
+   * and \a normals get the values of the vertex properties 'intensity' and
+   * 'nx', 'ny', 'nz' or are left empty if the file doesn't have them.
+   */
+  static void LoadPly(PointKernel&, const char *FileName,
+                      std::vector<float>* intensity = 0, std::vector<Base::Vector3f>* normals = 0);
+  /** Load a point cloud of the native chunked binary format.
+   * If \a region is given only the chunks whose bounding box intersects it are
+   * read and only the points inside the region are kept.
+   */
+  static void LoadChunked(PointKernel&, const char *FileName,
+                          std::vector<float>* intensity = 0, std::vector<Base::Vector3f>* normals = 0,
+                          const Base::BoundBox3d* region = 0);
+
+  /** Save a point cloud, the format is chosen by the file extension.
+   * The attributes are only written if their size matches the number of points
+   * and the format supports them.
+   */
+  static void Save(const PointKernel&, const char *FileName,
+                   const std::vector<float>* intensity = 0, const std::vector<Base::Vector3f>* normals = 0);
+  /** Save a point cloud as ASCII file with three coordinates per line. */
+  static void SaveAscii(const PointKernel&, const char *FileName);
+  /** Save a point cloud as binary little endian PLY file. */
+  static void SavePly(const PointKernel&, const char *FileName,
+                      const std::vector<float>* intensity = 0, const std::vector<Base::Vector3f>* normals = 0);
+  /** Save a point cloud in the native chunked binary format.
+   * The points are written in chunks of \a chunkSize points, each with its own
+   * bounding box, so that a region of the cloud can be loaded without reading
+   * the whole file.
+   */
+  static void SaveChunked(const PointKernel&, const char *FileName,
+                          const std::vector<float>* intensity = 0, const std::vector<Base::Vector3f>* normals = 0,
+                          unsigned long chunkSize = 65536);
 
 };
 
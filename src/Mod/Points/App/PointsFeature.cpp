@@ -34,6 +34,7 @@
 #include <Base/Writer.h>
 
 
+#include "PointsAlgos.h"
 #include "PointsFeature.h"
 
 using namespace Points;
@@ -91,6 +92,22 @@ void Feature::onChanged(const App::Property* prop)
 
 // ------------------------------------------------------------------
 
+PROPERTY_SOURCE(Points::Scan, Points::Feature)
+
+Scan::Scan()
+{
+    ADD_PROPERTY_TYPE(Intensity, (0.0f), "Attributes", App::Prop_None, "Intensity of each point");
+    ADD_PROPERTY_TYPE(Normal, (Base::Vector3f()), "Attributes", App::Prop_None, "Normal of each point");
+    Intensity.setSize(0);
+    Normal.setSize(0);
+}
+
+Scan::~Scan()
+{
+}
+
+// ------------------------------------------------------------------
+
 PROPERTY_SOURCE(Points::Export, Points::Feature)
 
 Export::Export(void)
@@ -110,10 +127,9 @@ App::DocumentObjectExecReturn *Export::execute(void)
       return new App::DocumentObjectExecReturn("No write permission for file");
   }
 
-  Base::ofstream str(fi, std::ios::out | std::ios::binary);
-
   if (fi.hasExtension("asc"))
   {
+    Base::ofstream str(fi, std::ios::out | std::ios::binary);
     const std::vector<App::DocumentObject*>& features = Sources.getValues();
     for ( std::vector<App::DocumentObject*>::const_iterator it = features.begin(); it != features.end(); ++it )
     {
@@ -125,6 +141,19 @@ App::DocumentObjectExecReturn *Export::execute(void)
         str << it->x << " " << it->y << " " << it->z << std::endl;
     }
   }
+  else if (fi.hasExtension("ply") || fi.hasExtension("fcpc"))
+  {
+    PointKernel kernel;
+    std::vector<float> intensity;
+    std::vector<Base::Vector3f> normals;
+    mergeFeatures(Sources.getValues(), kernel, intensity, normals);
+    try {
+      PointsAlgos::Save(kernel, fi.filePath().c_str(), &intensity, &normals);
+    }
+    catch (const Base::Exception& e) {
+      return new App::DocumentObjectExecReturn(e.what());
+    }
+  }
   else
   {
       return new App::DocumentObjectExecReturn("File format not supported");
@@ -133,6 +162,53 @@ App::DocumentObjectExecReturn *Export::execute(void)
   return App::DocumentObject::StdReturn;
 }
 
+void Export::mergeFeatures(const std::vector<App::DocumentObject*>& features,
+                           PointKernel& points, std::vector<float>& intensity,
+                           std::vector<Base::Vector3f>& normals)
+{
+  std::vector<Feature*> clouds;
+  std::size_t count = 0;
+  bool withIntensity = true, withNormals = true;
+  for ( std::vector<App::DocumentObject*>::const_iterator it = features.begin(); it != features.end(); ++it )
+  {
+    Feature *pcFeat = dynamic_cast<Feature*>(*it);
+    if (!pcFeat)
+      continue;
+    clouds.push_back(pcFeat);
+    int size = (int)pcFeat->Points.getValue().size();
+    count += size;
+    Scan *pcScan = dynamic_cast<Scan*>(pcFeat);
+    withIntensity = withIntensity && pcScan && pcScan->Intensity.getSize() == size;
+    withNormals = withNormals && pcScan && pcScan->Normal.getSize() == size;
+  }
+
+  points.clear();
+  points.reserve(count);
+  intensity.clear();
+  normals.clear();
+  for ( std::vector<Feature*>::iterator it = clouds.begin(); it != clouds.end(); ++it )
+  {
+    const PointKernel& kernel = (*it)->Points.getValue();
+    for ( PointKernel::const_iterator jt = kernel.begin(); jt != kernel.end(); ++jt )
+      points.push_back(*jt);
+
+    if (withIntensity) {
+      const std::vector<float>& values = static_cast<Scan*>(*it)->Intensity.getValues();
+      intensity.insert(intensity.end(), values.begin(), values.end());
+    }
+    if (withNormals) {
+      // the normals follow the placement of the points
+      const Base::Rotation& rot = (*it)->Placement.getValue().getRotation();
+      const std::vector<Base::Vector3f>& values = static_cast<Scan*>(*it)->Normal.getValues();
+      for ( std::vector<Base::Vector3f>::const_iterator jt = values.begin(); jt != values.end(); ++jt ) {
+        Base::Vector3d dir;
+        rot.multVec(Base::Vector3d(jt->x, jt->y, jt->z), dir);
+        normals.push_back(Base::Vector3f((float)dir.x, (float)dir.y, (float)dir.z));
+      }
+    }
+  }
+}
+
 // ---------------------------------------------------------
 
 namespace App {
@@ -30,6 +30,7 @@
 #include <App/PropertyGeo.h>
 #include "Points.h"
 #include "PropertyPointKernel.h"
+#include "Properties.h"
 
 
 namespace Base{
@@ -75,6 +76,22 @@ public:
     PropertyPointKernel Points; /**< The point kernel property. */
 };
 
+/**
+ * The Scan class is a point cloud with an intensity and a normal per point,
+ * as delivered by many scanners.
+ */
+class PointsExport Scan : public Feature
+{
+    PROPERTY_HEADER(Points::Scan);
+
+public:
+    Scan();
+    virtual ~Scan();
+
+    PropertyGreyValueList Intensity; /**< The intensity of each point. */
+    PropertyNormalList    Normal;    /**< The normal of each point. */
+};
+
 /**
  * The Export class writes a point cloud to a file.
  * @author Werner Mayer
@@ -95,6 +112,13 @@ public:
     /// recalculate the Feature
     virtual App::DocumentObjectExecReturn *execute(void);
     //@}
+
+    /** Collects the points of all \a features in global coordinates.
+     * The intensities and normals are only collected if all features have them.
+     */
+    static void mergeFeatures(const std::vector<App::DocumentObject*>& features,
+                              PointKernel& points, std::vector<float>& intensity,
+                              std::vector<Base::Vector3f>& normals);
 };
 
 typedef App::FeaturePythonT<Feature> FeaturePython;
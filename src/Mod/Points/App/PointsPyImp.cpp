@@ -24,7 +24,9 @@
 #include "PreCompiled.h"
 
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsAlgos.h"
 #include <Base/Builder3D.h>
+#include <Base/BoundBoxPy.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
 
@@ -91,11 +93,21 @@ PyObject* PointsPy::copy(PyObject *args)
 PyObject* PointsPy::read(PyObject * args)
 {
     const char* Name;
-    if (!PyArg_ParseTuple(args, "s",&Name))
-        return NULL;                         
+    int step = 1;
+    double voxel = 0.0;
+    PyObject* region = 0;
+    if (!PyArg_ParseTuple(args, "s|idO!",&Name,&step,&voxel,&(Base::BoundBoxPy::Type),&region))
+        return NULL;
+    if (step < 1) {
+        PyErr_SetString(PyExc_ValueError, "step must be at least 1");
+        return NULL;
+    }
 
     PY_TRY {
-        getPointKernelPtr()->load(Name);
+        const Base::BoundBox3d* box = 0;
+        if (region)
+            box = static_cast<Base::BoundBoxPy*>(region)->getBoundBoxPtr();
+        PointsAlgos::Load(*getPointKernelPtr(), Name, (unsigned long)step, voxel, box);
     } PY_CATCH;
     
     Py_Return; 
@@ -0,0 +1,102 @@
+#   (c) FreeCAD developers 2026      LGPL
+
+import FreeCAD, os, sys, unittest, tempfile, Points
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+class PointsFileFormatCases(unittest.TestCase):
+	def setUp(self):
+		self.Doc = FreeCAD.newDocument("PointsTest")
+		self.TempPath = tempfile.gettempdir()
+		self.DocName = self.TempPath + os.sep + "PointsTest.FCStd"
+
+	def comparePoints(self, points, other):
+		self.failUnless(len(points) == len(other))
+		for p, q in zip(points, other):
+			self.failUnless(p.sub(q).Length < 0.0001)
+
+	def testFileFormats(self):
+		scan = self.Doc.addObject("Points::Scan", "Scan")
+		pts = Points.Points()
+		pts.addPoints([(0.5*i, 2.0*i, -1.0*i) for i in range(100)])
+		scan.Points = pts
+		scan.Intensity = [i/100.0 for i in range(100)]
+		scan.Normal = [(0.0,0.6,0.8)]*100
+		points = scan.Points.Points
+
+		# binary PLY with intensities and normals
+		name = self.TempPath + os.sep + "PointsBinary.ply"
+		Points.export([scan], name)
+		Points.insert(name, "PointsTest")
+		other = self.Doc.PointsBinary
+		self.comparePoints(points, other.Points.Points)
+		self.failUnless(len(other.Intensity) == 100)
+		self.failUnless(abs(other.Intensity[42] - 0.42) < 0.0001)
+		self.failUnless(len(other.Normal) == 100)
+		self.failUnless(other.Normal[7].sub(FreeCAD.Vector(0.0,0.6,0.8)).Length < 0.0001)
+		os.remove(name)
+
+		# ASCII PLY with the same points
+		name = self.TempPath + os.sep + "PointsAscii.ply"
+		file = open(name, "w")
+		file.write("ply\nformat ascii 1.0\ncomment written by the test\nelement vertex 100\n")
+		file.write("property float x\nproperty float y\nproperty float z\nproperty float intensity\nend_header\n")
+		for i in range(100):
+			file.write("%f %f %f %f\n" % (0.5*i, 2.0*i, -1.0*i, i/100.0))
+		file.close()
+		Points.insert(name, "PointsTest")
+		other = self.Doc.PointsAscii
+		self.comparePoints(points, other.Points.Points)
+		self.failUnless(abs(other.Intensity[42] - 0.42) < 0.0001)
+		self.failUnless(len(other.Normal) == 0)
+		os.remove(name)
+
+		# chunked format, completely and only a region
+		name = self.TempPath + os.sep + "PointsChunked.fcpc"
+		Points.export([scan], name)
+		other = Points.Points()
+		other.read(name)
+		self.comparePoints(points, other.Points)
+		other = Points.Points()
+		other.read(name, 1, 0.0, FreeCAD.BoundBox(4.9,-1000.0,-1000.0,10.1,1000.0,1000.0))
+		self.comparePoints(points[10:21], other.Points)
+		os.remove(name)
+
+		# the attributes are stored in the project file
+		self.Doc.saveAs(self.DocName)
+		FreeCAD.closeDocument("PointsTest")
+		self.Doc = FreeCAD.open(self.DocName)
+		self.comparePoints(points, self.Doc.Scan.Points.Points)
+		self.failUnless(abs(self.Doc.Scan.Intensity[42] - 0.42) < 0.0001)
+		self.failUnless(len(self.Doc.Scan.Normal) == 100)
+
+	def testAsciiDecimation(self):
+		name = self.TempPath + os.sep + "PointsDecimation.asc"
+		file = open(name, "w")
+		for i in range(100):
+			file.write("%.3f 0.0 0.0\n" % (0.1*i))
+		file.close()
+
+		pts = Points.Points()
+		pts.read(name)
+		self.failUnless(pts.CountPoints == 100)
+		# every step-th point starting with the first one
+		pts = Points.Points()
+		pts.read(name, 3)
+		self.failUnless(pts.CountPoints == 34)
+		self.failUnless(abs(pts.Points[1].x - 0.3) < 0.0001)
+		# the first point of each cube with an edge length of 1
+		pts = Points.Points()
+		pts.read(name, 1, 1.0)
+		self.failUnless(pts.CountPoints == 10)
+		for i in range(10):
+			self.failUnless(abs(pts.Points[i].x - i) < 0.0001)
+		os.remove(name)
+
+	def tearDown(self):
+		#closing doc
+		FreeCAD.closeDocument("PointsTest")
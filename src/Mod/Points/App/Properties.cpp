@@ -152,8 +152,9 @@ void PropertyGreyValueList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<float>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << *it;
+    if (uCt > 0) {
+        writer.Stream().write(reinterpret_cast<const char*>(&_lValueList[0]),
+                              uCt * sizeof(float));
     }
 }
 
@@ -163,8 +164,8 @@ void PropertyGreyValueList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<float> values(uCt);
-    for (std::vector<float>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> *it;
+    if (uCt > 0) {
+        reader.read(reinterpret_cast<char*>(&values[0]), uCt * sizeof(float));
     }
     setValues(values);
 }
@@ -328,8 +329,9 @@ void PropertyNormalList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<Base::Vector3f>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->x << it->y << it->z;
+    if (uCt > 0) {
+        writer.Stream().write(reinterpret_cast<const char*>(&_lValueList[0]),
+                              uCt * sizeof(Base::Vector3f));
     }
 }
 
@@ -339,8 +341,8 @@ void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Base::Vector3f> values(uCt);
-    for (std::vector<Base::Vector3f>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->x >> it->y >> it->z;
+    if (uCt > 0) {
+        reader.read(reinterpret_cast<char*>(&values[0]), uCt * sizeof(Base::Vector3f));
     }
     setValues(values);
 }
@@ -69,7 +69,8 @@ CmdPointsImport::CmdPointsImport()
 void CmdPointsImport::activated(int iMsg)
 {
   QString fn = Gui::FileDialog::getOpenFileName(Gui::getMainWindow(),
-      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;All Files (*.*)"));
+      QString::null, QString(), QObject::tr("Point formats (*.asc *.ply *.fcpc);;Ascii Points (*.asc);;"
+      "PLY Points (*.ply);;Chunked Points (*.fcpc);;All Files (*.*)"));
   if ( fn.isEmpty() )
     return;
 
@@ -79,8 +80,15 @@ void CmdPointsImport::activated(int iMsg)
     fi.setFile(fn);
 
     openCommand("Points Import Create");
-    doCommand(Doc,"f = App.ActiveDocument.addObject(\"Points::ImportAscii\",\"%s\")", (const char*)fi.baseName().toAscii());
-    doCommand(Doc,"f.FileName = \"%s\"",(const char*)fn.toAscii());
+    if (fi.suffix().toLower() == QLatin1String("asc")) {
+      doCommand(Doc,"f = App.ActiveDocument.addObject(\"Points::ImportAscii\",\"%s\")", (const char*)fi.baseName().toAscii());
+      doCommand(Doc,"f.FileName = \"%s\"",(const char*)fn.toAscii());
+    }
+    else {
+      // binary formats may carry intensities and normals
+      doCommand(Doc,"import Points");
+      doCommand(Doc,"Points.insert(\"%s\",App.ActiveDocument.Name)",(const char*)fn.toAscii());
+    }
     commitCommand();
  
     updateActive();
@@ -112,7 +120,8 @@ CmdPointsExport::CmdPointsExport()
 void CmdPointsExport::activated(int iMsg)
 {
   QString fn = Gui::FileDialog::getSaveFileName(Gui::getMainWindow(),
-      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;All Files (*.*)"));
+      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;PLY Points (*.ply);;"
+      "Chunked Points (*.fcpc);;All Files (*.*)"));
   if ( fn.isEmpty() )
     return;
 
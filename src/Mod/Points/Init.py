@@ -37,5 +37,7 @@ ParGrp.SetString("WorkBenchName",    "Points Design")
 # Append the open handler
 FreeCAD.EndingAdd("Point formats (*.asc)","Points")
 FreeCAD.EndingAdd("PLY points (*.ply)","Points")
+FreeCAD.EndingAdd("Chunked points (*.fcpc)","Points")
+FreeCAD.addExportType("Point formats (*.asc *.ply *.fcpc)","Points")
 
 
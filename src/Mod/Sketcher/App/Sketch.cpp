@@ -34,6 +34,7 @@
 #include <Base/Exception.h>
 #include <Base/TimeInfo.h>
 #include <Base/Console.h>
+#include <App/Application.h>
 
 #include <Base/VectorPy.h>
 
@@ -121,6 +122,13 @@ int Sketch::setUpSketch(const std::vector<Part::Geometry *> &GeoList,
     if (!Geoms.empty())
         addConstraints(ConstraintList);
 
+    // large sketches are solved and diagnosed much faster with the sparse
+    // decompositions as the Jacobian has only a few entries per constraint
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Sketcher");
+    GCSsys.setLinearSolver(hGrp->GetBool("SparseSolver", false) ?
+                           GCS::SparseSolver : GCS::DenseSolver);
+
     GCSsys.clearByTag(-1);
     GCSsys.declareUnknowns(Parameters);
     GCSsys.initSolution();
@@ -1625,7 +1633,9 @@ int Sketch::solve(void)
         case 0: // solving with the default DogLeg solver
                 // (or with SQP if we are in moving mode)
             solvername = isInitMove ? "SQP" : "DogLeg";
-            ret = GCSsys.solve(isFine, GCS::DogLeg);
+            // while moving only the dragged part of the sketch is solved again,
+            // starting from the solution of the previous step
+            ret = GCSsys.solve(isFine, GCS::DogLeg, isInitMove);
             break;
         case 1: // solving with the LevenbergMarquardt solver
             solvername = "LevenbergMarquardt";
@@ -144,7 +144,9 @@ System::System()
   c2p(), p2c(),
   subSystems(0), subSystemsAux(0),
   reference(0),
-  hasUnknowns(false), hasDiagnosis(false), isInit(false)
+  isIncrementalSolution(false),
+  hasUnknowns(false), hasDiagnosis(false), isInit(false),
+  linearSolver(DenseSolver)
 {
 }
 
@@ -153,7 +155,9 @@ System::System(std::vector<Constraint *> clist_)
   c2p(), p2c(),
   subSystems(0), subSystemsAux(0),
   reference(0),
-  hasUnknowns(false), hasDiagnosis(false), isInit(false)
+  isIncrementalSolution(false),
+  hasUnknowns(false), hasDiagnosis(false), isInit(false),
+  linearSolver(DenseSolver)
 {
     // create own (shallow) copy of constraints
     for (std::vector<Constraint *>::iterator constr=clist_.begin();
@@ -820,6 +824,18 @@ void System::initSolution()
             subSystemsAux[cid] = new SubSystem(clist1, plists[cid], reductionmaps[cid]);
     }
 
+    // components affected by move constraints, these are the only ones
+    // that have to be solved again while dragging
+    for (int cid=0; cid < int(subSystemsAux.size()); cid++) {
+        if (subSystemsAux[cid]) {
+            movingSubSystems.push_back(cid);
+            for (VEC_pD::const_iterator param=plists[cid].begin();
+                 param != plists[cid].end(); ++param)
+                movingParams.push_back(pIndex[*param]);
+        }
+    }
+    hessians.resize(movingSubSystems.size());
+
     isInit = true;
 }
 
@@ -849,11 +865,32 @@ int System::solve(VEC_pD &params, bool isFine, Algorithm alg)
     return solve(isFine, alg);
 }
 
-int System::solve(bool isFine, Algorithm alg)
+int System::solve(bool isFine, Algorithm alg, bool isIncremental)
 {
     if (!isInit)
         return Failed;
 
+    isIncrementalSolution = isIncremental;
+    if (isIncremental) {
+        // warm start from the last solution which is also kept as reference
+        // for undoSolution(), the decomposition into subsystems is reused
+        // and all components without move constraints are left untouched
+        for (VEC_I::const_iterator idx=movingParams.begin();
+             idx != movingParams.end(); ++idx)
+            reference[*idx] = *plist[*idx];
+
+        int res = Success;
+        for (int i=0; i < int(movingSubSystems.size()); i++) {
+            int cid = movingSubSystems[i];
+            if (subSystems[cid])
+                res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine,
+                                          &hessians[i]));
+            else
+                res = std::max(res, solve(subSystemsAux[cid], isFine, alg));
+        }
+        return res;
+    }
+
     bool isReset = false;
     // return success by default in order to permit coincidence constraints to be applied
     // even if no other system has to be solved
@@ -886,9 +923,9 @@ int System::solve(SubSystem *subsys, bool isFine, Algorithm alg)
     if (alg == BFGS)
         return solve_BFGS(subsys, isFine);
     else if (alg == LevenbergMarquardt)
-        return solve_LM(subsys);
+        return linearSolver == SparseSolver ? solve_LM_sparse(subsys) : solve_LM(subsys);
     else if (alg == DogLeg)
-        return solve_DL(subsys);
+        return linearSolver == SparseSolver ? solve_DL_sparse(subsys) : solve_DL(subsys);
     else
         return Failed;
 }
@@ -1252,9 +1289,344 @@ int System::solve_DL(SubSystem* subsys)
     return (stop == 1) ? Success : Failed;
 }
 
+#ifdef FREEGCS_SPARSE_SOLVER
+// Computes the Gauss-Newton step h from J*h = -f. This is the least squares
+// solution if J has more rows than columns and the minimum norm solution
+// otherwise. A tiny regularization keeps the normal equations positive
+// definite in case of redundant constraints.
+static bool solveSparseGaussNewton(const Eigen::SparseMatrix<double> &J,
+                                   const Eigen::VectorXd &f, Eigen::VectorXd &h)
+{
+    Eigen::SparseMatrix<double> JT = J.transpose();
+    Eigen::SparseMatrix<double> A;
+    bool overdetermined = J.rows() >= J.cols();
+    if (overdetermined)
+        A = JT*J;
+    else
+        A = J*JT;
+
+    double reg = 0;
+    for (int i=0; i < A.rows(); i++)
+        reg = std::max(reg, A.coeff(i,i));
+    reg *= 1e-13;
+    Eigen::SparseMatrix<double> I(A.rows(), A.cols());
+    I.setIdentity();
+    A += reg*I;
+
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt(A);
+    if (ldlt.info() != Eigen::Success)
+        return false;
+
+    if (overdetermined)
+        h = ldlt.solve(-(JT*f));
+    else
+        h = JT*ldlt.solve(-f);
+    return h == h; // check for NaN
+}
+
+int System::solve_LM_sparse(SubSystem* subsys)
+{
+    int xsize = subsys->pSize();
+    int csize = subsys->cSize();
+
+    if (xsize == 0)
+        return Success;
+
+    Eigen::VectorXd e(csize), e_new(csize); // vector of all function errors (every constraint is one function)
+    Eigen::SparseMatrix<double> J(csize, xsize); // Jacobi of the subsystem
+    Eigen::SparseMatrix<double> A(xsize, xsize), Aug(xsize, xsize), I(xsize, xsize);
+    Eigen::VectorXd x(xsize), h(xsize), x_new(xsize), g(xsize), diag_A(xsize);
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt;
+    I.setIdentity();
+
+    subsys->redirectParams();
+
+    subsys->getParams(x);
+    subsys->calcResidual(e);
+    e*=-1;
+
+    int maxIterNumber = MaxIterations * xsize;
+    double divergingLim = 1e6*e.squaredNorm() + 1e12;
+
+    double eps=1e-10, eps1=1e-80;
+    double tau=1e-3;
+    double nu=2, mu=0;
+    int iter=0, stop=0;
+    for (iter=0; iter < maxIterNumber && !stop; ++iter) {
+
+        // check error
+        double err=e.squaredNorm();
+        if (err <= eps) { // error is small, Success
+            stop = 1;
+            break;
+        }
+        else if (err > divergingLim || err != err) { // check for diverging and NaN
+            stop = 6;
+            break;
+        }
+
+        // J^T J, J^T e
+        subsys->calcJacobi(J);
+
+        Eigen::SparseMatrix<double> JT = J.transpose();
+        A = JT*J;
+        g = JT*e;
+
+        // Compute ||J^T e||_inf
+        double g_inf = g.lpNorm<Eigen::Infinity>();
+        diag_A = A.diagonal();
+
+        // check for convergence
+        if (g_inf <= eps1) {
+            stop = 2;
+            break;
+        }
+
+        // compute initial damping factor
+        if (iter == 0)
+            mu = tau * diag_A.lpNorm<Eigen::Infinity>();
+
+        // the pattern of the augmented matrix doesn't change while damping
+        Aug = A + mu*I;
+        ldlt.analyzePattern(Aug);
+
+        // determine increment using adaptive damping
+        int k=0;
+        while (k < 50) {
+            // augment normal equations A = A+uI
+            Aug = A + mu*I;
+
+            //solve augmented functions A*h=-g
+            ldlt.factorize(Aug);
+            if (ldlt.info() == Eigen::Success) {
+                h = ldlt.solve(g);
+                double rel_error = (Aug*h - g).norm() / g.norm();
+
+                // check if solving works
+                if (rel_error < 1e-5) {
+
+                    // restrict h according to maxStep
+                    double scale = subsys->maxStep(h);
+                    if (scale < 1.)
+                        h *= scale;
+
+                    // compute par's new estimate and ||d_par||^2
+                    x_new = x + h;
+                    double h_norm = h.squaredNorm();
+
+                    if (h_norm <= eps1*eps1*x.norm()) { // relative change in p is small, stop
+                        stop = 3;
+                        break;
+                    }
+                    else if (h_norm >= (x.norm()+eps1)/(DBL_EPSILON*DBL_EPSILON)) { // almost singular
+                        stop = 4;
+                        break;
+                    }
+
+                    subsys->setParams(x_new);
+                    subsys->calcResidual(e_new);
+                    e_new *= -1;
+
+                    double dF = e.squaredNorm() - e_new.squaredNorm();
+                    double dL = h.dot(mu*h+g);
+
+                    if (dF>0. && dL>0.) { // reduction in error, increment is accepted
+                        double tmp=2*dF/dL-1.;
+                        mu *= std::max(1./3., 1.-tmp*tmp*tmp);
+                        nu=2;
+
+                        // update par's estimate
+                        x = x_new;
+                        e = e_new;
+                        break;
+                    }
+                }
+            }
+
+            // if this point is reached, either the linear system could not be solved or
+            // the error did not reduce; in any case, the increment must be rejected
+
+            mu*=nu;
+            nu*=2.0;
+
+            k++;
+        }
+        if (k > 50) {
+            stop = 7;
+            break;
+        }
+    }
+
+    if (iter >= maxIterNumber)
+        stop = 5;
+
+    subsys->revertParams();
+
+    return (stop == 1) ? Success : Failed;
+}
+
+int System::solve_DL_sparse(SubSystem* subsys)
+{
+    double tolg=1e-80, tolx=1e-80, tolf=1e-10;
+
+    int xsize = subsys->pSize();
+    int csize = subsys->cSize();
+
+    if (xsize == 0)
+        return Success;
+
+    Eigen::VectorXd x(xsize), x_new(xsize);
+    Eigen::VectorXd fx(csize), fx_new(csize);
+    Eigen::SparseMatrix<double> Jx(csize, xsize), Jx_new(csize, xsize);
+    Eigen::VectorXd g(xsize), h_sd(xsize), h_gn(xsize), h_dl(xsize);
+
+    subsys->redirectParams();
+
+    double err;
+    subsys->getParams(x);
+    subsys->calcResidual(fx, err);
+    subsys->calcJacobi(Jx);
+
+    g = Jx.transpose()*(-fx);
+
+    // get the infinity norm fx_inf and g_inf
+    double g_inf = g.lpNorm<Eigen::Infinity>();
+    double fx_inf = fx.lpNorm<Eigen::Infinity>();
+
+    int maxIterNumber = MaxIterations * xsize;
+    double divergingLim = 1e6*err + 1e12;
+
+    double delta=0.1;
+    double alpha=0.;
+    double nu=2.;
+    int iter=0, stop=0, reduce=0;
+    while (!stop) {
+
+        // check if finished
+        if (fx_inf <= tolf) // Success
+            stop = 1;
+        else if (g_inf <= tolg)
+            stop = 2;
+        else if (delta <= tolx*(tolx + x.norm()))
+            stop = 2;
+        else if (iter >= maxIterNumber)
+            stop = 4;
+        else if (err > divergingLim || err != err) { // check for diverging and NaN
+            stop = 6;
+        }
+        else {
+            // get the steepest descent direction
+            Eigen::VectorXd Jg = Jx*g;
+            alpha = g.squaredNorm()/Jg.squaredNorm();
+            h_sd  = alpha*g;
+
+            // get the gauss-newton step, use the dense decomposition if
+            // the sparse one fails
+            if (!solveSparseGaussNewton(Jx, fx, h_gn))
+                h_gn = Eigen::MatrixXd(Jx).fullPivLu().solve(-fx);
+            double rel_error = (Jx*h_gn + fx).norm() / fx.norm();
+            if (rel_error > 1e15)
+                break;
+
+            // compute the dogleg step
+            if (h_gn.norm() < delta) {
+                h_dl = h_gn;
+                if  (h_dl.norm() <= tolx*(tolx + x.norm())) {
+                    stop = 5;
+                    break;
+                }
+            }
+            else if (alpha*g.norm() >= delta) {
+                h_dl = (delta/(alpha*g.norm()))*h_sd;
+            }
+            else {
+                //compute beta
+                double beta = 0;
+                Eigen::VectorXd b = h_gn - h_sd;
+                double bb = (b.transpose()*b).norm();
+                double gb = (h_sd.transpose()*b).norm();
+                double c = (delta + h_sd.norm())*(delta - h_sd.norm());
+
+                if (gb > 0)
+                    beta = c / (gb + sqrt(gb * gb + c * bb));
+                else
+                    beta = (sqrt(gb * gb + c * bb) - gb)/bb;
+
+                // and update h_dl and dL with beta
+                h_dl = h_sd + beta*b;
+            }
+        }
+
+        // see if we are already finished
+        if (stop)
+            break;
+
+        // get the new values
+        double err_new;
+        x_new = x + h_dl;
+        subsys->setParams(x_new);
+        subsys->calcResidual(fx_new, err_new);
+        subsys->calcJacobi(Jx_new);
+
+        // calculate the linear model and the update ratio
+        Eigen::VectorXd fl = fx + Jx*h_dl;
+        double dL = err - 0.5*fl.squaredNorm();
+        double dF = err - err_new;
+        double rho = dL/dF;
+
+        if (dF > 0 && dL > 0) {
+            x  = x_new;
+            Jx = Jx_new;
+            fx = fx_new;
+            err = err_new;
+
+            g = Jx.transpose()*(-fx);
+
+            // get infinity norms
+            g_inf = g.lpNorm<Eigen::Infinity>();
+            fx_inf = fx.lpNorm<Eigen::Infinity>();
+        }
+        else
+            rho = -1;
+
+        // update delta
+        if (fabs(rho-1.) < 0.2 && h_dl.norm() > delta/3. && reduce <= 0) {
+            delta = 3*delta;
+            nu = 2;
+            reduce = 0;
+        }
+        else if (rho < 0.25) {
+            delta = delta/nu;
+            nu = 2*nu;
+            reduce = 2;
+        }
+        else
+            reduce--;
+
+        // count this iteration and start again
+        iter++;
+    }
+
+    subsys->revertParams();
+
+    return (stop == 1) ? Success : Failed;
+}
+#else
+int System::solve_LM_sparse(SubSystem* subsys)
+{
+    return solve_LM(subsys);
+}
+
+int System::solve_DL_sparse(SubSystem* subsys)
+{
+    return solve_DL(subsys);
+}
+#endif
+
 // The following solver variant solves a system compound of two subsystems
 // treating the first of them as of higher priority than the second
-int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine)
+int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine,
+                  Eigen::MatrixXd *hessian)
 {
     int xsizeA = subsysA->pSize();
     int xsizeB = subsysB->pSize();
@@ -1277,6 +1649,8 @@ int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine)
     int xsize = plistAB.size();
 
     Eigen::MatrixXd B = Eigen::MatrixXd::Identity(xsize, xsize);
+    if (hessian && hessian->rows() == xsize) // continue with a previous approximation
+        B = *hessian;
     Eigen::MatrixXd JA(csizeA, xsize);
     Eigen::MatrixXd Y,Z;
 
@@ -1409,6 +1783,13 @@ int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine)
     else
         ret = Failed;
 
+    if (hessian) {
+        if (ret == Success)
+            *hessian = B;
+        else
+            hessian->resize(0,0);
+    }
+
     subsysA->revertParams();
     subsysB->revertParams();
     return ret;
@@ -1417,15 +1798,26 @@ int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine)
 
 void System::applySolution()
 {
-    for (int cid=0; cid < int(subSystems.size()); cid++) {
-        if (subSystemsAux[cid])
-            subSystemsAux[cid]->applySolution();
-        if (subSystems[cid])
-            subSystems[cid]->applySolution();
-        for (MAP_pD_pD::const_iterator it=reductionmaps[cid].begin();
-             it != reductionmaps[cid].end(); ++it)
-            *(it->first) = *(it->second);
+    if (isIncrementalSolution) {
+        for (VEC_I::const_iterator it=movingSubSystems.begin();
+             it != movingSubSystems.end(); ++it)
+            applySolution(*it);
+        return;
     }
+
+    for (int cid=0; cid < int(subSystems.size()); cid++)
+        applySolution(cid);
+}
+
+void System::applySolution(int cid)
+{
+    if (subSystemsAux[cid])
+        subSystemsAux[cid]->applySolution();
+    if (subSystems[cid])
+        subSystems[cid]->applySolution();
+    for (MAP_pD_pD::const_iterator it=reductionmaps[cid].begin();
+         it != reductionmaps[cid].end(); ++it)
+        *(it->first) = *(it->second);
 }
 
 void System::undoSolution()
@@ -1454,56 +1846,16 @@ int System::diagnose()
     redundant.clear();
     conflictingTags.clear();
     redundantTags.clear();
-    Eigen::MatrixXd J(clist.size(), plist.size());
-    int count=0;
-    for (std::vector<Constraint *>::iterator constr=clist.begin();
-         constr != clist.end(); ++constr) {
-        (*constr)->revertParams();
-        if ((*constr)->getTag() >= 0) {
-            count++;
-            for (int j=0; j < int(plist.size()); j++)
-                J(count-1,j) = (*constr)->grad(plist[j]);
-        }
-    }
 
-    if (J.rows() > 0) {
-        Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT(J.topRows(count).transpose());
-        Eigen::MatrixXd Q = qrJT.matrixQ ();
-        int paramsNum = qrJT.rows();
-        int constrNum = qrJT.cols();
-        int rank = qrJT.rank();
-
-        Eigen::MatrixXd R;
-        if (constrNum >= paramsNum)
-            R = qrJT.matrixQR().triangularView<Eigen::Upper>();
+    if (clist.size() > 0) {
+        int paramsNum, constrNum, rank;
+        std::vector< std::vector<Constraint *> > conflictGroups;
+        if (linearSolver == SparseSolver)
+            rank = diagnose_sparse(paramsNum, constrNum, conflictGroups);
         else
-            R = qrJT.matrixQR().topRows(constrNum)
-                               .triangularView<Eigen::Upper>();
+            rank = diagnose_dense(paramsNum, constrNum, conflictGroups);
 
         if (constrNum > rank) { // conflicting or redundant constraints
-            for (int i=1; i < rank; i++) {
-                // eliminate non zeros above pivot
-                assert(R(i,i) != 0);
-                for (int row=0; row < i; row++) {
-                    if (R(row,i) != 0) {
-                        double coef=R(row,i)/R(i,i);
-                        R.block(row,i+1,1,constrNum-i-1) -= coef * R.block(i,i+1,1,constrNum-i-1);
-                        R(row,i) = 0;
-                    }
-                }
-            }
-            std::vector< std::vector<Constraint *> > conflictGroups(constrNum-rank);
-            for (int j=rank; j < constrNum; j++) {
-                for (int row=0; row < rank; row++) {
-                    if (fabs(R(row,j)) > 1e-10) {
-                        int origCol = qrJT.colsPermutation().indices()[row];
-                        conflictGroups[j-rank].push_back(clist[origCol]);
-                    }
-                }
-                int origCol = qrJT.colsPermutation().indices()[j];
-                conflictGroups[j-rank].push_back(clist[origCol]);
-            }
-
             // try to remove the conflicting constraints and solve the
             // system in order to check if the removed constraints were
             // just redundant but not really conflicting
@@ -1621,6 +1973,126 @@ int System::diagnose()
     return dofs;
 }
 
+int System::diagnose_dense(int &paramsNum, int &constrNum,
+                           std::vector< std::vector<Constraint *> > &conflictGroups)
+{
+    Eigen::MatrixXd J(clist.size(), plist.size());
+    int count=0;
+    for (std::vector<Constraint *>::iterator constr=clist.begin();
+         constr != clist.end(); ++constr) {
+        (*constr)->revertParams();
+        if ((*constr)->getTag() >= 0) {
+            count++;
+            for (int j=0; j < int(plist.size()); j++)
+                J(count-1,j) = (*constr)->grad(plist[j]);
+        }
+    }
+
+    Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT(J.topRows(count).transpose());
+    paramsNum = qrJT.rows();
+    constrNum = qrJT.cols();
+    int rank = qrJT.rank();
+
+    Eigen::MatrixXd R;
+    if (constrNum >= paramsNum)
+        R = qrJT.matrixQR().triangularView<Eigen::Upper>();
+    else
+        R = qrJT.matrixQR().topRows(constrNum)
+                           .triangularView<Eigen::Upper>();
+
+    if (constrNum > rank) { // conflicting or redundant constraints
+        for (int i=1; i < rank; i++) {
+            // eliminate non zeros above pivot
+            assert(R(i,i) != 0);
+            for (int row=0; row < i; row++) {
+                if (R(row,i) != 0) {
+                    double coef=R(row,i)/R(i,i);
+                    R.block(row,i+1,1,constrNum-i-1) -= coef * R.block(i,i+1,1,constrNum-i-1);
+                    R(row,i) = 0;
+                }
+            }
+        }
+        conflictGroups.resize(constrNum-rank);
+        for (int j=rank; j < constrNum; j++) {
+            for (int row=0; row < rank; row++) {
+                if (fabs(R(row,j)) > 1e-10) {
+                    int origCol = qrJT.colsPermutation().indices()[row];
+                    conflictGroups[j-rank].push_back(clist[origCol]);
+                }
+            }
+            int origCol = qrJT.colsPermutation().indices()[j];
+            conflictGroups[j-rank].push_back(clist[origCol]);
+        }
+    }
+
+    return rank;
+}
+
+int System::diagnose_sparse(int &paramsNum, int &constrNum,
+                            std::vector< std::vector<Constraint *> > &conflictGroups)
+{
+#ifdef FREEGCS_SPARSE_SOLVER
+    // the transposed Jacobian, one column per constraint
+    MAP_pD_I pindex;
+    for (int j=0; j < int(plist.size()); j++)
+        pindex[plist[j]] = j;
+
+    std::vector<Constraint *> clistR;
+    std::vector< Eigen::Triplet<double> > triplets;
+    for (std::vector<Constraint *>::iterator constr=clist.begin();
+         constr != clist.end(); ++constr) {
+        (*constr)->revertParams();
+        if ((*constr)->getTag() >= 0) {
+            VEC_pD cparams = (*constr)->params();
+            SET_pD cparamsSet(cparams.begin(), cparams.end());
+            for (SET_pD::const_iterator p=cparamsSet.begin(); p != cparamsSet.end(); ++p) {
+                MAP_pD_I::const_iterator it = pindex.find(*p);
+                if (it != pindex.end())
+                    triplets.push_back(Eigen::Triplet<double>(it->second, clistR.size(),
+                                                              (*constr)->grad(*p)));
+            }
+            clistR.push_back(*constr);
+        }
+    }
+
+    Eigen::SparseMatrix<double> JT(plist.size(), clistR.size());
+    JT.setFromTriplets(triplets.begin(), triplets.end());
+    JT.makeCompressed();
+
+    // the QR decomposition moves the linearly dependent columns to the end
+    Eigen::SparseQR< Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > qrJT(JT);
+    if (qrJT.info() != Eigen::Success)
+        return diagnose_dense(paramsNum, constrNum, conflictGroups);
+
+    paramsNum = JT.rows();
+    constrNum = JT.cols();
+    int rank = qrJT.rank();
+
+    if (constrNum > rank) { // conflicting or redundant constraints
+        // Express each dependent column by the independent ones: R11*x = R12
+        // The non-zero entries of R11*diag(x) are the same as those of the
+        // eliminated upper triangular matrix of the dense version.
+        Eigen::SparseMatrix<double> R = qrJT.matrixR();
+        Eigen::SparseMatrix<double> R11 = R.topLeftCorner(rank, rank);
+        const Eigen::VectorXi &perm = qrJT.colsPermutation().indices();
+        conflictGroups.resize(constrNum-rank);
+        for (int j=rank; j < constrNum; j++) {
+            Eigen::VectorXd col = R.col(j).head(rank);
+            Eigen::VectorXd x = R11.triangularView<Eigen::Upper>().solve(col);
+            for (int row=0; row < rank; row++) {
+                if (fabs(R11.coeff(row,row)*x(row)) > 1e-10)
+                    conflictGroups[j-rank].push_back(clistR[perm[row]]);
+            }
+            conflictGroups[j-rank].push_back(clistR[perm[j]]);
+        }
+    }
+
+    return rank;
+#else
+    return diagnose_dense(paramsNum, constrNum, conflictGroups);
+#endif
+}
+
 void System::clearSubSystems()
 {
     isInit = false;
@@ -1628,6 +2100,10 @@ void System::clearSubSystems()
     free(subSystemsAux);
     subSystems.clear();
     subSystemsAux.clear();
+    movingSubSystems.clear();
+    movingParams.clear();
+    hessians.clear();
+    isIncrementalSolution = false;
 }
 
 double lineSearch(SubSystem *subsys, Eigen::VectorXd &xdir)
@@ -44,6 +44,11 @@ namespace GCS
         DogLeg = 2
     };
 
+    enum LinearSolver {
+        DenseSolver = 0, // dense Jacobian and dense matrix decompositions
+        SparseSolver = 1 // sparse Jacobian and sparse decompositions, for large systems
+    };
+
     class System
     {
     // This is the main class. It holds all constraints and information
@@ -58,6 +63,7 @@ namespace GCS
 
         std::vector<SubSystem *> subSystems, subSystemsAux;
         void clearSubSystems();
+        void applySolution(int cid); // applies the solution of a single component
 
         VEC_D reference;
         void setReference();     // copies the current parameter values to reference
@@ -67,6 +73,11 @@ namespace GCS
         std::vector< std::vector<Constraint *> > clists; // partitioned clist except equality constraints
         std::vector< MAP_pD_pD > reductionmaps;          // for simplification of equality constraints
 
+        VEC_I movingSubSystems;                 // components with negatively tagged (move) constraints
+        VEC_I movingParams;                     // plist indices of the parameters of these components
+        std::vector<Eigen::MatrixXd> hessians;  // SQP Hessian approximations kept between incremental solves
+        bool isIncrementalSolution;             // if the last solution only covers the moving components
+
         int dofs;
         std::set<Constraint *> redundant;
         VEC_I conflictingTags, redundantTags;
@@ -75,9 +86,17 @@ namespace GCS
         bool hasDiagnosis; // if dofs, conflictingTags, redundantTags are up to date
         bool isInit;       // if plists, clists, reductionmaps are up to date
 
+        LinearSolver linearSolver; // used by LevenbergMarquardt, DogLeg and diagnose()
+
         int solve_BFGS(SubSystem *subsys, bool isFine);
         int solve_LM(SubSystem *subsys);
         int solve_DL(SubSystem *subsys);
+        int solve_LM_sparse(SubSystem *subsys);
+        int solve_DL_sparse(SubSystem *subsys);
+        int diagnose_dense(int &paramsNum, int &constrNum,
+                           std::vector< std::vector<Constraint *> > &conflictGroups);
+        int diagnose_sparse(int &paramsNum, int &constrNum,
+                            std::vector< std::vector<Constraint *> > &conflictGroups);
     public:
         System();
         System(std::vector<Constraint *> clist_);
@@ -86,6 +105,9 @@ namespace GCS
         void clear();
         void clearByTag(int tagId);
 
+        void setLinearSolver(LinearSolver ls) { linearSolver = ls; }
+        LinearSolver getLinearSolver() const { return linearSolver; }
+
         int addConstraint(Constraint *constr);
         void removeConstraint(Constraint *constr);
 
@@ -160,10 +182,14 @@ namespace GCS
         void declareUnknowns(VEC_pD &params);
         void initSolution();
 
-        int solve(bool isFine=true, Algorithm alg=DogLeg);
+        // With isIncremental only the components containing negatively tagged
+        // constraints are solved, starting from the last solution. This is meant
+        // for the repeated solving while dragging geometry.
+        int solve(bool isFine=true, Algorithm alg=DogLeg, bool isIncremental=false);
         int solve(VEC_pD &params, bool isFine=true, Algorithm alg=DogLeg);
         int solve(SubSystem *subsys, bool isFine=true, Algorithm alg=DogLeg);
-        int solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine=true);
+        int solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine=true,
+                  Eigen::MatrixXd *hessian=0);
 
         void applySolution();
         void undoSolution();
@@ -270,6 +270,45 @@ void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
     calcJacobi(plist, jacobi);
 }
 
+#ifdef FREEGCS_SPARSE_SOLVER
+void SubSystem::calcJacobi(VEC_pD &params, Eigen::SparseMatrix<double> &jacobi)
+{
+    // columns of the redirected parameters, with a reduction map several
+    // columns may refer to the same parameter
+    std::map<double *, std::vector<int> > pcols;
+    for (int j=0; j < int(params.size()); j++) {
+        MAP_pD_pD::const_iterator
+          pmapfind = pmap.find(params[j]);
+        if (pmapfind != pmap.end())
+            pcols[pmapfind->second].push_back(j);
+    }
+
+    // every constraint depends on a few parameters only
+    std::vector< Eigen::Triplet<double> > triplets;
+    for (int i=0; i < csize; i++) {
+        const VEC_pD &cparams = c2p[clist[i]];
+        for (VEC_pD::const_iterator p=cparams.begin(); p != cparams.end(); ++p) {
+            std::map<double *, std::vector<int> >::const_iterator
+              pcolsfind = pcols.find(*p);
+            if (pcolsfind != pcols.end()) {
+                double grad = clist[i]->grad(*p);
+                for (std::vector<int>::const_iterator j=pcolsfind->second.begin();
+                     j != pcolsfind->second.end(); ++j)
+                    triplets.push_back(Eigen::Triplet<double>(i, *j, grad));
+            }
+        }
+    }
+
+    jacobi.resize(csize, params.size());
+    jacobi.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+void SubSystem::calcJacobi(Eigen::SparseMatrix<double> &jacobi)
+{
+    calcJacobi(plist, jacobi);
+}
+#endif
+
 void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
 {
     assert(grad.size() == int(params.size()));
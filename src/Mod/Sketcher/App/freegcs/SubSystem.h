@@ -27,6 +27,12 @@
 #undef max
 
 #include <Eigen/Core>
+// The sparse solver path needs SimplicialLDLT and SparseQR of Eigen 3.2.
+// With older versions the sparse solver falls back to the dense one.
+#if EIGEN_VERSION_AT_LEAST(3,2,0)
+# define FREEGCS_SPARSE_SOLVER
+# include <Eigen/Sparse>
+#endif
 #include "Constraints.h"
 
 namespace GCS
@@ -69,6 +75,10 @@ namespace GCS
         void calcResidual(Eigen::VectorXd &r, double &err);
         void calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi);
         void calcJacobi(Eigen::MatrixXd &jacobi);
+#ifdef FREEGCS_SPARSE_SOLVER
+        void calcJacobi(VEC_pD &params, Eigen::SparseMatrix<double> &jacobi);
+        void calcJacobi(Eigen::SparseMatrix<double> &jacobi);
+#endif
         void calcGrad(VEC_pD &params, Eigen::VectorXd &grad);
         void calcGrad(Eigen::VectorXd &grad);
 
@@ -81,6 +81,37 @@ def CreateSlotPlateInnerSet(SketchFeature):
 	SketchFeature.addGeometry(Part.ArcOfCircle(Part.Circle(App.Vector(192.422913,38.216347,0),App.Vector(0,0,1),45.315174),2.635158,3.602228))
 	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',7,2,8,1)) 
 	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',8,2,5,1))
+
+def CreateGridSketchSet(SketchFeature, Rows, Cols, Size=10.0, First=0, X=0.0):
+	# a grid of Rows x Cols boxes where each box is chained to its neighbours,
+	# used to benchmark the solver on sketches with many constraints. First is
+	# the index of the first geometry, X the horizontal offset of the grid.
+	for i in range(Rows):
+		for j in range(Cols):
+			# slightly distorted boxes so that the solver has to move them
+			x = X + j*Size + 0.1*i
+			y = -i*Size + 0.1*j
+			g = First + 4*(i*Cols+j)
+			SketchFeature.addGeometry(Part.Line(App.Vector(x,y,0),App.Vector(x+Size*1.1,y,0)))
+			SketchFeature.addGeometry(Part.Line(App.Vector(x+Size*1.1,y,0),App.Vector(x+Size*1.1,y-Size*0.9,0)))
+			SketchFeature.addGeometry(Part.Line(App.Vector(x+Size*1.1,y-Size*0.9,0),App.Vector(x,y-Size*0.9,0)))
+			SketchFeature.addGeometry(Part.Line(App.Vector(x,y-Size*0.9,0),App.Vector(x,y,0)))
+			SketchFeature.addConstraint(Sketcher.Constraint('Coincident',g+0,2,g+1,1))
+			SketchFeature.addConstraint(Sketcher.Constraint('Coincident',g+1,2,g+2,1))
+			SketchFeature.addConstraint(Sketcher.Constraint('Coincident',g+2,2,g+3,1))
+			SketchFeature.addConstraint(Sketcher.Constraint('Coincident',g+3,2,g+0,1))
+			SketchFeature.addConstraint(Sketcher.Constraint('Horizontal',g+0))
+			SketchFeature.addConstraint(Sketcher.Constraint('Horizontal',g+2))
+			SketchFeature.addConstraint(Sketcher.Constraint('Vertical',g+1))
+			SketchFeature.addConstraint(Sketcher.Constraint('Vertical',g+3))
+			SketchFeature.addConstraint(Sketcher.Constraint('Distance',g+0,Size))
+			SketchFeature.addConstraint(Sketcher.Constraint('Distance',g+1,Size))
+			if j > 0:
+				# top left corner on top right corner of the left neighbour
+				SketchFeature.addConstraint(Sketcher.Constraint('Coincident',g+0,1,g-4,2))
+			elif i > 0:
+				# top left corner on bottom left corner of the box above
+				SketchFeature.addConstraint(Sketcher.Constraint('Coincident',g+0,1,g-4*Cols+2,2))
 	
 
 
@@ -113,6 +144,55 @@ class SketcherSolverTestCases(unittest.TestCase):
 		CreateSlotPlateInnerSet(self.Slot)
 		self.Doc.recompute()
 		self.failUnless(len(self.Slot.Shape.Edges) == 9)
+
+	def testSparseSolver(self):
+		import time
+		hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Sketcher")
+		sparse = hGrp.GetBool("SparseSolver", False)
+		points = []
+		try:
+			for mode in [False, True]:
+				hGrp.SetBool("SparseSolver", mode)
+				Grid = self.Doc.addObject('Sketcher::SketchObject','SketchGrid')
+				CreateGridSketchSet(Grid, 8, 8)
+				# fix the top left corner so that the sketch is fully constrained
+				# and both solvers must find the same solution
+				Grid.addConstraint(Sketcher.Constraint('DistanceX',0,1,0.0))
+				Grid.addConstraint(Sketcher.Constraint('DistanceY',0,1,0.0))
+				start = time.time()
+				self.Doc.recompute()
+				FreeCAD.Console.PrintLog("Grid sketch solved in %f s (sparse solver: %s)\n" % (time.time()-start, mode))
+				self.failUnless(len(Grid.Shape.Edges) == 256)
+				# all corners lie on the grid with a spacing of 10
+				for v in Grid.Shape.Vertexes:
+					for c in (v.Point.x, v.Point.y):
+						self.failUnless(abs(c - 10.0*round(c/10.0)) < 1e-6)
+				points.append(sorted([(int(round(v.Point.x/10.0)), int(round(v.Point.y/10.0))) for v in Grid.Shape.Vertexes]))
+		finally:
+			hGrp.SetBool("SparseSolver", sparse)
+		self.failUnless(points[0] == points[1])
+
+	def testIncrementalDrag(self):
+		# Drags a corner of the first of several independent grids. Only the
+		# component of the dragged point is solved on every step, so the time
+		# per step should hardly depend on the number of grids.
+		import time
+		steps = 20
+		for count in [1, 10]:
+			sketch = Sketcher.Sketch()
+			for k in range(count):
+				CreateGridSketchSet(sketch, 4, 4, First=64*k, X=100.0*k)
+			self.failUnless(sketch.solve() == 0)
+			others = [g.StartPoint for g in sketch.Geometries[64:]]
+			start = time.time()
+			for i in range(steps):
+				target = App.Vector(-0.5*i, 0.5*i, 0)
+				self.failUnless(sketch.movePoint(0, 1, target) == 0)
+				self.failUnless(sketch.Geometries[0].StartPoint.sub(target).Length < 1e-6)
+			FreeCAD.Console.PrintLog("Dragged %d grids in %f s per step\n" % (count, (time.time()-start)/steps))
+			# the other grids are not touched
+			for p, g in zip(others, sketch.Geometries[64:]):
+				self.failUnless(p.sub(g.StartPoint).Length < 1e-9)
 	
 	
 	def tearDown(self):
@@ -244,6 +244,61 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.L1.Link = self.L2
     self.L2.Link = self.L3
 
+  def testInList(self):
+    self.L1.Source1 = self.L3
+    self.L2.SourceN = [self.L3, self.L1]
+    self.failUnless(len(self.L3.InList) == 2)
+    self.failUnless(self.L1.InList == [self.L2])
+    self.L1.Source1 = None
+    self.failUnless(self.L3.InList == [self.L2])
+    # removing an object breaks all links to it
+    self.Doc.removeObject(self.L1.Name)
+    self.failUnless(self.L2.SourceN == [self.L3])
+    self.failUnless(self.L3.InList == [self.L2])
+
+  def testParallelRecompute(self):
+    # two independent chains plus one object depending on both
+    L4 = self.Doc.addObject("App::FeatureTest","Label_4")
+    self.L1.Source1 = self.L2
+    L4.Source1 = self.L3
+    L4.Source2 = self.L1
+    for obj in [self.L1, self.L2, self.L3, L4]:
+      obj.touch()
+    self.Doc.RecomputeMode = 1
+    self.failUnless(self.Doc.RecomputeMode == 1)
+    self.Doc.recompute()
+    for obj in [self.L1, self.L2, self.L3, L4]:
+      self.failUnless(obj.ExecCount == 1)
+      self.failUnless(obj.ExecResult == "Exec")
+    # only the touched object and its dependents are executed again
+    self.L2.Integer = 1
+    self.Doc.recompute()
+    self.failUnless(self.L3.ExecCount == 1)
+    self.failUnless(self.L2.ExecCount == 2)
+    self.failUnless(self.L1.ExecCount == 2)
+    self.failUnless(L4.ExecCount == 2)
+    self.Doc.RecomputeMode = 0
+
+  def testRecomputeTouched(self):
+    L4 = self.Doc.addObject("App::FeatureTest","Label_4")
+    self.L1.Source1 = self.L2
+    L4.Source1 = self.L1
+    self.Doc.recompute()
+    count = self.L3.ExecCount
+    self.failUnless(count == 1)
+    self.Doc.RecomputeMode = 2
+    # a change of Label_2 must only visit Label_2, Label_1 and Label_4
+    self.L2.Integer = 2
+    self.Doc.recompute()
+    self.failUnless(self.Doc.RecomputeVisited == 3)
+    self.failUnless(self.Doc.RecomputeExecuted == 3)
+    self.failUnless(self.L3.ExecCount == count)
+    self.failUnless(L4.ExecCount == 2)
+    # nothing touched
+    self.Doc.recompute()
+    self.failUnless(self.Doc.RecomputeVisited == 0)
+    self.Doc.RecomputeMode = 0
+
 
   def tearDown(self):
     #closing doc
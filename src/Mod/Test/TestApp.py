@@ -43,6 +43,7 @@ def All():
         suite.addTest(unittest.defaultTestLoader.loadTestsFromName("Menu") )
     # add the module tests
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("MeshTestsApp") )
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromName("PointsTestsApp") )
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestSketcherApp") )
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestPartApp") )
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestPartDesignApp") )
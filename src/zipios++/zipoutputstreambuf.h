@@ -49,6 +49,20 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Writes an entry whose data has already been prepared, i.e. compressed
+      with raw deflate (no zlib header) or uncompressed if method is STORED.
+      The entry is complete after the call, no further data can be written
+      to it.
+      @param entry the entry to write.
+      @param method the storage method of data.
+      @param data the (compressed) data.
+      @param compressed_size number of bytes in data.
+      @param size size of the uncompressed data.
+      @param crc crc32 checksum of the uncompressed data. */
+  void putRawEntry( const ZipCDirEntry &entry, StorageMethod method, 
+		    const char *data, uint32 compressed_size, 
+		    uint32 size, uint32 crc ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 
@@ -68,6 +82,7 @@ protected:
 
   void setEntryClosedState() ;
   void updateEntryHeaderInfo() ;
+  static int currentDosTime() ;
 
   // Should/could be moved to zipheadio.h ?!
   static void writeCentralDirectory( const vector< ZipCDirEntry > &entries, 